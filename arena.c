@@ -0,0 +1,91 @@
+/*
+ * arena.c
+ *
+ * allocates memory from a single block which is freed all at once, so that
+ * everything belonging to one game is kept together and can be handed on to
+ * the next game without going back to malloc
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arena.h"
+
+/* allocates a new, empty arena
+ *
+ * size: the number of bytes which can be allocated from the arena
+ *
+ * returns: the new arena, or NULL if it could not be allocated
+ *
+ */
+struct Arena* new_arena(size_t size) {
+
+    struct Arena* arena = malloc(sizeof(struct Arena));
+
+    if (arena == NULL) {
+        return NULL;
+    }
+    arena->memory = malloc(size);
+    if (arena->memory == NULL) {
+        free(arena);
+        return NULL;
+    }
+    arena->size = size;
+    arena->used = 0;
+    arena->next = NULL;
+    return arena;
+}
+
+/* allocates memory from an arena
+ *
+ * arena: the arena to allocate from
+ * size: the number of bytes needed
+ *
+ * returns: the allocated memory, or NULL if the arena is full
+ *
+ */
+void* arena_alloc(struct Arena* arena, size_t size) {
+
+    size = arena_round(size);
+    if (size > arena->size - arena->used) {
+        return NULL;
+    }
+    void* memory = &arena->memory[arena->used];
+    arena->used += size;
+    return memory;
+}
+
+/* frees everything allocated from an arena at once, so that it can be used
+ * again
+ *
+ * arena: the arena to reset
+ *
+ */
+void reset_arena(struct Arena* arena) {
+
+    arena->used = 0;
+}
+
+/* frees an arena along with everything allocated from it
+ *
+ * arena: the arena to free
+ *
+ */
+void free_arena(struct Arena* arena) {
+
+    free(arena->memory);
+    free(arena);
+}
+
+/* rounds a size up so that the allocation after it stays aligned
+ *
+ * size: the size to round up
+ *
+ * returns: the rounded size
+ *
+ */
+size_t arena_round(size_t size) {
+
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
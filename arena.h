@@ -0,0 +1,35 @@
+/*
+ * arena.h
+ *
+ * structs and function prototypes for arena.c
+ *
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+/* every allocation from an arena starts on a multiple of this many bytes */
+#define ARENA_ALIGN 16
+
+/* Represents a single block of memory which allocations are carved out of
+ * in order, and which is freed (or reused) all at once */
+struct Arena {
+    char* memory;
+    size_t size;
+    size_t used;
+    struct Arena* next;
+};
+
+struct Arena* new_arena(size_t size);
+
+void* arena_alloc(struct Arena* arena, size_t size);
+
+void reset_arena(struct Arena* arena);
+
+void free_arena(struct Arena* arena);
+
+size_t arena_round(size_t size);
+
+#endif /* ARENA_H_ */
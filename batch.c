@@ -0,0 +1,331 @@
+/*
+ * batch.c
+ *
+ * plays a large number of games of random moves for statistics on who wins
+ * and how long games last (--batch=games height width), with BATCH_LANES
+ * games at a time advanced in lockstep, one game in each lane of a vector
+ *
+ * each game is held as a bitboard with a guard column at the end of every
+ * row (so that shifting a bitboard never moves a stone onto the next row),
+ * and the win check for every lane is made at once with vector operations
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "batch.h"
+#include "gameIO.h"
+#include "position.h"
+
+/* plays the batch of games given by the arguments, and prints the results
+ *
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the board dimensions)
+ * numGames: the number of games to play
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: invalid arguments
+ *
+ */
+int run_batch(int argc, char** argv, long numGames) {
+
+    struct Batch batch;
+
+    if (argc != 3) {
+        exit_with_error("Usage: bob --batch=games height width", 1);
+    }
+    int height = check_int(argv[1]);
+    int width = check_int(argv[2]);
+
+    // only boards which fit in the bitboards can be batched
+    if (height < MIN_BOARD_WIDTH || width < MIN_BOARD_WIDTH ||
+            height * (width + 1) > MAX_BATCH_BITS) {
+        exit_with_error("Sensible board dimensions please!", 3);
+    }
+    init_batch(&batch, height, width, numGames);
+    play_batch(&batch);
+
+    printf("%ld games on %dx%d\n", numGames, height, width);
+    printf("Player O wins %ld (%.1f%%)\n", batch.wins[0],
+            100.0 * batch.wins[0] / numGames);
+    printf("Player X wins %ld (%.1f%%)\n", batch.wins[1],
+            100.0 * batch.wins[1] / numGames);
+    printf("Average game length %.2f moves\n",
+            (double)batch.totalMoves / numGames);
+    return 0;
+}
+
+/* sets up a batch of empty games, starting a game in as many lanes as are
+ * needed
+ *
+ * batch: the batch to set up
+ * height, width: the dimensions of every board
+ * numGames: the number of games to play
+ *
+ */
+void init_batch(struct Batch* batch, int height, int width, long numGames) {
+
+    unsigned long long state = BATCH_SEED;
+    int row;
+    int column;
+    int lane;
+    int i;
+
+    memset(batch, 0, sizeof(struct Batch));
+    batch->height = height;
+    batch->width = width;
+    batch->stride = width + 1;
+    batch->size = height * width;
+    batch->numWords = (height * batch->stride + 63) / 64;
+    batch->numGames = numGames;
+
+    // O connects left to right, and X connects top to bottom
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        for (row = 0; row < height; row++) {
+            set_bit(batch->firstEdge[0], lane, row * batch->stride);
+            set_bit(batch->lastEdge[0], lane,
+                    row * batch->stride + width - 1);
+        }
+        for (column = 0; column < width; column++) {
+            set_bit(batch->firstEdge[1], lane, column);
+            set_bit(batch->lastEdge[1], lane,
+                    (height - 1) * batch->stride + column);
+        }
+        for (i = 0; i < batch->size; i++) {
+            batch->order[lane][i] = i;
+        }
+        batch->random[lane] = next_key(&state);
+
+        if (batch->gamesStarted < numGames) {
+            batch->active[lane] = 1;
+            batch->gamesStarted++;
+        }
+    }
+}
+
+/* sets a single bit of one lane of a bitboard
+ *
+ * board: the bitboard
+ * lane: the lane to change
+ * bit: the bit to set (row * stride + column)
+ *
+ */
+void set_bit(LaneWord* board, int lane, int bit) {
+
+    board[bit / 64][lane] |= 1ULL << (bit % 64);
+}
+
+/* plays moves until every game in the batch has finished
+ *
+ * batch: the batch to play
+ *
+ */
+void play_batch(struct Batch* batch) {
+
+    int lane;
+
+    while (1) {
+        int numActive = 0;
+        for (lane = 0; lane < BATCH_LANES; lane++) {
+            numActive += batch->active[lane];
+        }
+        if (numActive == 0) {
+            return;
+        }
+        step_batch(batch);
+    }
+}
+
+/* plays one random move in every active lane, then checks every lane for a
+ * win (starting a new game in each lane which has finished)
+ *
+ * batch: the batch to play
+ *
+ */
+void step_batch(struct Batch* batch) {
+
+    LaneWord placed[2][BATCH_WORDS];
+    LaneWord randoms;
+    int player;
+    int lane;
+    int i;
+
+    memset(placed, 0, sizeof(placed));
+    next_randoms(&batch->random, &randoms);
+
+    // each lane picks its next cell as one more step of a Fisher-Yates
+    // shuffle of its cells
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        if (!batch->active[lane]) {
+            continue;
+        }
+        int* order = batch->order[lane];
+        int move = batch->moves[lane];
+        int chosen = move + randoms[lane] % (batch->size - move);
+        int cell = order[chosen];
+
+        order[chosen] = order[move];
+        order[move] = cell;
+        set_bit(placed[move % 2], lane, (cell / batch->width) *
+                batch->stride + cell % batch->width);
+        batch->moves[lane]++;
+    }
+
+    for (player = 0; player < 2; player++) {
+        LaneWord* stones = batch->stones[player];
+        LaneWord* reach = batch->reach[player];
+        LaneWord touching = {0};
+
+        for (i = 0; i < batch->numWords; i++) {
+            stones[i] |= placed[player][i];
+            reach[i] |= placed[player][i] & batch->firstEdge[player][i];
+        }
+        grow_reach(batch, player);
+
+        // a game is won once the stones connected to the player's first
+        // edge reach their last edge
+        for (i = 0; i < batch->numWords; i++) {
+            touching |= reach[i] & batch->lastEdge[player][i];
+        }
+        for (lane = 0; lane < BATCH_LANES; lane++) {
+            if (batch->active[lane] && touching[lane] != 0) {
+                finish_game(batch, lane, player);
+            }
+        }
+    }
+}
+
+/* adds every stone connected to a player's reach to it, in every lane at
+ * once
+ *
+ * batch: the batch being played
+ * player: 0 for O, 1 for X
+ *
+ */
+void grow_reach(struct Batch* batch, int player) {
+
+    // the bitboard offsets of the neighbours of a cell, in the same order
+    // as get_neighbours
+    int offsets[6] = {-batch->stride, 1, batch->stride + 1, batch->stride,
+            -1, -batch->stride - 1};
+    LaneWord* reach = batch->reach[player];
+    LaneWord* stones = batch->stones[player];
+    LaneWord grown[BATCH_WORDS];
+    LaneWord shifted[BATCH_WORDS];
+    int i;
+    int j;
+
+    while (1) {
+        LaneWord changed = {0};
+
+        memcpy(grown, reach, sizeof(LaneWord) * batch->numWords);
+        for (i = 0; i < 6; i++) {
+            shift_board(reach, shifted, offsets[i], batch->numWords);
+            for (j = 0; j < batch->numWords; j++) {
+                grown[j] |= shifted[j];
+            }
+        }
+        // only stones can be reached (guard cells never hold one)
+        for (j = 0; j < batch->numWords; j++) {
+            grown[j] &= stones[j];
+            changed |= grown[j] ^ reach[j];
+            reach[j] = grown[j];
+        }
+
+        uint64_t anyChanged = 0;
+        for (i = 0; i < BATCH_LANES; i++) {
+            anyChanged |= changed[i];
+        }
+        if (anyChanged == 0) {
+            return;
+        }
+    }
+}
+
+/* shifts every lane of a bitboard, carrying bits between its words
+ * (helper method to grow_reach)
+ *
+ * board: the bitboard to shift
+ * shifted: stores the shifted bitboard
+ * amount: the number of bits to move each bit up by (negative to move it
+ *         down), which can be more than a word on a wide board
+ * numWords: the number of words in the bitboard
+ *
+ */
+void shift_board(LaneWord* board, LaneWord* shifted, int amount,
+        int numWords) {
+
+    LaneWord zero = {0};
+    int up = (amount > 0);
+    int i;
+
+    // a shift is made of whole words, then the bits left over (a vector
+    // cannot be shifted by 64 or more)
+    if (!up) {
+        amount = -amount;
+    }
+    int words = amount / 64;
+    int bits = amount % 64;
+
+    for (i = 0; i < numWords; i++) {
+        int from = up ? i - words : i + words;
+        int carry = up ? from - 1 : from + 1;
+
+        shifted[i] = zero;
+        if (from >= 0 && from < numWords) {
+            shifted[i] = up ? board[from] << bits : board[from] >> bits;
+        }
+        if (bits > 0 && carry >= 0 && carry < numWords) {
+            shifted[i] |= up ? board[carry] >> (64 - bits) :
+                    board[carry] << (64 - bits);
+        }
+    }
+}
+
+/* records the result of a finished game, and starts the next game in its
+ * lane (or leaves the lane empty once every game has been started)
+ *
+ * batch: the batch being played
+ * lane: the lane whose game has finished
+ * winner: 0 if O won, 1 if X won
+ *
+ */
+void finish_game(struct Batch* batch, int lane, int winner) {
+
+    int player;
+    int i;
+
+    batch->wins[winner]++;
+    batch->totalMoves += batch->moves[lane];
+
+    for (player = 0; player < 2; player++) {
+        for (i = 0; i < batch->numWords; i++) {
+            batch->stones[player][i][lane] = 0;
+            batch->reach[player][i][lane] = 0;
+        }
+    }
+    batch->moves[lane] = 0;
+
+    if (batch->gamesStarted < batch->numGames) {
+        batch->gamesStarted++;
+    } else {
+        batch->active[lane] = 0;
+    }
+}
+
+/* advances the random number generator of every lane (xorshift64*)
+ *
+ * state: the state of each lane's generator (updated)
+ * randoms: stores the next random number for every lane
+ *
+ */
+void next_randoms(LaneWord* state, LaneWord* randoms) {
+
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    *randoms = *state * 0x2545F4914F6CDD1DULL;
+}
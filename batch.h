@@ -0,0 +1,74 @@
+/*
+ * batch.h
+ *
+ * structs and function prototypes for batch.c
+ *
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdint.h>
+
+/* the number of games played side by side, one in each lane of a vector */
+#define BATCH_LANES 8
+
+/* the number of 64 bit words in the bitboard of one game */
+#define BATCH_WORDS 4
+
+/* the most cells a batched board can have, counting the guard column kept
+ * at the end of every row (so height * (width + 1) cannot be more) */
+#define MAX_BATCH_BITS (BATCH_WORDS * 64)
+
+/* the seed for the random moves of each lane */
+#define BATCH_SEED 0x243F6A8885A308D3ULL
+
+/* one word of the bitboards of every lane (a GCC vector, so that each
+ * operation on it acts on all of the lanes at once) */
+typedef uint64_t LaneWord __attribute__((vector_size(BATCH_LANES * 8)));
+
+/* Represents a number of games of random moves, played BATCH_LANES at a
+ * time in lockstep: every board is a bitboard (stored word by word, with
+ * the same word of every lane in one vector), and the stones of each player
+ * which are connected to their first edge are grown as moves are played,
+ * so that a game is won once they reach the player's last edge */
+struct Batch {
+    int height;
+    int width;
+    int stride;
+    int size;
+    int numWords;
+    LaneWord stones[2][BATCH_WORDS];
+    LaneWord reach[2][BATCH_WORDS];
+    LaneWord firstEdge[2][BATCH_WORDS];
+    LaneWord lastEdge[2][BATCH_WORDS];
+    LaneWord random;
+    int order[BATCH_LANES][MAX_BATCH_BITS];
+    int moves[BATCH_LANES];
+    int active[BATCH_LANES];
+    long gamesStarted;
+    long numGames;
+    long wins[2];
+    long totalMoves;
+};
+
+int run_batch(int argc, char** argv, long numGames);
+
+void init_batch(struct Batch* batch, int height, int width, long numGames);
+
+void set_bit(LaneWord* board, int lane, int bit);
+
+void play_batch(struct Batch* batch);
+
+void step_batch(struct Batch* batch);
+
+void grow_reach(struct Batch* batch, int player);
+
+void shift_board(LaneWord* board, LaneWord* shifted, int amount,
+        int numWords);
+
+void finish_game(struct Batch* batch, int lane, int winner);
+
+void next_randoms(LaneWord* state, LaneWord* randoms);
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,902 @@
+/*
+ * bench.c
+ *
+ * contains the main function for bench, which times the hot paths of bob
+ * over a range of board sizes and prints the results as CSV
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "bench.h"
+#include "bob.h"
+#include "engine.h"
+#include "gameIO.h"
+#include "winning.h"
+#include "stats.h"
+#include "position.h"
+#include "snapshot.h"
+
+/* the hardware counter of cache misses on this thread, or -1 if it could
+ * not be opened (perf_event_open is often unavailable in containers) */
+int cacheCounter = -1;
+
+/* the cache misses counted by the last benchmark run, or -1 if it did not
+ * count them */
+long long benchCacheMisses = -1;
+
+/* the board of the layout benchmark being run, set up before it is timed */
+struct LayoutBench layoutBench;
+
+int main(int argc, char** argv) {
+
+    int sizes[MAX_SIZES] = {4, 11, 19, 50, 100, 250, 500, 1000};
+    int numSizes = 8;
+    int maxGameSize = DEFAULT_MAX_GAME_SIZE;
+    long minTime = DEFAULT_MIN_TIME;
+    char* filter = NULL;
+    int i;
+
+    // reads the options which change which benchmarks are run
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--sizes=", 8) == 0) {
+            numSizes = read_sizes(&argv[i][8], sizes);
+        } else if (strncmp(argv[i], "--min-time=", 11) == 0) {
+            minTime = check_int(&argv[i][11]);
+        } else if (strncmp(argv[i], "--max-game-size=", 16) == 0) {
+            maxGameSize = check_int(&argv[i][16]);
+        } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = &argv[i][9];
+        } else {
+            numSizes = ERROR;
+        }
+        if (numSizes == ERROR || minTime <= 0) {
+            exit_with_error("Usage: bench [--sizes=4,11,...] [--min-time=ms] "
+                    "[--max-game-size=n] [--filter=name]", 1);
+        }
+    }
+
+    struct Bench benches[] = {
+        {"check_win", snake_fill, bench_check_win},
+        {"get_neighbours", NULL, bench_get_neighbours},
+        {"make_move_auto", half_fill, bench_make_move_auto},
+        {"play_undo", position_fill, bench_play_undo},
+        {"fork_game", half_fill, bench_fork_game},
+        {"fill_board", NULL, bench_fill_board},
+        {"draw_grid", half_fill, bench_draw_grid},
+        {"save_game", half_fill, bench_save_game},
+        {"load_file", save_fill, bench_load_file},
+        {"full_game", NULL, bench_full_game},
+        {"win_check_rows", shuffled_rows, bench_win_check_layout},
+        {"win_check_tiled", shuffled_tiled, bench_win_check_layout},
+        {"win_check_morton", shuffled_morton, bench_win_check_layout},
+        {"flood_fill_rows", random_fill_rows, bench_flood_fill_layout},
+        {"flood_fill_tiled", random_fill_tiled, bench_flood_fill_layout},
+        {"flood_fill_morton", random_fill_morton, bench_flood_fill_layout}
+    };
+    int numBenches = sizeof(benches) / sizeof(struct Bench);
+    int j;
+
+    cacheCounter = open_cache_counter();
+    printf("bench,height,width,iterations,ns_per_op,moves_per_s,"
+            "allocs_per_op,cache_misses_per_op\n");
+
+    for (i = 0; i < numSizes; i++) {
+        for (j = 0; j < numBenches; j++) {
+
+            if (filter != NULL && strcmp(filter, benches[j].name) != 0) {
+                continue;
+            }
+            // whole games on the largest boards take far too long to time
+            if (benches[j].run == bench_full_game && sizes[i] > maxGameSize) {
+                continue;
+            }
+            run_bench(&benches[j], sizes[i], minTime);
+        }
+    }
+    return 0;
+}
+
+/* reads a comma separated list of board sizes
+ *
+ * list: the list to be read
+ * sizes: stores the sizes which were read
+ *
+ * returns: the number of sizes read, or ERROR if the list is invalid
+ *
+ */
+int read_sizes(char* list, int* sizes) {
+
+    int numSizes = 0;
+    char* token = strtok(list, ",");
+
+    while (token != NULL) {
+        int size = check_int(token);
+
+        if (size < MIN_BOARD_WIDTH || size > MAX_BOARD_WIDTH ||
+                numSizes == MAX_SIZES) {
+            return ERROR;
+        }
+        sizes[numSizes++] = size;
+        token = strtok(NULL, ",");
+    }
+    if (numSizes == 0) {
+        return ERROR;
+    }
+    return numSizes;
+}
+
+/* times a benchmark on a square board, doubling the number of iterations
+ * until the timed part takes at least minTime, then prints one CSV line
+ *
+ * bench: the benchmark to be run
+ * size: the height and width of the board
+ * minTime: the minimum time to spend in the timed part (ms)
+ *
+ */
+void run_bench(struct Bench* bench, int size, long minTime) {
+
+    struct Game game;
+    struct Player playerO;
+    struct Player playerX;
+    long iterations = 1;
+    long long elapsed;
+    long moves;
+    unsigned long long allocated;
+
+    while (1) {
+        new_bench_game(&game, &playerO, &playerX, size);
+        if (bench->setup != NULL) {
+            bench->setup(&game);
+        }
+
+        // only allocations made by the timed operation are counted
+        moves = 0;
+        benchCacheMisses = -1;
+        allocated = allocation_count();
+        elapsed = bench->run(&game, iterations, &moves);
+        allocated = allocation_count() - allocated;
+
+        free_bench_game(&game);
+
+        if (elapsed >= minTime * 1000000LL || iterations >= MAX_ITERATIONS) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double seconds = elapsed / 1e9;
+    printf("%s,%d,%d,%ld,%.1f,%.0f,%.2f,", bench->name, size, size,
+            iterations, (double)elapsed / iterations,
+            seconds > 0 ? moves / seconds : 0.0,
+            (double)allocated / iterations);
+
+    // (left empty for the benchmarks which do not count cache misses)
+    if (benchCacheMisses >= 0) {
+        printf("%.1f", (double)benchCacheMisses / iterations);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/* starts a new empty game between two auto players
+ *
+ * game: the game to be started
+ * playerO, playerX: the players in the game
+ * size: the height and width of the board
+ *
+ */
+void new_bench_game(struct Game* game, struct Player* playerO,
+        struct Player* playerX, int size) {
+
+    char sizeString[12];
+    snprintf(sizeString, sizeof(sizeString), "%d", size);
+    char* argv[] = {"bench", "a", "a", sizeString, sizeString, NULL};
+
+    init_game(game, playerO, playerX);
+    start_game(5, argv, game);
+}
+
+/* frees the grids of a game started by new_bench_game
+ *
+ * game: the game to be freed
+ *
+ */
+void free_bench_game(struct Game* game) {
+
+    free_grids(game);
+    free_position(game);
+    free_layout_bench();
+}
+
+/* fills about half of the board using the auto players, without checking
+ * for a win
+ *
+ * game: the game to be filled
+ *
+ */
+void half_fill(struct Game* game) {
+
+    int i;
+    for (i = 0; i < game->size / 2; i++) {
+        struct Player* player = (i % 2 == 0) ? game->player1 : game->player2;
+        int move[2];
+        make_move_auto(game, player, game->grid, move);
+    }
+}
+
+/* fills the board with a snake of Os, which goes right along the even rows
+ * and down at alternating ends, so that checking a move at the start of the
+ * snake has to visit about half of the board
+ *
+ * game: the game to be filled
+ *
+ */
+void snake_fill(struct Game* game) {
+
+    int i;
+    int j;
+
+    for (i = 0; i < game->height; i++) {
+        int turn = (i / 2) % 2 == 0 ? game->width - 1 : 0;
+
+        for (j = 0; j < game->width; j++) {
+            if (i % 2 == 0 || j == turn) {
+                game->grid[i][j] = 'O';
+            }
+        }
+    }
+}
+
+/* fills about half of the board, and saves it to BENCH_FILE
+ *
+ * game: the game to be filled
+ *
+ */
+void save_fill(struct Game* game) {
+
+    char input[MAX_PATH + 1];
+
+    half_fill(game);
+    snprintf(input, sizeof(input), "s%s", BENCH_FILE);
+    if (save_game(input, strlen(input), game->grid, game) == ERROR) {
+        exit_with_error("Unable to save game", 8);
+    }
+}
+
+/* fills about half of the board, then sets up the game for play_move and
+ * undo_move
+ *
+ * game: the game to be filled
+ *
+ */
+void position_fill(struct Game* game) {
+
+    half_fill(game);
+    if (init_position(game) == ERROR) {
+        exit_with_error("Unable to set up position", 8);
+    }
+}
+
+/* clears every cell of the board and resets the auto players, so that a
+ * new game can be played without reallocating the grids
+ *
+ * game: the game to be cleared
+ *
+ */
+void clear_game(struct Game* game) {
+
+    int i;
+    for (i = 0; i < game->height; i++) {
+        memset(game->grid[i], '.', sizeof(char) * game->width);
+        memset(game->connectionGrid[i], 0, sizeof(int) * game->width);
+    }
+    game->player1->moveNumber = 0;
+    game->player2->moveNumber = 0;
+}
+
+/* times check_win for a move at the start of the snake of Os added by
+ * snake_fill (the connectionGrid is cleared between checks, outside of the
+ * timed part)
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of checks to time
+ * moves: stores the number of moves checked
+ *
+ * returns: the time spent in check_win (ns)
+ *
+ */
+long long bench_check_win(struct Game* game, long iterations, long* moves) {
+
+    long long elapsed = 0;
+    int move[2] = {0, 0};
+    int i;
+    long k;
+
+    for (k = 0; k < iterations; k++) {
+        for (i = 0; i < game->height; i++) {
+            memset(game->connectionGrid[i], 0, sizeof(int) * game->width);
+        }
+        long long start = monotonic_ns();
+        check_win(game, game->grid, game->connectionGrid, move,
+                game->player1);
+        elapsed += monotonic_ns() - start;
+    }
+    *moves = iterations;
+    return elapsed;
+}
+
+/* times get_neighbours for a cell in the middle of the board
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of calls to time
+ * moves: unused (left at 0)
+ *
+ * returns: the time spent in get_neighbours (ns)
+ *
+ */
+long long bench_get_neighbours(struct Game* game, long iterations,
+        long* moves) {
+
+    int move[2] = {game->height / 2, game->width / 2};
+    int numNeighbours;
+    long k;
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        free_2d_int(get_neighbours(game, move, &numNeighbours), 6);
+    }
+    return monotonic_ns() - start;
+}
+
+/* times make_move_auto on a half filled board, taking each move back again
+ * so that every call sees the same board
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of moves to time
+ * moves: stores the number of moves made
+ *
+ * returns: the time spent making (and taking back) moves (ns)
+ *
+ */
+long long bench_make_move_auto(struct Game* game, long iterations,
+        long* moves) {
+
+    // half_fill can fill every cell of a 1x1 board
+    if (game->size == 1) {
+        game->grid[0][0] = '.';
+    }
+    int moveNumber = game->player1->moveNumber;
+    long k;
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        int move[2];
+        make_move_auto(game, game->player1, game->grid, move);
+
+        game->grid[move[0]][move[1]] = '.';
+        game->player1->moveNumber = moveNumber;
+    }
+    *moves = iterations;
+    return monotonic_ns() - start;
+}
+
+/* times play_auto_move followed by undo_move on a half filled board, so
+ * that every move sees the same board
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of moves to time
+ * moves: stores the number of moves made
+ *
+ * returns: the time spent making and taking back moves (ns)
+ *
+ */
+long long bench_play_undo(struct Game* game, long iterations, long* moves) {
+
+    int move[2];
+    long k;
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        play_auto_move(game, move);
+        undo_move(game);
+    }
+    *moves = iterations;
+    return monotonic_ns() - start;
+}
+
+/* times forking a half filled game and making one move in the fork (which
+ * copies the rows it writes to), then freeing the fork
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of forks to time
+ * moves: stores the number of moves made
+ *
+ * returns: the time spent forking, moving and freeing (ns)
+ *
+ */
+long long bench_fork_game(struct Game* game, long iterations, long* moves) {
+
+    struct Game fork;
+    struct Player playerO;
+    struct Player playerX;
+    int move[2];
+    long k;
+
+    // half_fill can fill every cell of a 1x1 board
+    if (game->size == 1) {
+        game->grid[0][0] = '.';
+    }
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        if (fork_game(game, &fork, &playerO, &playerX) == ERROR) {
+            exit_with_error("Unable to fork game", 8);
+        }
+        make_move_auto(&fork, fork.player1, fork.grid, move);
+        check_win(&fork, fork.grid, fork.connectionGrid, move, fork.player1);
+        free_grids(&fork);
+    }
+    *moves = iterations;
+    return monotonic_ns() - start;
+}
+
+/* times an engine playout from an empty board: filling every cell at random
+ * and finding the winner (with the copy of fill_board for the board's size)
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of playouts to time
+ * moves: stores the number of cells filled
+ *
+ * returns: the time spent on the playouts (ns)
+ *
+ */
+long long bench_fill_board(struct Game* game, long iterations, long* moves) {
+
+    struct Engine engine;
+    long k;
+
+    init_engine(&engine, NULL, 1);
+    set_position(&engine, game, game->player1);
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        memcpy(engine.scratch, engine.cells, sizeof(char) * engine.size);
+        engine.fill(&engine, engine.scratch, 'O');
+    }
+    long long elapsed = monotonic_ns() - start;
+
+    free_engine(&engine);
+    *moves = iterations * game->size;
+    return elapsed;
+}
+
+/* times draw_grid for a half filled board, with stdout sent to /dev/null
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of grids to draw
+ * moves: unused (left at 0)
+ *
+ * returns: the time spent drawing the grid (ns)
+ *
+ */
+long long bench_draw_grid(struct Game* game, long iterations, long* moves) {
+
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    long k;
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        draw_grid(game, game->grid);
+    }
+    fflush(stdout);
+    long long elapsed = monotonic_ns() - start;
+
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(devNull);
+    return elapsed;
+}
+
+/* times save_game for a half filled board
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of saves to time
+ * moves: unused (left at 0)
+ *
+ * returns: the time spent saving the game (ns)
+ *
+ */
+long long bench_save_game(struct Game* game, long iterations, long* moves) {
+
+    char input[MAX_PATH + 1];
+    long k;
+
+    snprintf(input, sizeof(input), "s%s", BENCH_FILE);
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        if (save_game(input, strlen(input), game->grid, game) == ERROR) {
+            exit_with_error("Unable to save game", 8);
+        }
+    }
+    long long elapsed = monotonic_ns() - start;
+
+    unlink(BENCH_FILE);
+    return elapsed;
+}
+
+/* times load_file for the half filled board saved by save_fill (including
+ * opening and closing the file, and freeing the grid it loads)
+ *
+ * game: the game to run the benchmark on
+ * iterations: the number of loads to time
+ * moves: unused (left at 0)
+ *
+ * returns: the time spent loading the game (ns)
+ *
+ */
+long long bench_load_file(struct Game* game, long iterations, long* moves) {
+
+    long k;
+    int i;
+
+    long long start = monotonic_ns();
+    for (k = 0; k < iterations; k++) {
+        FILE* savedGame = fopen(BENCH_FILE, "r");
+        if (savedGame == NULL) {
+            exit_with_error("Could not start reading from savefile", 4);
+        }
+        char** grid = load_file(savedGame, game);
+        fclose(savedGame);
+
+        // init_saved_game allocates one spare row
+        for (i = 0; i < game->height + 1; i++) {
+            free(grid[i]);
+        }
+        free(grid);
+    }
+    long long elapsed = monotonic_ns() - start;
+
+    unlink(BENCH_FILE);
+    return elapsed;
+}
+
+/* times whole games between two auto players, from an empty board until
+ * one of them wins (without drawing the grid)
+ *
+ * game: the game to run the benchmark on (cleared before every game)
+ * iterations: the number of games to time
+ * moves: stores the total number of moves made
+ *
+ * returns: the time spent playing the games (ns)
+ *
+ */
+long long bench_full_game(struct Game* game, long iterations, long* moves) {
+
+    struct Player* playerO = game->player1;
+    struct Player* playerX = game->player2;
+    long long elapsed = 0;
+    long k;
+
+    for (k = 0; k < iterations; k++) {
+        clear_game(game);
+        struct Player* player = playerO;
+
+        long long start = monotonic_ns();
+        while (1) {
+            int move[2];
+            make_move_auto(game, player, game->grid, move);
+            int win = check_win(game, game->grid, game->connectionGrid,
+                    move, player);
+
+            (*moves)++;
+            if (win == WIN) {
+                break;
+            }
+            player = (player == playerO) ? playerX : playerO;
+        }
+        elapsed += monotonic_ns() - start;
+    }
+    return elapsed;
+}
+
+/* sets up a win check benchmark with the cells stored one row after
+ * another */
+void shuffled_rows(struct Game* game) {
+
+    shuffled_layout(game, LAYOUT_ROWS);
+}
+
+/* sets up a win check benchmark with the cells stored in square tiles */
+void shuffled_tiled(struct Game* game) {
+
+    shuffled_layout(game, LAYOUT_TILED);
+}
+
+/* sets up a win check benchmark with the cells stored along a Z-order
+ * curve */
+void shuffled_morton(struct Game* game) {
+
+    shuffled_layout(game, LAYOUT_MORTON);
+}
+
+/* sets up a flood fill benchmark with the cells stored one row after
+ * another */
+void random_fill_rows(struct Game* game) {
+
+    random_fill_layout(game, LAYOUT_ROWS);
+}
+
+/* sets up a flood fill benchmark with the cells stored in square tiles */
+void random_fill_tiled(struct Game* game) {
+
+    random_fill_layout(game, LAYOUT_TILED);
+}
+
+/* sets up a flood fill benchmark with the cells stored along a Z-order
+ * curve */
+void random_fill_morton(struct Game* game) {
+
+    random_fill_layout(game, LAYOUT_MORTON);
+}
+
+/* sets up an empty connectivity board with the given layout, and every cell
+ * of it in a random order (the same for every layout) for the stones of a
+ * win check benchmark to be placed in
+ *
+ * game: the game the benchmark runs on (only its size is used)
+ * layout: the order to store the cells in (one of the LAYOUT_ constants)
+ *
+ * error conditions: unable to allocate the board
+ *
+ */
+void shuffled_layout(struct Game* game, int layout) {
+
+    unsigned long long state = LAYOUT_SEED;
+    int i;
+
+    layoutBench.cells = malloc(sizeof(int) * game->size);
+    if (layoutBench.cells == NULL ||
+            init_connectivity_layout(&layoutBench.board, game->height,
+            game->width, layout) == ERROR) {
+        exit_with_error("Unable to set up board", 8);
+    }
+    layoutBench.ready = 1;
+
+    for (i = 0; i < game->size; i++) {
+        layoutBench.cells[i] = i;
+    }
+    for (i = game->size - 1; i > 0; i--) {
+        int j = next_key(&state) % (i + 1);
+        int swap = layoutBench.cells[i];
+
+        layoutBench.cells[i] = layoutBench.cells[j];
+        layoutBench.cells[j] = swap;
+    }
+}
+
+/* sets up a connectivity board with the given layout, filled at random
+ * (in the same way for every layout) for a flood fill benchmark, with room
+ * to queue every cell
+ *
+ * game: the game the benchmark runs on (only its size is used)
+ * layout: the order to store the cells in (one of the LAYOUT_ constants)
+ *
+ * error conditions: unable to allocate the board
+ *
+ */
+void random_fill_layout(struct Game* game, int layout) {
+
+    unsigned long long state = LAYOUT_SEED;
+    int i;
+
+    layoutBench.cells = malloc(sizeof(int) * game->size);
+    if (layoutBench.cells == NULL ||
+            init_connectivity_layout(&layoutBench.board, game->height,
+            game->width, layout) == ERROR) {
+        exit_with_error("Unable to set up board", 8);
+    }
+    layoutBench.ready = 1;
+
+    for (i = 0; i < game->size; i++) {
+        char symbol = (next_key(&state) % 1000 < FLOOD_DENSITY * 1000) ?
+                'O' : 'X';
+        add_stone(&layoutBench.board, i / game->width, i % game->width,
+                symbol);
+    }
+}
+
+/* frees the board set up for a layout benchmark, if there is one (helper
+ * method to free_bench_game)
+ *
+ */
+void free_layout_bench(void) {
+
+    if (layoutBench.ready) {
+        free_connectivity(&layoutBench.board);
+        free(layoutBench.cells);
+        layoutBench.cells = NULL;
+        layoutBench.ready = 0;
+    }
+}
+
+/* times whole games on the board set up by shuffled_layout, placing stones
+ * for the two players in turn in its random order and checking each one for
+ * a win, until one of them wins (the board is cleared between games,
+ * outside of the timed part)
+ *
+ * game: the game to run the benchmark on (only its size is used)
+ * iterations: the number of games to time
+ * moves: stores the total number of stones placed
+ *
+ * returns: the time spent placing stones (ns)
+ *
+ */
+long long bench_win_check_layout(struct Game* game, long iterations,
+        long* moves) {
+
+    struct Connectivity* board = &layoutBench.board;
+    long long elapsed = 0;
+    long long misses = 0;
+    long k;
+    int i;
+
+    for (k = 0; k < iterations; k++) {
+        clear_connectivity(board);
+
+        long long counted = cache_misses();
+        long long start = monotonic_ns();
+        for (i = 0; i < game->size; i++) {
+            int cell = layoutBench.cells[i];
+
+            (*moves)++;
+            if (add_stone(board, cell / game->width, cell % game->width,
+                    (i % 2 == 0) ? 'O' : 'X') == WIN) {
+                break;
+            }
+        }
+        elapsed += monotonic_ns() - start;
+        misses += cache_misses() - counted;
+    }
+    if (cacheCounter != -1) {
+        benchCacheMisses = misses;
+    }
+    return elapsed;
+}
+
+/* times flood fills of the stones of O which reach from its left edge, on
+ * the board set up by random_fill_layout (the marks left by each fill are
+ * taken off again outside of the timed part)
+ *
+ * game: the game to run the benchmark on (only its size is used)
+ * iterations: the number of flood fills to time
+ * moves: stores the total number of cells visited
+ *
+ * returns: the time spent in the flood fills (ns)
+ *
+ */
+long long bench_flood_fill_layout(struct Game* game, long iterations,
+        long* moves) {
+
+    struct Connectivity* board = &layoutBench.board;
+    int* queue = layoutBench.cells;
+    long long elapsed = 0;
+    long long misses = 0;
+    long k;
+    int i;
+
+    for (k = 0; k < iterations; k++) {
+        long long counted = cache_misses();
+        long long start = monotonic_ns();
+        int visited = flood_from_left(board, queue);
+        elapsed += monotonic_ns() - start;
+        misses += cache_misses() - counted;
+
+        for (i = 0; i < visited; i++) {
+            board->cells[cell_index(board, queue[i] / game->width,
+                    queue[i] % game->width)] = 'O';
+        }
+        *moves += visited;
+    }
+    if (cacheCounter != -1) {
+        benchCacheMisses = misses;
+    }
+    return elapsed;
+}
+
+/* visits every stone of O joined to its left edge, breadth first, marking
+ * each one as it is reached (helper method to bench_flood_fill_layout)
+ *
+ * board: the board, whose stones of O are marked as 'o' when visited
+ * queue: stores the positions visited (row * width + column), with room
+ *        for every cell
+ *
+ * returns: the number of stones visited
+ *
+ */
+int flood_from_left(struct Connectivity* board, int* queue) {
+
+    static const int rowOffsets[6] = {-1, 0, 1, 1, 0, -1};
+    static const int columnOffsets[6] = {0, 1, 1, 0, -1, -1};
+    int width = board->width;
+    int numQueued = 0;
+    int next = 0;
+    int i;
+
+    for (i = 0; i < board->height; i++) {
+        int cell = cell_index(board, i, 0);
+
+        if (board->cells[cell] == 'O') {
+            board->cells[cell] = 'o';
+            queue[numQueued++] = i * width;
+        }
+    }
+    while (next < numQueued) {
+        int row = queue[next] / width;
+        int column = queue[next] % width;
+
+        next++;
+        for (i = 0; i < 6; i++) {
+            int nextRow = row + rowOffsets[i];
+            int nextColumn = column + columnOffsets[i];
+
+            if (nextRow < 0 || nextRow >= board->height || nextColumn < 0 ||
+                    nextColumn >= width) {
+                continue;
+            }
+            int cell = cell_index(board, nextRow, nextColumn);
+            if (board->cells[cell] == 'O') {
+                board->cells[cell] = 'o';
+                queue[numQueued++] = nextRow * width + nextColumn;
+            }
+        }
+    }
+    return numQueued;
+}
+
+/* opens a hardware counter of the cache misses of this thread (in user
+ * space only)
+ *
+ * returns: the counter, or -1 if it could not be opened
+ *
+ */
+int open_cache_counter(void) {
+
+    struct perf_event_attr attributes;
+
+    memset(&attributes, 0, sizeof(struct perf_event_attr));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(struct perf_event_attr);
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+/* reads the counter of cache misses
+ *
+ * returns: the number of cache misses since the counter was opened, or 0
+ *          if there is no counter
+ *
+ */
+long long cache_misses(void) {
+
+    long long count = 0;
+
+    if (cacheCounter != -1 &&
+            read(cacheCounter, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+    }
+    return count;
+}
@@ -0,0 +1,124 @@
+/*
+ * bench.h
+ *
+ * structs and function prototypes for bench.c
+ *
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include "structs.h"
+#include "connectivity.h"
+
+#define MAX_SIZES 16
+#define MAX_ITERATIONS (1L << 30)
+#define MAX_PATH 68
+
+/* the default minimum time to spend timing each benchmark (ms) */
+#define DEFAULT_MIN_TIME 200
+
+/* whole games are only timed up to this board size by default */
+#define DEFAULT_MAX_GAME_SIZE 100
+
+#define BENCH_FILE "/tmp/bob_bench_save.txt"
+
+/* seeds the random boards and move orders of the layout benchmarks, so
+ * that every layout is timed on the same games */
+#define LAYOUT_SEED 0x9e3779b97f4a7c15ULL
+
+/* the share of the cells of the flood fill benchmark's board which hold
+ * an O (the rest hold an X), enough for the Os to reach across the board */
+#define FLOOD_DENSITY 0.65
+
+/* Represents the board of a layout benchmark (win_check_* and
+ * flood_fill_*), set up by its setup function so that only the operation
+ * being timed runs in the benchmark; cells holds the order the stones are
+ * placed in, or the queue of a flood fill */
+struct LayoutBench {
+    struct Connectivity board;
+    int* cells;
+    int ready;
+};
+
+/* Represents a single benchmark, which sets up a game (if setup is not
+ * NULL), then times iterations of an operation on it and returns the time
+ * taken (ns) */
+struct Bench {
+    char* name;
+    void (*setup)(struct Game* game);
+    long long (*run)(struct Game* game, long iterations, long* moves);
+};
+
+int read_sizes(char* list, int* sizes);
+
+void run_bench(struct Bench* bench, int size, long minTime);
+
+void new_bench_game(struct Game* game, struct Player* playerO,
+        struct Player* playerX, int size);
+
+void free_bench_game(struct Game* game);
+
+void half_fill(struct Game* game);
+
+void snake_fill(struct Game* game);
+
+void save_fill(struct Game* game);
+
+void position_fill(struct Game* game);
+
+void clear_game(struct Game* game);
+
+long long bench_check_win(struct Game* game, long iterations, long* moves);
+
+long long bench_get_neighbours(struct Game* game, long iterations,
+        long* moves);
+
+long long bench_make_move_auto(struct Game* game, long iterations,
+        long* moves);
+
+long long bench_play_undo(struct Game* game, long iterations, long* moves);
+
+long long bench_fork_game(struct Game* game, long iterations, long* moves);
+
+long long bench_fill_board(struct Game* game, long iterations, long* moves);
+
+long long bench_draw_grid(struct Game* game, long iterations, long* moves);
+
+long long bench_save_game(struct Game* game, long iterations, long* moves);
+
+long long bench_load_file(struct Game* game, long iterations, long* moves);
+
+long long bench_full_game(struct Game* game, long iterations, long* moves);
+
+void shuffled_rows(struct Game* game);
+
+void shuffled_tiled(struct Game* game);
+
+void shuffled_morton(struct Game* game);
+
+void random_fill_rows(struct Game* game);
+
+void random_fill_tiled(struct Game* game);
+
+void random_fill_morton(struct Game* game);
+
+void shuffled_layout(struct Game* game, int layout);
+
+void random_fill_layout(struct Game* game, int layout);
+
+void free_layout_bench(void);
+
+long long bench_win_check_layout(struct Game* game, long iterations,
+        long* moves);
+
+long long bench_flood_fill_layout(struct Game* game, long iterations,
+        long* moves);
+
+int flood_from_left(struct Connectivity* board, int* queue);
+
+int open_cache_counter(void);
+
+long long cache_misses(void);
+
+#endif /* BENCH_H_ */
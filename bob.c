@@ -13,9 +13,30 @@
 #include "bob.h"
 #include "gameIO.h"
 #include "winning.h"
+#include "engine.h"
+#include "stats.h"
+#include "trace.h"
+#include "replay.h"
+#include "htp.h"
+#include "batch.h"
+#include "components.h"
+#include "solve.h"
+#include "solvedb.h"
+#include "selfplay.h"
+#include "match.h"
+#include "display.h"
+#include "publish.h"
+#include "check.h"
+#include "fastforward.h"
+#include "position.h"
+#include "snapshot.h"
+#include "kernels.h"
 
 #define EMPTY 0
 
+/* the benchmarks link against this file without its main function */
+#ifndef NO_MAIN
+
 int main(int argc, char** argv) {
 
     // initialises the game
@@ -24,8 +45,80 @@ int main(int argc, char** argv) {
     struct Player playerX;
     init_game(&game, &playerO, &playerX);
 
+    // removes any options from the arguments before they are checked
+    struct Options options;
+    argc = parse_options(argc, argv, &options);
+
+    set_board_layout(options.layout);
+    if (options.stats) {
+        init_stats(options.statsFile);
+    }
+    if (options.traceFile != NULL) {
+        init_trace(options.traceFile);
+    }
+    if (options.dbFile != NULL) {
+        init_solved_db(options.dbFile);
+    }
+    if (options.replayFile != NULL) {
+        // replays a move log instead of playing a game
+        return replay_game(options.replayFile, options.prefixStats);
+    }
+    if (options.dumpFile != NULL) {
+        // prints a record file written by --selfplay
+        return dump_records(options.dumpFile);
+    }
+    if (options.watchName != NULL) {
+        // follows a game published by another bob instead of playing one
+        return run_watch(options.watchName);
+    }
+    if (options.matchGames > 0) {
+        // plays two player configurations against each other
+        return run_match(argc, argv, &options);
+    }
+    if (options.selfPlayGames > 0) {
+        // plays games between engine players to a record file
+        return run_selfplay(argc, argv, &options);
+    }
+    if (options.batchGames > 0) {
+        // plays games of random moves in batches for statistics
+        return run_batch(argc, argv, options.batchGames);
+    }
+    if (options.check) {
+        // checks every saved game in a directory instead of playing one
+        return run_check(argc, argv, &options);
+    }
+    if (options.solve) {
+        // proves who wins a saved game instead of playing it
+        return solve_game(&game, argc, argv);
+    }
+    if (options.htp) {
+        // takes commands from another program instead of playing a game
+        return run_htp(&game, argc, argv, &options);
+    }
     start_game(argc, argv, &game);
-    draw_grid(&game, game.grid);
+
+    // engine players are given their own search state
+    struct Engine engineO;
+    struct Engine engineX;
+    attach_engine(&playerO, &engineO, &options);
+    attach_engine(&playerX, &engineX, &options);
+    if (options.publishName != NULL) {
+        init_publish(options.publishName, &game);
+    }
+    if (options.hideDisplay) {
+        hide_display();
+    }
+
+    // a game between auto players can go straight to its end (unless it
+    // had already been won, when it is played as normal)
+    if (options.fastForward && playerO.type == 'a' && playerX.type == 'a' &&
+            fast_forward(&game, options.memoFile) == WIN) {
+        return 0;
+    }
+    if (options.ansiDisplay) {
+        init_display(&game);
+    }
+    show_grid(&game);
 
     // keeps track of which player is making the current move
     struct Player* currentPlayer;
@@ -54,8 +147,13 @@ int main(int argc, char** argv) {
         } else if (currentPlayer->type == 'a') {
             // handles moves made by auto players
             gameOver = auto_move(&game, currentPlayer);
+
+        } else if (currentPlayer->type == 'e') {
+            // handles moves made by engine players
+            gameOver = engine_move(&game, currentPlayer);
         }
-        
+        stats_end_move();
+
         // if the game has a winner, end the game
         if (gameOver == WIN) {
             return 0;
@@ -66,6 +164,8 @@ int main(int argc, char** argv) {
     }
 }
 
+#endif /* NO_MAIN */
+
 /* initialises the game and players
  *
  * game: the game to be initialised
@@ -79,12 +179,276 @@ void init_game(struct Game* game, struct Player* player1,
     player1->playerSymbol = 'O';
     player2->playerSymbol = 'X';
 
+    player1->engine = NULL;
+    player2->engine = NULL;
+
+    game->position = NULL;
+    game->gridRefs = NULL;
+    game->connectionRefs = NULL;
+
     game->player1 = player1;
     game->player2 = player2;
 
     game->checkEOF = 0;
 }
 
+/* reads any options (arguments starting with "--") given to the program,
+ * and removes them from argv so that the remaining arguments can be checked
+ * as normal
+ *
+ * argc: argument counter from running the program
+ * argv: the arguments given to the program
+ * options: stores the options which were read
+ *
+ * returns: the number of arguments left in argv
+ *
+ * error conditions: invalid option in argv
+ *
+ */
+int parse_options(int argc, char** argv, struct Options* options) {
+
+    memset(options, 0, sizeof(struct Options));
+
+    int kept = 1;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            argv[kept] = argv[i];
+            kept++;
+            continue;
+        }
+        if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            // the move log to replay is given as the next argument
+            options->replayFile = argv[i + 1];
+            i++;
+            continue;
+        }
+        if (parse_option(argv[i], options) == ERROR) {
+            exit_with_error("Usage: bob p1type p2type "
+                    "[height width | filename]", 1);
+        }
+    }
+    argv[kept] = NULL;
+    return kept;
+}
+
+/* reads a single option into options (helper method to parse_options)
+ *
+ * option: the option to be read, including the leading "--"
+ * options: stores the value of the option
+ *
+ * returns: SUCCESS if option is valid, ERROR otherwise
+ *
+ */
+int parse_option(char* option, struct Options* options) {
+
+    if (strncmp(option, "--movetime=", 11) == 0) {
+        // fixed time per move for engine players
+        int moveTime = check_int(&option[11]);
+        if (moveTime <= 0) {
+            return ERROR;
+        }
+        options->clock.moveTime = moveTime;
+        options->clock.remaining = 0;
+        options->clock.increment = 0;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--time=", 7) == 0) {
+        // total game time (plus increment) for engine players
+        return parse_time_control(&option[7], &options->clock);
+
+    } else if (strncmp(option, "--playouts=", 11) == 0) {
+        // maximum playouts per move for engine players
+        int maxPlayouts = check_int(&option[11]);
+        if (maxPlayouts <= 0) {
+            return ERROR;
+        }
+        options->maxPlayouts = maxPlayouts;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--noponder") == 0) {
+        // stops engine players searching while manual players think
+        options->noPonder = 1;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--stats") == 0) {
+        // writes a JSON summary of per-move statistics to stderr on exit
+        options->stats = 1;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--stats=", 8) == 0 && option[8] != '\0') {
+        // writes the JSON summary to the given file instead
+        options->stats = 1;
+        options->statsFile = &option[8];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--trace=", 8) == 0 && option[8] != '\0') {
+        // writes a Chrome trace-event timeline to the given file on exit
+        options->traceFile = &option[8];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--replay=", 9) == 0 && option[9] != '\0') {
+        // replays the given move log instead of playing a game
+        options->replayFile = &option[9];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--batch=", 8) == 0) {
+        // plays the given number of games of random moves for statistics
+        int batchGames = check_int(&option[8]);
+        if (batchGames <= 0) {
+            return ERROR;
+        }
+        options->batchGames = batchGames;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--db=", 5) == 0 && option[5] != '\0') {
+        // keeps solved positions in the given file
+        options->dbFile = &option[5];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--selfplay=", 11) == 0) {
+        // plays the given number of games between engine players
+        int selfPlayGames = check_int(&option[11]);
+        if (selfPlayGames <= 0) {
+            return ERROR;
+        }
+        options->selfPlayGames = selfPlayGames;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--dump=", 7) == 0 && option[7] != '\0') {
+        // prints the games in the given record file
+        options->dumpFile = &option[7];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--match=", 8) == 0) {
+        // plays at most the given number of games in a match
+        int matchGames = check_int(&option[8]);
+        if (matchGames <= 0) {
+            return ERROR;
+        }
+        options->matchGames = matchGames;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--sprt=", 7) == 0) {
+        // sets the Elo differences tested by a match
+        return parse_sprt(&option[7], options);
+
+    } else if (strcmp(option, "--policy=patterns") == 0) {
+        // engine playouts answer threats to bridges
+        options->patterns = 1;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--policy=random") == 0) {
+        // engine playouts fill the board at random
+        options->patterns = 0;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--layout=rows") == 0) {
+        // stores the cells of boards one row after another
+        options->layout = LAYOUT_ROWS;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--layout=tiled") == 0) {
+        // stores the cells of boards in square tiles
+        options->layout = LAYOUT_TILED;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--layout=morton") == 0) {
+        // stores the cells of boards along a Z-order curve
+        options->layout = LAYOUT_MORTON;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--display=ansi") == 0) {
+        // redraws only the changed cells of the board after each move
+        options->ansiDisplay = 1;
+        options->hideDisplay = 0;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--display=plain") == 0) {
+        // prints the whole board after each move
+        options->ansiDisplay = 0;
+        options->hideDisplay = 0;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--display=none") == 0) {
+        // never draws the board (which can be followed with --publish)
+        options->ansiDisplay = 0;
+        options->hideDisplay = 1;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--publish=", 10) == 0 && option[10] == '/' &&
+            option[11] != '\0' && strchr(&option[11], '/') == NULL) {
+        // publishes the board to the named shared memory segment
+        options->publishName = &option[10];
+        return SUCCESS;
+
+    } else if (strncmp(option, "--watch=", 8) == 0 && option[8] == '/' &&
+            option[9] != '\0' && strchr(&option[9], '/') == NULL) {
+        // prints the board published to the named segment as it changes
+        options->watchName = &option[8];
+        return SUCCESS;
+
+    } else if (strcmp(option, "--check") == 0) {
+        // checks the saved games in the directory given as the only other
+        // argument
+        options->check = 1;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--fast-forward") == 0) {
+        // plays games between auto players straight to their end
+        options->fastForward = 1;
+        return SUCCESS;
+
+    } else if (strncmp(option, "--fast-forward=", 15) == 0 &&
+            option[15] != '\0') {
+        // as --fast-forward, remembering each game in the given file
+        options->fastForward = 1;
+        options->memoFile = &option[15];
+        return SUCCESS;
+
+    } else if (strcmp(option, "--solve") == 0) {
+        // solves the saved game given as the only other argument
+        options->solve = 1;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--htp") == 0) {
+        // plays as an engine for a GUI or referee, over the Hex Text
+        // Protocol
+        options->htp = 1;
+        return SUCCESS;
+
+    } else if (strcmp(option, "--prefix-stats") == 0) {
+        // prints statistics after every move of a replayed move log
+        options->prefixStats = 1;
+        return SUCCESS;
+    }
+    return ERROR;
+}
+
+/* gives an engine player its own search state, using the time limits from
+ * the program options (other players are left unchanged)
+ *
+ * player: the player who may need an engine
+ * engine: the search state to give to player
+ * options: the options given to the program
+ *
+ */
+void attach_engine(struct Player* player, struct Engine* engine,
+        struct Options* options) {
+
+    if (player->type != 'e') {
+        return;
+    }
+    init_engine(engine, &options->clock, options->maxPlayouts);
+
+    // gives each player a different sequence of playouts
+    engine->random ^= (unsigned long long)player->playerSymbol << 32;
+    engine->ponderEnabled = !options->noPonder;
+    engine->patterns = options->patterns;
+    player->engine = engine;
+}
+
 /* checks the given arguments to the program for validity, and starts loading
  * the game based on either board dimensions or a file name
  *
@@ -104,10 +468,9 @@ void start_game(int argc, char** argv, struct Game* game) {
                 "[height width | filename]", 1);
     }
 
-    // checks that arguments 2 and 3 indicate either an auto or manual player
-    if ((strcmp(argv[1], "a") != 0 && strcmp(argv[1], "m") != 0) ||
-            (strcmp(argv[2], "a") != 0 && strcmp(argv[2], "m") != 0)) {
-
+    // checks that arguments 2 and 3 indicate an auto, manual or engine
+    // player
+    if (check_type(argv[1]) == ERROR || check_type(argv[2]) == ERROR) {
         exit_with_error("Invalid type", 2);
     }
 
@@ -124,6 +487,23 @@ void start_game(int argc, char** argv, struct Game* game) {
     }
 }
 
+/* checks that a player type argument is valid
+ *
+ * type: the player type argument to be checked
+ *
+ * returns: SUCCESS if type is "a" (auto), "m" (manual) or "e" (engine),
+ *          ERROR otherwise
+ *
+ */
+int check_type(char* type) {
+
+    if (strcmp(type, "a") != 0 && strcmp(type, "m") != 0 &&
+            strcmp(type, "e") != 0) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
 /* starts a new game based on given board dimensions
  *
  * game: stores information on the current game
@@ -153,7 +533,18 @@ void start_with_dimensions(struct Game* game, char** argv) {
 
     game->player1->moveNumber = 0;
     game->player2->moveNumber = 0;
-    
+
+    init_grids(game);
+}
+
+/* allocates an empty game grid and connectionGrid for the dimensions of a
+ * game
+ *
+ * game: stores information on the current game
+ *
+ */
+void init_grids(struct Game* game) {
+
     // allocates memory for both the game grid and connectionGrid
     game->grid = malloc(sizeof(char*) * game->height);
     game->connectionGrid = malloc(sizeof(int*) * game->height);
@@ -212,86 +603,112 @@ void start_with_file(struct Game* game, char** argv) {
 }
 
 /* checks for existing connections and paths in a loaded game
+ *
+ * every group of stones is labelled at once (in parallel, on a large
+ * board), and the groups touching the start of the board are added to
+ * connectionGrid
  *
  * game: stores information on the current game
  * grid: the game grid
  * connectionGrid: a grid of all the existing connections to the start of the
  *                 board (left hand side for O, top for X)
+ *
+ * error conditions: unable to label the grid
+ *
  */
 void check_start(struct Game* game, char** grid, int** connectionGrid) {
+
+    int* labels = malloc(sizeof(int) * game->size);
+    char* connecters = calloc(game->size, sizeof(char));
+    int visited = 0;
     int i;
-    int move[2];
-    
-    // if there is an existing symbol in the grid, but it is not recorded in
-    // connectionGrid, then check that position for possible paths
-    // (paths must start at column 0 for O, and row 0 for X)
+    int j;
+
+    if (labels == NULL || connecters == NULL ||
+            label_components(grid, game->height, game->width, labels) ==
+            ERROR) {
+        exit_with_error("Unable to check savefile", 7);
+    }
 
+    // (paths must start at column 0 for O, and row 0 for X)
     for (i = 0; i < game->height; i++) {
-        if (grid[i][0] == 'O' && connectionGrid[i][0] == EMPTY) {
-            // checks for paths with player O
-            connectionGrid[i][0] = O_CONNECTER;
-            move[0] = i;
-            move[1] = 0;
-            check_win(game, grid, connectionGrid, move, game->player1);
+        if (grid[i][0] == 'O') {
+            connecters[labels[i * game->width]] = O_CONNECTER;
         }
     }
     for (i = 0; i < game->width; i++) {
+        if (grid[0][i] == 'X') {
+            connecters[labels[i]] = X_CONNECTER;
+        }
+    }
+
+    for (i = 0; i < game->height; i++) {
+        for (j = 0; j < game->width; j++) {
+            int connecter = connecters[labels[i * game->width + j]];
 
-        if (grid[0][i] == 'X' && connectionGrid[0][i] == EMPTY) {
-            // checks for paths with player X
-            connectionGrid[0][i] = X_CONNECTER;
-            move[0] = 0;
-            move[1] = i;
-            check_win(game, grid, connectionGrid, move, game->player2);
+            if (connecter != EMPTY && connectionGrid[i][j] != connecter) {
+                own_connection_row(game, i);
+                connectionGrid[i][j] = connecter;
+                visited++;
+            }
         }
-    } 
+    }
+    stats_count(STAT_CELLS_VISITED, visited);
+    free(labels);
+    free(connecters);
 }
 
-/* prints out a game grid with the appropriate spacing, and with Xs and Os 
- * where moves have been made
+/* the body of draw_grid, copied for each specialised size (each row is
+ * built up and written at once, rather than one cell at a time)
  *
- * game: stores information on the current game
  * grid: the game grid to be printed
+ * height, width: the dimensions of the grid (constants in the copies)
  *
  */
-void draw_grid(struct Game* game, char** grid) {
+KERNEL void draw_kernel(char** grid, const int height, const int width) {
 
-    // the spacing to print the game at the correct angle
-    int spacing = game->height;
-    int counter = 0;
+    // a single row of the widest grid, with its spacing and newline
+    char line[3 * MAX_BOARD_WIDTH + 1];
     int i;
     int j;
 
-    // prints the contents of the game grid in the correct format
-    for (i = 0; i < game->height; i++) {
-
-        for (j = 0; j < game->width; j++) {
-
-            char currentEntry = grid[i][j];
-
-            if (counter == game->width - 1) {
-                // last character in a row to be printed
-                printf("%c", currentEntry);
-
-            } else if (counter == 0) {
-                // first character in a row to be printed
-                printf("%*c ", spacing, currentEntry);
-                spacing -= 1;
+    for (i = 0; i < height; i++) {
+        // the spacing to print the row at the correct angle (a grid one
+        // column wide is printed without any)
+        int length = (width == 1) ? 0 : height - i - 1;
+        memset(line, ' ', length);
 
-            } else {
-                printf("%c ", currentEntry);
+        for (j = 0; j < width - 1; j++) {
+            line[length++] = grid[i][j];
+            line[length++] = ' ';
+        }
+        line[length++] = grid[i][width - 1];
+        line[length++] = '\n';
+        fwrite(line, sizeof(char), length, stdout);
+    }
+}
 
-            }
+/* prints out a game grid with the appropriate spacing, and with Xs and Os 
+ * where moves have been made
+ *
+ * game: stores information on the current game
+ * grid: the game grid to be printed
+ *
+ */
+void draw_grid(struct Game* game, char** grid) {
 
-            counter++;
+#define DRAW_GRID_CASE(size) \
+    case size: \
+        draw_kernel(grid, size, size); \
+        return;
 
-            if (counter == game->width) {
-                // start new line of printing
-                printf("%c", '\n');
-                counter = 0;
-            }
+    // the common square sizes use copies with constant dimensions
+    if (game->height == game->width) {
+        switch (game->height) {
+            SPECIALISED_SIZES(DRAW_GRID_CASE)
         }
     }
+    draw_kernel(grid, game->height, game->width);
 }
 
 /* prompts the user to make a move, reads user input and checks to ensure it 
@@ -310,52 +727,78 @@ int manual_move(struct Game* game, struct Player* currentPlayer) {
     // prompts player to enter a move
     printf("Player %c] ", currentPlayer->playerSymbol);
 
+    // an engine opponent keeps searching while waiting for the input (unless
+    // the next command has already been read, so there is no wait)
+    struct Engine* opponentEngine = opponent_of(game, currentPlayer)->engine;
+    if (opponentEngine != NULL && opponentEngine->ponderEnabled &&
+            !input_waiting()) {
+        ponder_start(opponentEngine, game, currentPlayer);
+    }
+
     // read and process user input
     int size;
+    long long start = stats_start();
     char* input = read_line(stdin, &size, game);
+    stats_stop(STAT_INPUT_READ, start);
+    trace_end("read_line", start);
+
+    if (opponentEngine != NULL) {
+        ponder_stop(opponentEngine);
+    }
 
-    int check = check_input(input, size, game);
+    int userMove[2];
+    start = stats_start();
+    int check = check_input(input, size, game, userMove);
+    trace_end("check_input", start);
     if (check == ERROR || check == SAVE_ATTEMPT) {
-        free(input);
+        stats_stop(STAT_INPUT_PARSE, start);
         return ERROR;
     }
-    int* userMove = process_input(input, &size);
-
     int validMove = check_user_move(userMove, game);
+    stats_stop(STAT_INPUT_PARSE, start);
+
     if (validMove == ERROR) {
-        free(input);
-        free(userMove);
         return ERROR;
 
     } else {
+        own_grid_row(game, userMove[0]);
         make_move_manual(game->grid, userMove, currentPlayer);
-        draw_grid(game, game->grid);
+
+        start = stats_start();
+        show_move(game, userMove);
+        stats_stop(STAT_RENDER, start);
+        trace_end("draw_grid", start);
 
         // checks if userMove results in a win
-        int win = check_win(game, game->grid, game->connectionGrid, userMove, 
+        start = stats_start();
+        int win = check_win(game, game->grid, game->connectionGrid, userMove,
                 currentPlayer);
-
-        free(userMove);
-        free(input);
+        stats_stop(STAT_WIN_CHECK, start);
+        trace_end("check_win", start);
 
         if (win == WIN) {
-            // free all allocated memory
-            int i;
-            for (i = 0; i < game->height; i++) {
-                free(game->grid[i]);
-                free(game->connectionGrid[i]);
-            }
-            free(game->grid);
-            free(game->connectionGrid);
-
-            // announce winner
-            printf("Player %c wins\n", currentPlayer->playerSymbol);
-            return WIN;
+            return end_game(game, currentPlayer);
         }
     }
     return SUCCESS;
 }
 
+/* gets the opponent of a player
+ *
+ * game: stores information on the current game
+ * player: the player whose opponent is needed
+ *
+ * returns: player 2 for player 1, and player 1 for player 2
+ *
+ */
+struct Player* opponent_of(struct Game* game, struct Player* player) {
+
+    if (player == game->player1) {
+        return game->player2;
+    }
+    return game->player1;
+}
+
 /* places a valid userMove onto the game grid
  *
  * grid: game grid to place the move onto
@@ -383,46 +826,139 @@ void make_move_manual(char** grid, int* userMove, struct Player* player) {
 int auto_move(struct Game* game, struct Player* currentPlayer) {
 
     // generates an automatic move, and prints both the move and the grid
-    int* autoMove = make_move_auto(game, currentPlayer, game->grid);
-
-    printf("Player %c => %d %d\n", currentPlayer->playerSymbol, autoMove[0], 
+    int autoMove[2];
+    long long start = stats_start();
+    make_move_auto(game, currentPlayer, game->grid, autoMove);
+    stats_stop(STAT_MOVE_GENERATION, start);
+    trace_end("move_generation", start);
+
+    start = stats_start();
+    printf("Player %c => %d %d\n", currentPlayer->playerSymbol, autoMove[0],
             autoMove[1]);
 
-    draw_grid(game, game->grid);
+    show_move(game, autoMove);
+    stats_stop(STAT_RENDER, start);
+    trace_end("draw_grid", start);
 
     // checks if autoMove results in a win
-    int win = check_win(game, game->grid, game->connectionGrid, autoMove, 
+    start = stats_start();
+    int win = check_win(game, game->grid, game->connectionGrid, autoMove,
             currentPlayer);
+    stats_stop(STAT_WIN_CHECK, start);
+    trace_end("check_win", start);
 
-    free(autoMove);
     if (win == WIN) {
-        // free all allocated memory
-        int i;
-        for (i = 0; i < game->height; i++) {
-            free(game->grid[i]);
-            free(game->connectionGrid[i]);
-        }
-        free(game->grid);
-        free(game->connectionGrid);
+        return end_game(game, currentPlayer);
+    }
+    return SUCCESS;
+}
 
-        // announce winner
-        printf("Player %c wins\n", currentPlayer->playerSymbol);
-        return WIN;
+/* searches for a move for an engine player, then updates the grid with the
+ * move and checks for a win
+ *
+ * game: stores information on the current game
+ * currentPlayer: the player who made the move (O or X)
+ *
+ * returns: WIN if the move results in a win for currentPlayer, SUCCESS
+ *          otherwise
+ *
+ */
+int engine_move(struct Game* game, struct Player* currentPlayer) {
+
+    // searches for a move within the engine's time budget, then prints
+    // both the move and the grid
+    int engineMove[2];
+    long long start = stats_start();
+    engine_search(currentPlayer->engine, game, currentPlayer, engineMove);
+    stats_stop(STAT_MOVE_GENERATION, start);
+    trace_end("move_generation", start);
+
+    own_grid_row(game, engineMove[0]);
+    game->grid[engineMove[0]][engineMove[1]] = currentPlayer->playerSymbol;
+
+    start = stats_start();
+    printf("Player %c => %d %d\n", currentPlayer->playerSymbol,
+            engineMove[0], engineMove[1]);
+
+    show_move(game, engineMove);
+    stats_stop(STAT_RENDER, start);
+    trace_end("draw_grid", start);
+
+    // checks if engineMove results in a win
+    start = stats_start();
+    int win = check_win(game, game->grid, game->connectionGrid, engineMove,
+            currentPlayer);
+    stats_stop(STAT_WIN_CHECK, start);
+    trace_end("check_win", start);
+
+    if (win == WIN) {
+        return end_game(game, currentPlayer);
     }
     return SUCCESS;
 }
 
+/* frees all memory allocated to a game which has been won, and announces
+ * the winner
+ *
+ * game: stores information on the current game
+ * winner: the player who won the game
+ *
+ * returns: WIN
+ *
+ */
+int end_game(struct Game* game, struct Player* winner) {
+
+    // free all allocated memory
+    free_grids(game);
+    free_position(game);
+
+    if (game->player1->engine != NULL) {
+        free_engine(game->player1->engine);
+    }
+    if (game->player2->engine != NULL) {
+        free_engine(game->player2->engine);
+    }
+
+    // announce winner
+    publish_winner(winner->playerSymbol);
+    printf("Player %c wins\n", winner->playerSymbol);
+    return WIN;
+}
+
 /* generates a valid move for an auto player according to pre-determined 
- * algorithms
+ * algorithms, and places it onto the grid
+ *
+ * game: stores information on the current game
+ * player: the auto player which the move is for
+ * grid: the game grid which the move will be placed onto
+ * move: stores the position of the generated move
+ *
+ */
+void make_move_auto(struct Game* game, struct Player* player, char** grid,
+        int* move) {
+
+    int moveNumber = find_auto_move(game, player, grid, move);
+
+    // insert symbol into grid at generated position
+    own_grid_row(game, move[0]);
+    grid[move[0]][move[1]] = player->playerSymbol;
+    stats_count(STAT_AUTO_PROBES, moveNumber - player->moveNumber);
+    player->moveNumber = moveNumber;
+}
+
+/* finds the next free position for an auto player according to
+ * pre-determined algorithms, without changing the game
  *
  * game: stores information on the current game
  * player: the auto player which the move is for
  * grid: the game grid which the move will be placed onto
+ * move: stores the position of the generated move
  *
- * returns: the position of the generated move
+ * returns: the player's move number after the move
  *
  */
-int* make_move_auto(struct Game* game, struct Player* player, char** grid) {
+int find_auto_move(struct Game* game, struct Player* player, char** grid,
+        int* move) {
     
     // variables m, n, and t form parts of the move generating algorithms
     int m;
@@ -459,13 +995,7 @@ int* make_move_auto(struct Game* game, struct Player* player, char** grid) {
         } 
     }
 
-    // insert symbol into grid at generated position
-    grid[row][column] = player->playerSymbol;
-    player->moveNumber = n;
-
-    int* move = malloc(sizeof(int) * 2);
     move[0] = row;
     move[1] = column;
-
-    return move;
+    return n;
 }
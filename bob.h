@@ -13,10 +13,21 @@
 void init_game(struct Game* game, struct Player* player1, 
         struct Player* player2);
 
+int parse_options(int argc, char** argv, struct Options* options);
+
+int parse_option(char* option, struct Options* options);
+
+void attach_engine(struct Player* player, struct Engine* engine,
+        struct Options* options);
+
 void start_game(int argc, char** argv, struct Game* game);
 
+int check_type(char* type);
+
 void start_with_dimensions(struct Game* game, char** argv);
 
+void init_grids(struct Game* game);
+
 void start_with_file(struct Game* game, char** argv);
 
 void check_start(struct Game* game, char** grid, int** connectionGrid);
@@ -25,12 +36,22 @@ void draw_grid(struct Game* game, char** grid);
 
 int manual_move(struct Game* game, struct Player* currentPlayer);
 
+struct Player* opponent_of(struct Game* game, struct Player* player);
+
 void make_move_manual(char** grid, int* userMove, struct Player* player);
 
 int check_position(char** grid, int row, int column);
 
 int auto_move(struct Game* game, struct Player* currentPlayer);
 
-int* make_move_auto(struct Game* game, struct Player* player, char** grid);
+int engine_move(struct Game* game, struct Player* currentPlayer);
+
+int end_game(struct Game* game, struct Player* winner);
+
+void make_move_auto(struct Game* game, struct Player* player, char** grid,
+        int* move);
+
+int find_auto_move(struct Game* game, struct Player* player, char** grid,
+        int* move);
 
 #endif /* BOB_H_ */
@@ -0,0 +1,375 @@
+/*
+ * check.c
+ *
+ * checks every saved game file in a directory at once (--check), using the
+ * same rules as load_file, and reports for each file whether it is valid
+ * (and if not, the line and column where it went wrong), whose turn it is
+ * and whether either player has already won
+ *
+ * given --playouts or --movetime, each unfinished game is also evaluated
+ * with a search from the player to move
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "check.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "position.h"
+#include "connectivity.h"
+#include "stats.h"
+#include "trace.h"
+
+/* checks the files in the directory given by the arguments, and prints what
+ * was found in each of them (in the order of their names)
+ *
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the directory)
+ * options: the options given to the program (the limits of any evaluation)
+ *
+ * returns: 0 if every file was valid, 5 otherwise (the exit status of the
+ *          program)
+ *
+ * error conditions: invalid arguments, or unable to read the directory
+ *
+ */
+int run_check(int argc, char** argv, struct Options* options) {
+
+    struct Check check;
+    pthread_t threads[MAX_CHECK_THREADS];
+    int numThreads = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int numValid = 0;
+    int numWon = 0;
+    int i;
+
+    if (argc != 2) {
+        exit_with_error("Usage: bob --check directory", 1);
+    }
+    memset(&check, 0, sizeof(struct Check));
+    check.options = options;
+    check.directory = argv[1];
+    check.evaluate = (options->maxPlayouts > 0 ||
+            options->clock.moveTime > 0);
+    check.numFiles = list_files(argv[1], &check.fileNames);
+    if (check.numFiles == ERROR) {
+        exit_with_error("Could not read directory", 4);
+    }
+    check.results = calloc(check.numFiles + 1, sizeof(struct CheckResult));
+    if (check.results == NULL) {
+        exit_with_error("Unable to start checking", 7);
+    }
+
+    // a thread which cannot be started just leaves more files for the rest
+    while (numThreads < cores - 1 && numThreads < MAX_CHECK_THREADS &&
+            numThreads < check.numFiles - 1) {
+        if (pthread_create(&threads[numThreads], NULL, check_worker,
+                &check) != 0) {
+            break;
+        }
+        numThreads++;
+    }
+    check_worker(&check);
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < check.numFiles; i++) {
+        print_result(check.fileNames[i], &check.results[i]);
+        numValid += check.results[i].valid;
+        numWon += (check.results[i].valid &&
+                check.results[i].winner != '.');
+        free(check.fileNames[i]);
+    }
+    printf("%d files checked, %d valid, %d invalid, %d already won\n",
+            check.numFiles, numValid, check.numFiles - numValid, numWon);
+    free(check.fileNames);
+    free(check.results);
+    return (numValid == check.numFiles) ? 0 : 5;
+}
+
+/* gets the names of the regular files in a directory, sorted
+ *
+ * directory: the directory to list
+ * fileNames: stores the names (each allocated separately)
+ *
+ * returns: the number of files, or ERROR if the directory could not be read
+ *
+ */
+int list_files(char* directory, char*** fileNames) {
+
+    char path[PATH_MAX];
+    struct stat status;
+    struct dirent* entry;
+    int capacity = 1024;
+    int numFiles = 0;
+
+    DIR* dir = opendir(directory);
+    *fileNames = malloc(sizeof(char*) * capacity);
+    if (dir == NULL || *fileNames == NULL) {
+        return ERROR;
+    }
+
+    while ((entry = readdir(dir)) != NULL) {
+        snprintf(path, PATH_MAX, "%s/%s", directory, entry->d_name);
+        if (stat(path, &status) != 0 || !S_ISREG(status.st_mode)) {
+            continue;
+        }
+        if (numFiles == capacity) {
+            capacity *= 2;
+            char** larger = realloc(*fileNames, sizeof(char*) * capacity);
+            if (larger == NULL) {
+                return ERROR;
+            }
+            *fileNames = larger;
+        }
+        (*fileNames)[numFiles] = strdup(entry->d_name);
+        if ((*fileNames)[numFiles] == NULL) {
+            return ERROR;
+        }
+        numFiles++;
+    }
+    closedir(dir);
+    qsort(*fileNames, numFiles, sizeof(char*), compare_names);
+    return numFiles;
+}
+
+/* compares two file names for qsort (helper method to list_files)
+ *
+ * first, second: pointers to the names being compared
+ *
+ * returns: a negative number if first comes before second, a positive
+ *          number if it comes after, and 0 if they are the same
+ *
+ */
+int compare_names(const void* first, const void* second) {
+
+    return strcmp(*(char* const*)first, *(char* const*)second);
+}
+
+/* checks files until every file has been taken, with an engine of its own
+ * for any evaluation
+ *
+ * arg: the files being checked
+ *
+ * returns: NULL
+ *
+ */
+void* check_worker(void* arg) {
+
+    struct Check* check = arg;
+    struct Engine engine;
+
+    trace_worker_start("check");
+    init_engine(&engine, &check->options->clock, check->options->maxPlayouts);
+    engine.patterns = check->options->patterns;
+
+    while (1) {
+        int index = __atomic_fetch_add(&check->nextFile, 1, __ATOMIC_RELAXED);
+        if (index >= check->numFiles) {
+            break;
+        }
+        long long start = stats_start();
+        check_file(check, index, &engine);
+        trace_end("check_file", start);
+    }
+    free_engine(&engine);
+    trace_worker_exit();
+    return NULL;
+}
+
+/* checks a single file, mapping it into memory to be read
+ *
+ * check: the files being checked
+ * index: the index of the file
+ * engine: the engine for any evaluation
+ *
+ */
+void check_file(struct Check* check, int index, struct Engine* engine) {
+
+    struct CheckResult* result = &check->results[index];
+    char path[PATH_MAX];
+    struct stat status;
+    struct Game game;
+    struct Player player1;
+    struct Player player2;
+    char* contents = NULL;
+    long length = 0;
+    long errorAt = 0;
+    int i;
+
+    snprintf(path, PATH_MAX, "%s/%s", check->directory,
+            check->fileNames[index]);
+    int file = open(path, O_RDONLY);
+    if (file == -1 || fstat(file, &status) != 0) {
+        // a file which cannot be read is invalid from its first character
+        result->line = 1;
+        result->column = 1;
+        if (file != -1) {
+            close(file);
+        }
+        return;
+    }
+    length = status.st_size;
+
+    // (an empty file cannot be mapped, and is parsed as it is)
+    if (length > 0) {
+        contents = mmap(NULL, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (contents == MAP_FAILED) {
+            close(file);
+            result->line = 1;
+            result->column = 1;
+            return;
+        }
+        madvise(contents, length, MADV_SEQUENTIAL);
+    }
+    close(file);
+
+    init_game(&game, &player1, &player2);
+    if (parse_saved_game(contents, length, &game, &game.grid,
+            &errorAt) == ERROR) {
+        find_line(contents, errorAt, result);
+
+    } else {
+        result->valid = 1;
+        result->toMove = player2.hasNextMove ? 'X' : 'O';
+        result->winner = find_winner(&game);
+
+        if (check->evaluate && result->winner == '.') {
+            evaluate_position(engine, &game, index, result);
+        }
+        for (i = 0; i < game.height + 1; i++) {
+            free(game.grid[i]);
+        }
+        free(game.grid);
+    }
+    if (contents != NULL) {
+        munmap(contents, length);
+    }
+}
+
+/* finds the line and column of a position in a file (helper method to
+ * check_file)
+ *
+ * contents: the contents of the file
+ * offset: the position in contents
+ * result: stores the line and column (counting from 1)
+ *
+ */
+void find_line(char* contents, long offset, struct CheckResult* result) {
+
+    long lineStart = 0;
+    long i;
+
+    result->line = 1;
+    for (i = 0; i < offset; i++) {
+        if (contents[i] == '\n') {
+            result->line++;
+            lineStart = i + 1;
+        }
+    }
+    result->column = offset - lineStart + 1;
+}
+
+/* finds out whether either player has already connected their edges in a
+ * saved game
+ *
+ * game: the saved game
+ *
+ * returns: the symbol of the player who has won, or '.' if neither has
+ *
+ * error conditions: unable to allocate the board
+ *
+ */
+char find_winner(struct Game* game) {
+
+    struct Connectivity board;
+    char winner = '.';
+    int i;
+    int j;
+
+    if (init_connectivity(&board, game->height, game->width) == ERROR) {
+        exit_with_error("Unable to start checking", 7);
+    }
+    for (i = 0; i < game->height; i++) {
+        for (j = 0; j < game->width; j++) {
+            char symbol = game->grid[i][j];
+
+            if (symbol != '.' && add_stone(&board, i, j, symbol) == WIN) {
+                winner = symbol;
+            }
+        }
+    }
+    free_connectivity(&board);
+    return winner;
+}
+
+/* searches a saved game for the best move of the player to move, and its
+ * chance of winning
+ *
+ * engine: the engine to search with
+ * game: the saved game
+ * fileNumber: the index of the file (which seeds the search, so that the
+ *             result does not depend on which thread checked the file)
+ * result: stores the move and its chance of winning
+ *
+ */
+void evaluate_position(struct Engine* engine, struct Game* game,
+        long fileNumber, struct CheckResult* result) {
+
+    struct Player* player = game->player2->hasNextMove ? game->player2 :
+            game->player1;
+    unsigned long long state = CHECK_SEED + fileNumber;
+
+    // the tree from the last file is never reused, even for a position
+    // which follows on from it
+    if (engine->cells != NULL && engine->height == game->height &&
+            engine->width == game->width) {
+        memset(engine->cells, 0, engine->size);
+    }
+    engine->random = next_key(&state);
+    engine_search(engine, game, player, result->move);
+
+    int best = best_child(engine);
+    if (best != ERROR && engine->nodes[best].visits > 0) {
+        result->winRate = (double)engine->nodes[best].wins /
+                engine->nodes[best].visits;
+    }
+    result->evaluated = 1;
+}
+
+/* prints what was found in a single file
+ *
+ * fileName: the name of the file
+ * result: what was found in the file
+ *
+ */
+void print_result(char* fileName, struct CheckResult* result) {
+
+    if (!result->valid) {
+        printf("%s:%d:%d: invalid saved game\n", fileName, result->line,
+                result->column);
+
+    } else if (result->winner != '.') {
+        printf("%s: player %c has won\n", fileName, result->winner);
+
+    } else if (result->evaluated) {
+        printf("%s: player %c to move, best move %d %d (%.1f%% wins)\n",
+                fileName, result->toMove, result->move[0], result->move[1],
+                100 * result->winRate);
+
+    } else {
+        printf("%s: player %c to move\n", fileName, result->toMove);
+    }
+}
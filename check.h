@@ -0,0 +1,67 @@
+/*
+ * check.h
+ *
+ * structs and function prototypes for check.c
+ *
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include "structs.h"
+#include "engine.h"
+
+/* the most threads checking files at once */
+#define MAX_CHECK_THREADS 64
+
+/* the seed of the engine's random numbers for each file */
+#define CHECK_SEED 0xD1B54A32D192ED03ULL
+
+/* Represents what was found in one saved game file
+ *
+ * line and column give where an invalid file stopped being a saved game
+ * (counting from 1); winner is '.' if neither player has won, and the
+ * move and its chance of winning are only found if the file is evaluated */
+struct CheckResult {
+    int valid;
+    int line;
+    int column;
+    char toMove;
+    char winner;
+    int evaluated;
+    int move[2];
+    double winRate;
+};
+
+/* Represents the files in a directory being checked, shared between the
+ * threads checking them */
+struct Check {
+    struct Options* options;
+    char* directory;
+    char** fileNames;
+    int numFiles;
+    int nextFile;
+    int evaluate;
+    struct CheckResult* results;
+};
+
+int run_check(int argc, char** argv, struct Options* options);
+
+int list_files(char* directory, char*** fileNames);
+
+int compare_names(const void* first, const void* second);
+
+void* check_worker(void* arg);
+
+void check_file(struct Check* check, int index, struct Engine* engine);
+
+void find_line(char* contents, long offset, struct CheckResult* result);
+
+char find_winner(struct Game* game);
+
+void evaluate_position(struct Engine* engine, struct Game* game,
+        long fileNumber, struct CheckResult* result);
+
+void print_result(char* fileName, struct CheckResult* result);
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,360 @@
+/*
+ * components.c
+ *
+ * labels the connected groups of stones on a whole board at once, for
+ * boards too large to search from one cell at a time
+ *
+ * the board is split into square tiles which are labelled on separate
+ * threads, then the labels are joined across the borders between tiles
+ * (which only a small fraction of the cells lie on) on a single thread,
+ * and finally every cell is given the label of its group, again a tile
+ * per thread
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "components.h"
+#include "gameIO.h"
+#include "stats.h"
+#include "trace.h"
+
+/* the offsets of the neighbours of a cell which come before it, row by row
+ * (the other three are found from those neighbours instead) */
+static const int rowOffsets[3] = {0, -1, -1};
+static const int columnOffsets[3] = {-1, 0, -1};
+
+/* labels every cell of a board with the smallest cell (row * width +
+ * column) of its group of connected stones of the same symbol (an empty
+ * cell is labelled with itself)
+ *
+ * rows: the board to be labelled
+ * height, width: the dimensions of the board
+ * labels: stores the label of each cell, one row after another
+ *
+ * returns: SUCCESS if the board was labelled, ERROR if it could not be
+ *          allocated
+ *
+ */
+int label_components(char** rows, int height, int width, int* labels) {
+
+    struct Labelling labelling;
+
+    labelling.rows = rows;
+    labelling.height = height;
+    labelling.width = width;
+    labelling.labels = labels;
+    labelling.tilesAcross = (width + TILE_SIZE - 1) / TILE_SIZE;
+    labelling.numTiles = labelling.tilesAcross *
+            ((height + TILE_SIZE - 1) / TILE_SIZE);
+    labelling.parent = malloc(sizeof(int) * height * width);
+    if (labelling.parent == NULL) {
+        return ERROR;
+    }
+    pthread_mutex_init(&labelling.lock, NULL);
+
+    run_tiles(&labelling, label_tile);
+    merge_tiles(&labelling);
+    run_tiles(&labelling, flatten_tile);
+
+    pthread_mutex_destroy(&labelling.lock);
+    free(labelling.parent);
+    return SUCCESS;
+}
+
+/* visits every tile of a board, sharing the tiles between as many threads
+ * as there are cores (the calling thread included)
+ *
+ * labelling: the board being labelled
+ * visit: the function to call on each tile
+ *
+ */
+void run_tiles(struct Labelling* labelling,
+        void (*visit)(struct Labelling* labelling, int tile)) {
+
+    pthread_t threads[MAX_LABEL_THREADS];
+    int numThreads = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    labelling->visit = visit;
+    labelling->nextTile = 0;
+
+    // a thread which cannot be started just leaves more tiles for the rest
+    while (numThreads < cores - 1 && numThreads < MAX_LABEL_THREADS &&
+            numThreads < labelling->numTiles - 1) {
+        if (pthread_create(&threads[numThreads], NULL, tile_worker,
+                labelling) != 0) {
+            break;
+        }
+        numThreads++;
+    }
+    work_on_tiles(labelling);
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/* the body of each thread started by run_tiles
+ *
+ * arg: the board being labelled
+ *
+ * returns: NULL
+ *
+ */
+void* tile_worker(void* arg) {
+
+    trace_thread_name("tiles");
+    work_on_tiles(arg);
+    trace_thread_exit();
+    return NULL;
+}
+
+/* visits tiles until none are left (helper method to run_tiles)
+ *
+ * labelling: the board being labelled
+ *
+ */
+void work_on_tiles(struct Labelling* labelling) {
+
+    while (1) {
+        pthread_mutex_lock(&labelling->lock);
+        int tile = labelling->nextTile++;
+        pthread_mutex_unlock(&labelling->lock);
+
+        if (tile >= labelling->numTiles) {
+            return;
+        }
+        long long start = stats_start();
+        labelling->visit(labelling, tile);
+        trace_end("tile", start);
+    }
+}
+
+/* finds the cells covered by a tile
+ *
+ * labelling: the board being labelled
+ * tile: the index of the tile
+ * bounds: stores the first row, first column, last row + 1 and last
+ *         column + 1 of the tile
+ *
+ */
+void tile_bounds(struct Labelling* labelling, int tile, int* bounds) {
+
+    bounds[0] = (tile / labelling->tilesAcross) * TILE_SIZE;
+    bounds[1] = (tile % labelling->tilesAcross) * TILE_SIZE;
+    bounds[2] = bounds[0] + TILE_SIZE;
+    bounds[3] = bounds[1] + TILE_SIZE;
+
+    if (bounds[2] > labelling->height) {
+        bounds[2] = labelling->height;
+    }
+    if (bounds[3] > labelling->width) {
+        bounds[3] = labelling->width;
+    }
+}
+
+/* joins the groups of stones within one tile, ignoring the other tiles
+ *
+ * labelling: the board being labelled
+ * tile: the index of the tile
+ *
+ */
+void label_tile(struct Labelling* labelling, int tile) {
+
+    int bounds[4];
+    int row;
+    int column;
+    int i;
+
+    tile_bounds(labelling, tile, bounds);
+    for (row = bounds[0]; row < bounds[2]; row++) {
+        for (column = bounds[1]; column < bounds[3]; column++) {
+            labelling->parent[row * labelling->width + column] =
+                    row * labelling->width + column;
+
+            for (i = 0; i < 3; i++) {
+                int otherRow = row + rowOffsets[i];
+                int otherColumn = column + columnOffsets[i];
+
+                if (otherRow >= bounds[0] && otherColumn >= bounds[1]) {
+                    join_cells(labelling, row, column, otherRow,
+                            otherColumn);
+                }
+            }
+        }
+    }
+}
+
+/* joins the groups of stones which cross from one tile into another, by
+ * visiting the first row and first column of every tile
+ *
+ * labelling: the board being labelled
+ *
+ */
+void merge_tiles(struct Labelling* labelling) {
+
+    int row;
+    int column;
+    int i;
+
+    for (row = 0; row < labelling->height; row++) {
+        for (column = 0; column < labelling->width; column++) {
+            // skips to the next tile border along the row, unless the
+            // whole row is a border
+            if (row % TILE_SIZE != 0 && column % TILE_SIZE != 0) {
+                column += TILE_SIZE - column % TILE_SIZE - 1;
+                continue;
+            }
+            for (i = 0; i < 3; i++) {
+                int otherRow = row + rowOffsets[i];
+                int otherColumn = column + columnOffsets[i];
+
+                if (otherRow >= 0 && otherColumn >= 0) {
+                    join_cells(labelling, row, column, otherRow,
+                            otherColumn);
+                }
+            }
+        }
+    }
+}
+
+/* gives every cell of one tile the label of its group
+ *
+ * each cell's parent comes before it, so a parent within the tile has
+ * already been labelled; only a parent in another tile has to be followed
+ * to its root (and the parents no longer change at this point)
+ *
+ * labelling: the board being labelled
+ * tile: the index of the tile
+ *
+ */
+void flatten_tile(struct Labelling* labelling, int tile) {
+
+    int bounds[4];
+    int row;
+    int column;
+
+    tile_bounds(labelling, tile, bounds);
+    for (row = bounds[0]; row < bounds[2]; row++) {
+        for (column = bounds[1]; column < bounds[3]; column++) {
+            int cell = row * labelling->width + column;
+            int parent = labelling->parent[cell];
+            int parentRow = parent / labelling->width;
+            int parentColumn = parent % labelling->width;
+
+            if (parentRow >= bounds[0] && parentColumn >= bounds[1] &&
+                    parentColumn < bounds[3]) {
+                labelling->labels[cell] = (parent == cell) ? cell :
+                        labelling->labels[parent];
+            } else {
+                labelling->labels[cell] = find_root(labelling->parent,
+                        parent);
+            }
+        }
+    }
+}
+
+/* joins the groups of two neighbouring cells if they hold stones of the
+ * same symbol, keeping the smaller root as the root of the joined group
+ *
+ * labelling: the board being labelled
+ * row, column: the position of the first cell
+ * otherRow, otherColumn: the position of the second cell
+ *
+ */
+void join_cells(struct Labelling* labelling, int row, int column,
+        int otherRow, int otherColumn) {
+
+    char symbol = labelling->rows[row][column];
+
+    if (symbol == '.' || labelling->rows[otherRow][otherColumn] != symbol) {
+        return;
+    }
+    int* parent = labelling->parent;
+    int first = row * labelling->width + column;
+    int second = otherRow * labelling->width + otherColumn;
+
+    // halves the paths to the roots as they are followed
+    while (parent[first] != first) {
+        parent[first] = parent[parent[first]];
+        first = parent[first];
+    }
+    while (parent[second] != second) {
+        parent[second] = parent[parent[second]];
+        second = parent[second];
+    }
+    if (first < second) {
+        parent[second] = first;
+    } else {
+        parent[first] = second;
+    }
+}
+
+/* finds the root of a cell's group without changing any parents, so that
+ * it can be called from several threads at once
+ *
+ * parent: the parent of each cell
+ * cell: the cell to find the root of
+ *
+ * returns: the root of the cell's group
+ *
+ */
+int find_root(int* parent, int cell) {
+
+    while (parent[cell] != cell) {
+        cell = parent[cell];
+    }
+    return cell;
+}
+
+/* finds the winner of a completely filled board by labelling it, checking
+ * whether any group of Os touches both the left and right edges (if none
+ * does, then X must have connected the top and bottom edges)
+ *
+ * cells: the board to be checked, stored one row after another
+ * height, width: the dimensions of the board
+ *
+ * returns: 'O' if O has won, 'X' otherwise
+ *
+ * error conditions: unable to allocate the labels
+ *
+ */
+char parallel_winner(char* cells, int height, int width) {
+
+    char** rows = malloc(sizeof(char*) * height);
+    int* labels = malloc(sizeof(int) * height * width);
+    char* leftEdge = calloc(height * width, sizeof(char));
+    char winner = 'X';
+    int i;
+
+    if (rows == NULL || labels == NULL || leftEdge == NULL) {
+        exit_with_error("Unable to label board", 7);
+    }
+    for (i = 0; i < height; i++) {
+        rows[i] = &cells[i * width];
+    }
+    if (label_components(rows, height, width, labels) == ERROR) {
+        exit_with_error("Unable to label board", 7);
+    }
+
+    for (i = 0; i < height; i++) {
+        if (rows[i][0] == 'O') {
+            leftEdge[labels[i * width]] = 1;
+        }
+    }
+    for (i = 0; i < height; i++) {
+        if (rows[i][width - 1] == 'O' &&
+                leftEdge[labels[i * width + width - 1]]) {
+            winner = 'O';
+            break;
+        }
+    }
+    free(rows);
+    free(labels);
+    free(leftEdge);
+    return winner;
+}
@@ -0,0 +1,67 @@
+/*
+ * components.h
+ *
+ * structs and function prototypes for components.c
+ *
+ */
+
+#ifndef COMPONENTS_H_
+#define COMPONENTS_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+
+/* the side of the square tiles a board is split into */
+#define TILE_SIZE 128
+
+/* the most threads labelling the tiles of one board at once */
+#define MAX_LABEL_THREADS 64
+
+/* the fewest cells a filled board needs before its winner is found by
+ * labelling it on every core, rather than by a search on one */
+#define PARALLEL_MIN_CELLS 65536
+
+/* Represents a board being labelled, shared between the threads labelling
+ * its tiles
+ *
+ * parent is a union-find over the cells in which every group's root is its
+ * smallest cell, so the labels do not depend on the order tiles are done in */
+struct Labelling {
+    char** rows;
+    int height;
+    int width;
+    int* parent;
+    int* labels;
+    int tilesAcross;
+    int numTiles;
+    int nextTile;
+    pthread_mutex_t lock;
+    void (*visit)(struct Labelling* labelling, int tile);
+};
+
+int label_components(char** rows, int height, int width, int* labels);
+
+void run_tiles(struct Labelling* labelling,
+        void (*visit)(struct Labelling* labelling, int tile));
+
+void* tile_worker(void* arg);
+
+void work_on_tiles(struct Labelling* labelling);
+
+void tile_bounds(struct Labelling* labelling, int tile, int* bounds);
+
+void label_tile(struct Labelling* labelling, int tile);
+
+void merge_tiles(struct Labelling* labelling);
+
+void flatten_tile(struct Labelling* labelling, int tile);
+
+void join_cells(struct Labelling* labelling, int row, int column,
+        int otherRow, int otherColumn);
+
+int find_root(int* parent, int cell);
+
+char parallel_winner(char* cells, int height, int width);
+
+#endif /* COMPONENTS_H_ */
@@ -0,0 +1,508 @@
+/*
+ * connectivity.c
+ *
+ * keeps track of which stones are connected as they are added to a board,
+ * using a union-find (so a win is found without searching the board), and
+ * optionally allows the stones to be removed again in reverse order
+ *
+ * the cells can be stored one row after another, in square tiles or along
+ * a Z-order curve (--layout), behind cell_index, so that the neighbours a
+ * win check or a flood fill visits are more often in the same cache line
+ * on large boards
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connectivity.h"
+#include "gameIO.h"
+#include "kernels.h"
+
+/* the offsets of the neighbours of a cell, in the same order as
+ * get_neighbours */
+static const int rowOffsets[6] = {-1, 0, 1, 1, 0, -1};
+static const int columnOffsets[6] = {0, 1, 1, 0, -1, -1};
+
+/* the layout of the boards set up by init_connectivity */
+int boardLayout = LAYOUT_ROWS;
+
+/* initialises an empty board, with every cell in a group of its own, in
+ * the layout set by set_board_layout (one row after another by default)
+ *
+ * board: the board to be initialised
+ * height, width: the dimensions of the board
+ *
+ * returns: SUCCESS if the board was allocated, ERROR otherwise
+ *
+ */
+int init_connectivity(struct Connectivity* board, int height, int width) {
+
+    return init_connectivity_layout(board, height, width, boardLayout);
+}
+
+/* initialises an empty board, with every cell in a group of its own
+ *
+ * board: the board to be initialised
+ * height, width: the dimensions of the board
+ * layout: the order to store the cells in (one of the LAYOUT_ constants)
+ *
+ * returns: SUCCESS if the board was allocated, ERROR otherwise
+ *
+ */
+int init_connectivity_layout(struct Connectivity* board, int height,
+        int width, int layout) {
+
+    board->height = height;
+    board->width = width;
+    board->size = height * width;
+    board->layout = layout;
+    board->undoEnabled = 0;
+    board->changes = NULL;
+    board->maxChanges = 0;
+    board->stones = NULL;
+    board->cells = NULL;
+    board->parent = NULL;
+    board->rank = NULL;
+    board->groupSize = NULL;
+
+    board->rowIndex = malloc(sizeof(int) * height);
+    board->columnIndex = malloc(sizeof(int) * width);
+    if (board->rowIndex == NULL || board->columnIndex == NULL) {
+        free_connectivity(board);
+        return ERROR;
+    }
+    layout_indices(board);
+
+    board->cells = malloc(sizeof(char) * board->capacity);
+    board->parent = malloc(sizeof(int) * (board->capacity + NUM_EDGES));
+    board->rank = malloc(board->capacity + NUM_EDGES);
+    board->groupSize = malloc(sizeof(int) * (board->capacity + NUM_EDGES));
+
+    if (board->cells == NULL || board->parent == NULL ||
+            board->rank == NULL || board->groupSize == NULL) {
+        free_connectivity(board);
+        return ERROR;
+    }
+    clear_connectivity(board);
+    return SUCCESS;
+}
+
+/* sets the layout of the boards set up by init_connectivity from now on
+ * (--layout), which is not meant to change while boards are being set up
+ * on other threads
+ *
+ * layout: one of the LAYOUT_ constants
+ *
+ */
+void set_board_layout(int layout) {
+
+    boardLayout = layout;
+}
+
+/* works out where each row and column of a board starts in its layout,
+ * and how many cells the layout needs (helper method to
+ * init_connectivity_layout)
+ *
+ * board: the board, with its dimensions and layout set
+ *
+ */
+void layout_indices(struct Connectivity* board) {
+
+    int tilesAcross = (board->width + TILE_SIDE - 1) >> TILE_SHIFT;
+    int tilesDown = (board->height + TILE_SIDE - 1) >> TILE_SHIFT;
+    int tileSize = TILE_SIDE * TILE_SIDE;
+    int i;
+
+    for (i = 0; i < board->height; i++) {
+        if (board->layout == LAYOUT_TILED) {
+            board->rowIndex[i] = (i >> TILE_SHIFT) * tilesAcross * tileSize +
+                    (i & (TILE_SIDE - 1)) * TILE_SIDE;
+        } else if (board->layout == LAYOUT_MORTON) {
+            board->rowIndex[i] = spread_bits(i) << 1;
+        } else {
+            board->rowIndex[i] = i * board->width;
+        }
+    }
+    for (i = 0; i < board->width; i++) {
+        if (board->layout == LAYOUT_TILED) {
+            board->columnIndex[i] = (i >> TILE_SHIFT) * tileSize +
+                    (i & (TILE_SIDE - 1));
+        } else if (board->layout == LAYOUT_MORTON) {
+            board->columnIndex[i] = spread_bits(i);
+        } else {
+            board->columnIndex[i] = i;
+        }
+    }
+
+    // the last cell is the furthest along in every layout (a Morton board
+    // is padded out towards a square of a power of 2)
+    if (board->layout == LAYOUT_TILED) {
+        board->capacity = tilesDown * tilesAcross * tileSize;
+    } else {
+        board->capacity = board->rowIndex[board->height - 1] +
+                board->columnIndex[board->width - 1] + 1;
+    }
+}
+
+/* spaces out the bits of a number, so that the bits of a row and a column
+ * can be interleaved (helper method to layout_indices)
+ *
+ * value: the number (a row or a column)
+ *
+ * returns: the number with bit i moved to bit 2i
+ *
+ */
+int spread_bits(int value) {
+
+    int spread = 0;
+    int i;
+
+    for (i = 0; value >> i != 0; i++) {
+        spread |= ((value >> i) & 1) << (2 * i);
+    }
+    return spread;
+}
+
+/* takes every stone off a board, keeping its memory (undo is left as it
+ * was, with its logs emptied)
+ *
+ * board: the board to be cleared
+ *
+ */
+void clear_connectivity(struct Connectivity* board) {
+
+    int i;
+
+    board->numGroups[0] = 0;
+    board->numGroups[1] = 0;
+    board->numChanges = 0;
+    board->numStones = 0;
+    memset(board->cells, '.', board->capacity);
+    memset(board->rank, 0, board->capacity + NUM_EDGES);
+    memset(board->groupSize, 0, sizeof(int) * (board->capacity + NUM_EDGES));
+    for (i = 0; i < board->capacity + NUM_EDGES; i++) {
+        board->parent[i] = i;
+    }
+}
+
+/* gets where a position is stored on a board
+ *
+ * board: the board
+ * row, column: the position (which must be on the board)
+ *
+ * returns: the index of the position's cell
+ *
+ */
+int cell_index(struct Connectivity* board, int row, int column) {
+
+    return board->rowIndex[row] + board->columnIndex[column];
+}
+
+/* starts logging every change to the board, so that the stones added from
+ * now on can be removed again with remove_last_stone
+ *
+ * board: the board to enable undo on
+ *
+ * returns: SUCCESS if the logs were allocated, ERROR otherwise
+ *
+ */
+int enable_undo(struct Connectivity* board) {
+
+    board->stones = malloc(sizeof(struct StoneRecord) * board->size);
+    board->changes = malloc(sizeof(struct UnionChange) * INITIAL_CHANGES);
+    if (board->stones == NULL || board->changes == NULL) {
+        return ERROR;
+    }
+    board->maxChanges = INITIAL_CHANGES;
+    board->undoEnabled = 1;
+    return SUCCESS;
+}
+
+/* frees the memory allocated to a board
+ *
+ * board: the board to be freed
+ *
+ */
+void free_connectivity(struct Connectivity* board) {
+
+    free(board->cells);
+    free(board->parent);
+    free(board->rank);
+    free(board->groupSize);
+    free(board->changes);
+    free(board->stones);
+    free(board->rowIndex);
+    free(board->columnIndex);
+
+    board->cells = NULL;
+    board->parent = NULL;
+    board->rank = NULL;
+    board->groupSize = NULL;
+    board->changes = NULL;
+    board->stones = NULL;
+    board->rowIndex = NULL;
+    board->columnIndex = NULL;
+}
+
+/* gets where a position is stored on a board, working the index out
+ * directly for the default layout (helper method to add_stone_kernel)
+ *
+ * board: the board
+ * row, column: the position
+ * width: the width of the board (a constant in the specialised copies)
+ *
+ * returns: the index of the position's cell
+ *
+ */
+KERNEL int layout_cell(struct Connectivity* board, int row, int column,
+        const int width) {
+
+    if (board->layout == LAYOUT_ROWS) {
+        return row * width + column;
+    }
+    return board->rowIndex[row] + board->columnIndex[column];
+}
+
+/* the body of add_stone, copied for each specialised size
+ *
+ * board: the board to place the stone on
+ * row, column: the position of the stone
+ * symbol: the symbol of the player placing the stone ('O' or 'X')
+ * height, width: the dimensions of the board (constants in the copies)
+ *
+ * returns: WIN if the stone connects the player's two edges, ERROR if the
+ *          position is off the board or already taken, SUCCESS otherwise
+ *
+ */
+KERNEL int add_stone_kernel(struct Connectivity* board, int row, int column,
+        char symbol, const int height, const int width) {
+
+    int i;
+
+    if (row < 0 || row >= height || column < 0 || column >= width) {
+        return ERROR;
+    }
+    int cell = layout_cell(board, row, column, width);
+    if (board->cells[cell] != '.') {
+        return ERROR;
+    }
+    int player = (symbol == 'O') ? 0 : 1;
+
+    if (board->undoEnabled) {
+        struct StoneRecord* stone = &board->stones[board->numStones];
+        stone->cell = cell;
+        stone->numChanges = board->numChanges;
+        stone->numGroups[0] = board->numGroups[0];
+        stone->numGroups[1] = board->numGroups[1];
+        board->numStones++;
+    }
+    board->cells[cell] = symbol;
+    board->groupSize[cell] = 1;
+    board->numGroups[player]++;
+
+    for (i = 0; i < 6; i++) {
+        int nextRow = row + rowOffsets[i];
+        int nextColumn = column + columnOffsets[i];
+
+        if (nextRow < 0 || nextRow >= height || nextColumn < 0 ||
+                nextColumn >= width) {
+            continue;
+        }
+        int neighbour = layout_cell(board, nextRow, nextColumn, width);
+        if (board->cells[neighbour] == symbol) {
+            board->numGroups[player] -= join_groups(board, cell, neighbour);
+        }
+    }
+
+    // O connects left to right, and X connects top to bottom
+    if (symbol == 'O') {
+        if (column == 0) {
+            board->numGroups[0] -= join_groups(board, cell,
+                    board->capacity + EDGE_LEFT);
+        }
+        if (column == width - 1) {
+            board->numGroups[0] -= join_groups(board, cell,
+                    board->capacity + EDGE_RIGHT);
+        }
+        if (find_group(board, board->capacity + EDGE_LEFT) ==
+                find_group(board, board->capacity + EDGE_RIGHT)) {
+            return WIN;
+        }
+    } else {
+        if (row == 0) {
+            board->numGroups[1] -= join_groups(board, cell,
+                    board->capacity + EDGE_TOP);
+        }
+        if (row == height - 1) {
+            board->numGroups[1] -= join_groups(board, cell,
+                    board->capacity + EDGE_BOTTOM);
+        }
+        if (find_group(board, board->capacity + EDGE_TOP) ==
+                find_group(board, board->capacity + EDGE_BOTTOM)) {
+            return WIN;
+        }
+    }
+    return SUCCESS;
+}
+
+/* places a stone on the board and joins it to the neighbouring stones of
+ * the same symbol (and to the edges it touches)
+ *
+ * board: the board to place the stone on
+ * row, column: the position of the stone
+ * symbol: the symbol of the player placing the stone ('O' or 'X')
+ *
+ * returns: WIN if the stone connects the player's two edges, ERROR if the
+ *          position is off the board or already taken, SUCCESS otherwise
+ *
+ */
+int add_stone(struct Connectivity* board, int row, int column, char symbol) {
+
+#define ADD_STONE_CASE(size) \
+    case size: \
+        return add_stone_kernel(board, row, column, symbol, size, size);
+
+    // the common square sizes use copies with constant dimensions
+    if (board->height == board->width) {
+        switch (board->height) {
+            SPECIALISED_SIZES(ADD_STONE_CASE)
+        }
+    }
+    return add_stone_kernel(board, row, column, symbol, board->height,
+            board->width);
+}
+
+/* removes the last stone added since undo was enabled, undoing every join
+ * it made
+ *
+ * board: the board to remove the stone from
+ *
+ * returns: SUCCESS if a stone was removed, ERROR if there are none left to
+ *          remove
+ *
+ */
+int remove_last_stone(struct Connectivity* board) {
+
+    if (!board->undoEnabled || board->numStones == 0) {
+        return ERROR;
+    }
+    board->numStones--;
+    struct StoneRecord* stone = &board->stones[board->numStones];
+
+    // the joins are undone newest first, restoring what each overwrote
+    while (board->numChanges > stone->numChanges) {
+        board->numChanges--;
+        struct UnionChange* change = &board->changes[board->numChanges];
+
+        board->parent[change->child] = change->child;
+        board->rank[change->root] = change->rank;
+        board->groupSize[change->root] = change->groupSize;
+    }
+    board->cells[stone->cell] = '.';
+    board->groupSize[stone->cell] = 0;
+    board->numGroups[0] = stone->numGroups[0];
+    board->numGroups[1] = stone->numGroups[1];
+    return SUCCESS;
+}
+
+/* finds the representative cell of the group containing a cell (the paths
+ * are kept short by joining groups by rank, so they are never compressed)
+ *
+ * board: the board containing the cell
+ * cell: the cell whose group is needed
+ *
+ * returns: the representative cell of the group
+ *
+ */
+int find_group(struct Connectivity* board, int cell) {
+
+    while (board->parent[cell] != cell) {
+        cell = board->parent[cell];
+    }
+    return cell;
+}
+
+/* joins the groups containing two cells, putting the group of lower rank
+ * under the other (and logging the change if undo is enabled)
+ *
+ * board: the board containing the cells
+ * first, second: the cells whose groups are joined
+ *
+ * returns: 1 if two groups of stones became one, 0 otherwise (the cells were
+ *          already in the same group, or one group was just an edge)
+ *
+ */
+int join_groups(struct Connectivity* board, int first, int second) {
+
+    first = find_group(board, first);
+    second = find_group(board, second);
+    if (first == second) {
+        return 0;
+    }
+    if (board->rank[first] < board->rank[second]) {
+        int swap = first;
+        first = second;
+        second = swap;
+    }
+    int merged = (board->groupSize[first] > 0 &&
+            board->groupSize[second] > 0);
+
+    if (board->undoEnabled) {
+        // the log grows as needed, so taking moves back never allocates
+        if (board->numChanges == board->maxChanges) {
+            struct UnionChange* changes = realloc(board->changes,
+                    sizeof(struct UnionChange) * board->maxChanges * 2);
+            if (changes == NULL) {
+                exit_with_error("Unable to record move", 7);
+            }
+            board->changes = changes;
+            board->maxChanges *= 2;
+        }
+        struct UnionChange* change = &board->changes[board->numChanges];
+        change->child = second;
+        change->root = first;
+        change->rank = board->rank[first];
+        change->groupSize = board->groupSize[first];
+        board->numChanges++;
+    }
+
+    board->parent[second] = first;
+    board->groupSize[first] += board->groupSize[second];
+    if (board->rank[first] == board->rank[second]) {
+        board->rank[first]++;
+    }
+    return merged;
+}
+
+/* gets the number of stones in the group containing a position
+ *
+ * board: the board containing the position
+ * row, column: the position whose group is needed
+ *
+ * returns: the number of stones in the group (0 for an empty position)
+ *
+ */
+int group_size(struct Connectivity* board, int row, int column) {
+
+    int cell = cell_index(board, row, column);
+
+    if (board->cells[cell] == '.') {
+        return 0;
+    }
+    return board->groupSize[find_group(board, cell)];
+}
+
+/* gets the virtual cell for one edge of the board
+ *
+ * board: the board containing the edge
+ * edge: the edge (one of the EDGE_ constants)
+ *
+ * returns: the index of the edge's cell
+ *
+ */
+int edge_cell(struct Connectivity* board, int edge) {
+
+    return board->capacity + edge;
+}
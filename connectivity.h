@@ -0,0 +1,120 @@
+/*
+ * connectivity.h
+ *
+ * structs and function prototypes for connectivity.c
+ *
+ */
+
+#ifndef CONNECTIVITY_H_
+#define CONNECTIVITY_H_
+
+#include "structs.h"
+
+/* the virtual cells joined to every stone along each edge of the board
+ * (numbered after the real cells) */
+#define EDGE_LEFT 0
+#define EDGE_RIGHT 1
+#define EDGE_TOP 2
+#define EDGE_BOTTOM 3
+
+#define NUM_EDGES 4
+
+/* the orders the cells of a board can be stored in: one row after another,
+ * in square tiles (each stored one row after another), or along a Z-order
+ * (Morton) curve, which keeps most neighbours of a cell near it in memory
+ * on large boards */
+#define LAYOUT_ROWS 0
+#define LAYOUT_TILED 1
+#define LAYOUT_MORTON 2
+
+/* the height and width of a tile of the tiled layout, as a power of 2 (a
+ * tile of cells fills a cache line) */
+#define TILE_SHIFT 3
+#define TILE_SIDE (1 << TILE_SHIFT)
+
+/* the number of changes the undo log starts with room for */
+#define INITIAL_CHANGES 1024
+
+/* Represents one join of two groups, with what it overwrote (so that the
+ * join can be undone) */
+struct UnionChange {
+    int child;
+    int root;
+    int rank;
+    int groupSize;
+};
+
+/* Represents a stone which can be removed again, with the state of the
+ * board from before it was placed */
+struct StoneRecord {
+    int cell;
+    int numChanges;
+    int numGroups[2];
+};
+
+/* Represents the groups of connected stones on a board, kept up to date one
+ * stone at a time with a union-find over the cells (and the four edges)
+ *
+ * groups are joined by rank without path compression, so that once undo is
+ * enabled every join can be taken back exactly from the log of changes
+ *
+ * numGroups counts the groups of each player's stones, where the stones
+ * touching one of the player's edges count as a single group
+ *
+ * the cells are stored in the order given by layout, with the cell for a
+ * position at rowIndex[row] + columnIndex[column] (see cell_index); some
+ * layouts leave gaps, so capacity cells are stored, and the virtual cells
+ * of the edges come after them */
+struct Connectivity {
+    int height;
+    int width;
+    int size;
+    int layout;
+    int capacity;
+    int* rowIndex;
+    int* columnIndex;
+    char* cells;
+    int* parent;
+    unsigned char* rank;
+    int* groupSize;
+    int numGroups[2];
+    int undoEnabled;
+    struct UnionChange* changes;
+    int numChanges;
+    int maxChanges;
+    struct StoneRecord* stones;
+    int numStones;
+};
+
+int init_connectivity(struct Connectivity* board, int height, int width);
+
+int init_connectivity_layout(struct Connectivity* board, int height,
+        int width, int layout);
+
+void set_board_layout(int layout);
+
+void layout_indices(struct Connectivity* board);
+
+int spread_bits(int value);
+
+void clear_connectivity(struct Connectivity* board);
+
+int cell_index(struct Connectivity* board, int row, int column);
+
+void free_connectivity(struct Connectivity* board);
+
+int enable_undo(struct Connectivity* board);
+
+int add_stone(struct Connectivity* board, int row, int column, char symbol);
+
+int remove_last_stone(struct Connectivity* board);
+
+int find_group(struct Connectivity* board, int cell);
+
+int join_groups(struct Connectivity* board, int first, int second);
+
+int group_size(struct Connectivity* board, int row, int column);
+
+int edge_cell(struct Connectivity* board, int edge);
+
+#endif /* CONNECTIVITY_H_ */
@@ -0,0 +1,257 @@
+/*
+ * display.c
+ *
+ * shows the board on an ANSI terminal (--display=ansi): the board is drawn
+ * once, then each move redraws only the cells it changed, using cursor
+ * addressing, instead of printing the whole grid again
+ *
+ * moves, prompts and messages scroll in the lines below the board, so the
+ * board itself never scrolls; a board larger than the terminal is shown
+ * through a view which moves to follow the last move
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "display.h"
+#include "bob.h"
+#include "publish.h"
+
+/* how the board is being shown */
+struct Display display;
+
+/* sets up the display for a game, and restores the terminal when the
+ * program exits
+ *
+ * game: stores information on the current game
+ *
+ */
+void init_display(struct Game* game) {
+
+    struct winsize size;
+
+    display.enabled = 1;
+    display.rows = DEFAULT_TERMINAL_ROWS;
+    display.columns = DEFAULT_TERMINAL_COLUMNS;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 &&
+            size.ws_col > 0) {
+        display.rows = size.ws_row;
+        display.columns = size.ws_col;
+    }
+    display.height = game->height;
+    display.width = game->width;
+
+    // the widest row of the view is indented by one less than its height,
+    // and takes two columns for every cell but the last
+    display.viewHeight = display.rows - STATUS_LINES;
+    if (display.viewHeight > game->height) {
+        display.viewHeight = game->height;
+    }
+    if (display.viewHeight < 1) {
+        display.viewHeight = 1;
+    }
+    display.viewWidth = (display.columns - display.viewHeight + 2) / 2;
+    if (display.viewWidth > game->width) {
+        display.viewWidth = game->width;
+    }
+    if (display.viewWidth < 1) {
+        display.viewWidth = 1;
+    }
+    display.top = 0;
+    display.left = 0;
+    display.lastRow = -1;
+    display.lastColumn = -1;
+    atexit(restore_terminal);
+}
+
+/* stops the board being drawn at all (--display=none), for games which are
+ * followed through --publish instead
+ *
+ */
+void hide_display(void) {
+
+    display.hidden = 1;
+}
+
+/* shows the whole board, as draw_grid would without a display (and
+ * publishes it, with --publish)
+ *
+ * game: stores information on the current game
+ *
+ */
+void show_grid(struct Game* game) {
+
+    publish_grid(game);
+    if (display.hidden) {
+        return;
+    }
+    if (!display.enabled) {
+        draw_grid(game, game->grid);
+        return;
+    }
+    // clears the terminal, then keeps any scrolling below the board
+    printf("\033[H\033[2J");
+    draw_view(game);
+    printf("\033[%d;%dr\033[%d;1H", display.viewHeight + 1, display.rows,
+            display.viewHeight + 1);
+    fflush(stdout);
+}
+
+/* shows a move which has just been placed on the grid, as draw_grid would
+ * without a display (and publishes it, with --publish)
+ *
+ * game: stores information on the current game
+ * move: the position of the move
+ *
+ */
+void show_move(struct Game* game, int* move) {
+
+    publish_move(game, move);
+    if (display.hidden) {
+        return;
+    }
+    if (!display.enabled) {
+        draw_grid(game, game->grid);
+        return;
+    }
+    int lastRow = display.lastRow;
+    int lastColumn = display.lastColumn;
+
+    display.lastRow = move[0];
+    display.lastColumn = move[1];
+
+    // the cursor goes back to the messages below the board afterwards
+    printf("\0337");
+    if (follow_move(move)) {
+        draw_view(game);
+
+    } else {
+        if (lastRow != -1) {
+            draw_cell(game, lastRow, lastColumn);
+        }
+        draw_cell(game, move[0], move[1]);
+    }
+    printf("\0338");
+    fflush(stdout);
+}
+
+/* lets the whole terminal scroll again, and leaves the cursor on its last
+ * line
+ *
+ */
+void restore_terminal(void) {
+
+    printf("\033[r\033[%d;1H", display.rows);
+    fflush(stdout);
+}
+
+/* draws every cell in the view (helper method to show_grid and show_move)
+ *
+ * game: stores information on the current game
+ *
+ */
+void draw_view(struct Game* game) {
+
+    // a single row of the widest view, with its spacing
+    char line[display.viewHeight + 2 * display.viewWidth];
+    int i;
+    int j;
+
+    for (i = display.top; i < display.top + display.viewHeight; i++) {
+        // the view is indented as a whole board would be (a board one
+        // column wide is drawn without any)
+        int length = (display.width == 1) ? 0 :
+                display.top + display.viewHeight - i - 1;
+        memset(line, ' ', length);
+
+        for (j = display.left; j < display.left + display.viewWidth; j++) {
+            line[length++] = game->grid[i][j];
+            line[length++] = ' ';
+        }
+        printf("\033[%d;1H\033[2K", i - display.top + 1);
+        fwrite(line, sizeof(char), length - 1, stdout);
+    }
+    if (display.lastRow != -1) {
+        draw_cell(game, display.lastRow, display.lastColumn);
+    }
+}
+
+/* draws a single cell, if it is in the view (helper method to show_move)
+ *
+ * game: stores information on the current game
+ * row, column: the position of the cell
+ *
+ */
+void draw_cell(struct Game* game, int row, int column) {
+
+    if (row < display.top || row >= display.top + display.viewHeight ||
+            column < display.left ||
+            column >= display.left + display.viewWidth) {
+        return;
+    }
+    int indent = (display.width == 1) ? 0 :
+            display.top + display.viewHeight - row - 1;
+
+    printf("\033[%d;%dH", row - display.top + 1,
+            indent + 2 * (column - display.left) + 1);
+    if (row == display.lastRow && column == display.lastColumn) {
+        printf("\033[7m%c\033[0m", game->grid[row][column]);
+    } else {
+        putchar(game->grid[row][column]);
+    }
+}
+
+/* moves the view so that it is centred on a move outside it (helper method
+ * to show_move)
+ *
+ * move: the position of the move
+ *
+ * returns: 1 if the view was moved, 0 if the move was already in it
+ *
+ */
+int follow_move(int* move) {
+
+    int top = display.top;
+    int left = display.left;
+
+    if (move[0] < top || move[0] >= top + display.viewHeight) {
+        top = view_start(move[0], display.height, display.viewHeight);
+    }
+    if (move[1] < left || move[1] >= left + display.viewWidth) {
+        left = view_start(move[1], display.width, display.viewWidth);
+    }
+    if (top == display.top && left == display.left) {
+        return 0;
+    }
+    display.top = top;
+    display.left = left;
+    return 1;
+}
+
+/* gets the start of a view along one side of the board which is centred on
+ * a position, without going past either end of the board (helper method to
+ * follow_move)
+ *
+ * position: the row or column to centre the view on
+ * boardLength: the height or width of the board
+ * viewLength: the height or width of the view
+ *
+ * returns: the first row or column of the view
+ *
+ */
+int view_start(int position, int boardLength, int viewLength) {
+
+    int start = position - viewLength / 2;
+
+    if (start > boardLength - viewLength) {
+        start = boardLength - viewLength;
+    }
+    if (start < 0) {
+        start = 0;
+    }
+    return start;
+}
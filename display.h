@@ -0,0 +1,60 @@
+/*
+ * display.h
+ *
+ * structs and function prototypes for display.c
+ *
+ */
+
+#ifndef DISPLAY_H_
+#define DISPLAY_H_
+
+#include "structs.h"
+
+/* the terminal size used when it cannot be found */
+#define DEFAULT_TERMINAL_ROWS 24
+#define DEFAULT_TERMINAL_COLUMNS 80
+
+/* the fewest lines kept below the board for moves, prompts and messages
+ * (which scroll there without moving the board) */
+#define STATUS_LINES 3
+
+/* Represents the board as it is shown on an ANSI terminal (--display=ansi)
+ *
+ * only the part of the board from row top and column left which fits on
+ * the terminal is shown (viewHeight rows of viewWidth cells), with each
+ * row indented as if the view were a whole board; the last move is shown
+ * in reverse video */
+struct Display {
+    int enabled;
+    int hidden;
+    int rows;
+    int columns;
+    int height;
+    int width;
+    int viewHeight;
+    int viewWidth;
+    int top;
+    int left;
+    int lastRow;
+    int lastColumn;
+};
+
+void init_display(struct Game* game);
+
+void hide_display(void);
+
+void show_grid(struct Game* game);
+
+void show_move(struct Game* game, int* move);
+
+void restore_terminal(void);
+
+void draw_view(struct Game* game);
+
+void draw_cell(struct Game* game, int row, int column);
+
+int follow_move(int* move);
+
+int view_start(int position, int boardLength, int viewLength);
+
+#endif /* DISPLAY_H_ */
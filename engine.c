@@ -0,0 +1,976 @@
+/*
+ * engine.c
+ *
+ * a search based player for a game of hex, which runs monte carlo tree
+ * search within a time budget and always has a best move ready
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "engine.h"
+#include "gameIO.h"
+#include "stats.h"
+#include "trace.h"
+#include "components.h"
+#include "solve.h"
+#include "solvedb.h"
+#include "kernels.h"
+#include "patterns.h"
+
+#define UCT_CONSTANT 0.7
+#define STABLE_RATIO 1.5
+#define TRACE_BATCH 256
+
+/* the offsets of the neighbours of a cell, in the same order as
+ * get_neighbours */
+static const int rowOffsets[6] = {-1, 0, 1, 1, 0, -1};
+static const int columnOffsets[6] = {0, 1, 1, 0, -1, -1};
+
+/* initialises an engine player, without allocating any of its search state
+ * (which is allocated once the board dimensions are known)
+ *
+ * engine: the engine to be initialised
+ * clock: the time limits for the engine, or NULL to use the default limits
+ * maxPlayouts: the maximum number of playouts per move, or 0 for no limit
+ *
+ */
+void init_engine(struct Engine* engine, struct TimeControl* clock,
+        int maxPlayouts) {
+
+    memset(engine, 0, sizeof(struct Engine));
+
+    if (clock != NULL) {
+        engine->clock = *clock;
+    }
+    engine->maxPlayouts = maxPlayouts;
+
+    // only use the default move time if there are no other limits
+    if (engine->clock.moveTime == 0 && engine->clock.remaining == 0 &&
+            maxPlayouts == 0) {
+        engine->clock.moveTime = DEFAULT_MOVE_TIME;
+    }
+    engine->random = 0x9e3779b97f4a7c15ULL;
+    engine->maxNodes = MAX_NODES;
+}
+
+/* frees all memory allocated to an engine's search state
+ *
+ * engine: the engine to be freed
+ *
+ */
+void free_engine(struct Engine* engine) {
+
+    free(engine->cells);
+    free(engine->scratch);
+    free(engine->empty);
+    free(engine->order);
+    free(engine->path);
+    free(engine->nodes);
+    free(engine->neighbours);
+    free(engine->codes);
+    free(engine->rootCodes);
+
+    engine->cells = NULL;
+    engine->scratch = NULL;
+    engine->empty = NULL;
+    engine->order = NULL;
+    engine->path = NULL;
+    engine->nodes = NULL;
+    engine->neighbours = NULL;
+    engine->codes = NULL;
+    engine->rootCodes = NULL;
+    engine->size = 0;
+}
+
+/* reads a total game time option with an optional increment per move
+ * ("60000" or "60000+1000")
+ *
+ * option: the value of the time control option
+ * clock: stores the time limits which were read
+ *
+ * returns: SUCCESS if option is a valid time control, ERROR otherwise
+ *
+ */
+int parse_time_control(char* option, struct TimeControl* clock) {
+
+    char* end;
+    long total = strtol(option, &end, 10);
+    long increment = 0;
+
+    if (end == option || total <= 0) {
+        return ERROR;
+    }
+    if (*end == '+') {
+        char* incrementString = end + 1;
+        increment = strtol(incrementString, &end, 10);
+
+        if (end == incrementString || increment < 0) {
+            return ERROR;
+        }
+    }
+    if (*end != '\0') {
+        return ERROR;
+    }
+    clock->moveTime = 0;
+    clock->remaining = total;
+    clock->increment = increment;
+    return SUCCESS;
+}
+
+/* searches the current position for the best move for player, stopping
+ * once the engine's time budget has run out (or at once, with the winning
+ * move, if the position is in the database of solved positions)
+ *
+ * engine: the engine making the move
+ * game: stores information on the current game
+ * player: the player who is to move
+ * move: stores the position of the best move found
+ *
+ */
+void engine_search(struct Engine* engine, struct Game* game,
+        struct Player* player, int* move) {
+
+    long start = current_time();
+    long soft;
+    long hard;
+
+    set_position(engine, game, player);
+
+    // a position known to be won needs no search
+    if (db_lookup(game, game->grid, move) == SOLVE_WON) {
+        return;
+    }
+    move_budget(engine, &soft, &hard);
+
+    int timed = (engine->clock.moveTime > 0 || engine->clock.remaining > 0);
+
+    // the best move is available at every point in the search, so it can
+    // always be stopped once the budget runs out
+    while (1) {
+        if (engine->maxPlayouts > 0 &&
+                engine->playouts >= engine->maxPlayouts) {
+            break;
+        }
+        if (timed) {
+            long elapsed = current_time() - start;
+
+            // after the soft deadline, only keep going while the best move
+            // is still changing
+            if (elapsed >= hard || (elapsed >= soft && is_stable(engine))) {
+                break;
+            }
+        }
+        run_playout(engine);
+    }
+
+    int cell = best_cell(engine);
+    move[0] = cell / engine->width;
+    move[1] = cell % engine->width;
+
+    // updates the game clock with the time used for this move
+    if (engine->clock.remaining > 0) {
+        engine->clock.remaining -= current_time() - start;
+        engine->clock.remaining += engine->clock.increment;
+        if (engine->clock.remaining < 1) {
+            engine->clock.remaining = 1;
+        }
+    }
+}
+
+/* copies the current position into the engine, keeping the part of the
+ * search tree which still applies if the position follows on from the last
+ * one searched, and otherwise clearing the tree
+ * (the search state is (re)allocated if the board dimensions have changed)
+ *
+ * engine: the engine to be updated
+ * game: stores information on the current game
+ * player: the player who is to move
+ *
+ */
+void set_position(struct Engine* engine, struct Game* game,
+        struct Player* player) {
+
+    int i;
+
+    if (engine->height == game->height && engine->width == game->width &&
+            engine->cells != NULL && reuse_tree(engine, game, player)) {
+        engine->playouts = 0;
+        if (engine->patterns) {
+            pattern_codes(engine, engine->cells, engine->rootCodes);
+        }
+        return;
+    }
+
+    if (engine->height != game->height || engine->width != game->width ||
+            engine->cells == NULL) {
+
+        free_engine(engine);
+        engine->height = game->height;
+        engine->width = game->width;
+        engine->size = game->size;
+
+        engine->cells = malloc(sizeof(char) * engine->size);
+        engine->scratch = malloc(sizeof(char) * engine->size);
+        engine->empty = malloc(sizeof(int) * engine->size);
+        engine->order = malloc(sizeof(int) * engine->size);
+        engine->path = malloc(sizeof(int) * (engine->size + 2));
+        engine->nodes = malloc(sizeof(struct Node) * engine->maxNodes);
+
+        if (engine->cells == NULL || engine->scratch == NULL ||
+                engine->empty == NULL || engine->order == NULL ||
+                engine->path == NULL || engine->nodes == NULL) {
+            exit_with_error("Engine out of memory", 7);
+        }
+        order_cells(engine);
+        select_fill_board(engine);
+        if (engine->patterns) {
+            init_patterns(engine);
+        }
+    }
+
+    for (i = 0; i < game->height; i++) {
+        memcpy(&engine->cells[i * engine->width], game->grid[i],
+                sizeof(char) * engine->width);
+    }
+    if (engine->patterns) {
+        pattern_codes(engine, engine->cells, engine->rootCodes);
+    }
+    engine->toMove = player->playerSymbol;
+
+    // the root of the search tree represents the current position
+    engine->nodes[0].cell = ERROR;
+    engine->nodes[0].visits = 0;
+    engine->nodes[0].wins = 0;
+    engine->nodes[0].firstChild = 0;
+    engine->nodes[0].numChildren = 0;
+    engine->numNodes = 1;
+    engine->root = 0;
+    engine->playouts = 0;
+}
+
+/* moves the root of the search tree down to the given position, if it can
+ * be reached from the current root by the moves in the tree (this is at
+ * most two moves: the engine's own move and the reply to it, or just the
+ * reply if the engine was pondering)
+ *
+ * engine: the engine whose tree is being reused
+ * game: stores information on the current game
+ * player: the player who is to move
+ *
+ * returns: 1 if the tree was reused, 0 if it has to be cleared
+ *
+ */
+int reuse_tree(struct Engine* engine, struct Game* game,
+        struct Player* player) {
+
+    int moves[2];
+    int numMoves = 0;
+    int row;
+    int column;
+    int i;
+
+    // finds the stones which have been added since the last search
+    for (row = 0; row < engine->height; row++) {
+        char* cells = &engine->cells[row * engine->width];
+
+        for (column = 0; column < engine->width; column++) {
+            if (game->grid[row][column] == cells[column]) {
+                continue;
+            }
+            if (cells[column] != '.' || numMoves == 2) {
+                return 0;
+            }
+            moves[numMoves++] = row * engine->width + column;
+        }
+    }
+
+    // the added stones must alternate, starting with the player who was to
+    // move at the root
+    char mover = engine->toMove;
+    for (i = 0; i < numMoves; i++) {
+        mover = other_symbol(mover);
+    }
+    if (mover != player->playerSymbol) {
+        return 0;
+    }
+    if (numMoves == 2 && game->grid[moves[0] / engine->width]
+            [moves[0] % engine->width] != engine->toMove) {
+
+        int swap = moves[0];
+        moves[0] = moves[1];
+        moves[1] = swap;
+    }
+
+    // follows the added stones down the tree
+    int node = engine->root;
+    for (i = 0; i < numMoves; i++) {
+        node = find_child(engine, node, moves[i]);
+        if (node == ERROR) {
+            return 0;
+        }
+    }
+    for (i = 0; i < numMoves; i++) {
+        engine->cells[moves[i]] = game->grid[moves[i] / engine->width]
+                [moves[i] % engine->width];
+    }
+    engine->toMove = player->playerSymbol;
+    if (node != engine->root) {
+        compact_tree(engine, node);
+    }
+    return 1;
+}
+
+/* moves the part of the tree below a new root to the start of the node
+ * pool, freeing the space used by the rest of the old tree
+ * (helper method to reuse_tree)
+ *
+ * engine: the engine whose tree is being compacted
+ * root: the node which becomes the new root of the tree
+ *
+ */
+void compact_tree(struct Engine* engine, int root) {
+
+    struct Node* kept = malloc(sizeof(struct Node) * engine->numNodes);
+    if (kept == NULL) {
+        exit_with_error("Engine out of memory", 7);
+    }
+    int numKept = 1;
+    int i;
+    int j;
+
+    // copies the tree in breadth first order, so that the children of each
+    // node are still stored next to each other
+    kept[0] = engine->nodes[root];
+    for (i = 0; i < numKept; i++) {
+        int first = kept[i].firstChild;
+
+        kept[i].firstChild = numKept;
+        for (j = 0; j < kept[i].numChildren; j++) {
+            kept[numKept++] = engine->nodes[first + j];
+        }
+    }
+    memcpy(engine->nodes, kept, sizeof(struct Node) * numKept);
+    free(kept);
+
+    engine->numNodes = numKept;
+    engine->root = 0;
+}
+
+/* finds the child of a node which represents the move at the given cell
+ * (helper method to reuse_tree)
+ *
+ * engine: the engine running the search
+ * node: the node whose children are being searched
+ * cell: the cell of the move being looked for
+ *
+ * returns: the index of the child, or ERROR if there is no such child
+ *
+ */
+int find_child(struct Engine* engine, int node, int cell) {
+
+    struct Node* parent = &engine->nodes[node];
+    int i;
+
+    for (i = 0; i < parent->numChildren; i++) {
+        if (engine->nodes[parent->firstChild + i].cell == cell) {
+            return parent->firstChild + i;
+        }
+    }
+    return ERROR;
+}
+
+/* starts searching in a background thread while the opponent of an engine
+ * is deciding on their move, so that the part of the tree below the move
+ * they choose can be reused on the engine's next turn
+ *
+ * engine: the engine which is pondering
+ * game: stores information on the current game
+ * opponent: the player who is to move (the opponent of the engine)
+ *
+ */
+void ponder_start(struct Engine* engine, struct Game* game,
+        struct Player* opponent) {
+
+    set_position(engine, game, opponent);
+
+    __atomic_store_n(&engine->stop, 0, __ATOMIC_SEQ_CST);
+    if (pthread_create(&engine->ponderThread, NULL, ponder, engine) == 0) {
+        engine->pondering = 1;
+    }
+}
+
+/* stops the background search started by ponder_start, and waits for it to
+ * finish
+ *
+ * engine: the engine which is pondering
+ *
+ */
+void ponder_stop(struct Engine* engine) {
+
+    if (engine->pondering == 0) {
+        return;
+    }
+    __atomic_store_n(&engine->stop, 1, __ATOMIC_SEQ_CST);
+    pthread_join(engine->ponderThread, NULL);
+    engine->pondering = 0;
+}
+
+/* runs playouts until told to stop (the body of the pondering thread)
+ *
+ * arg: the engine which is pondering
+ *
+ * returns: NULL
+ *
+ */
+void* ponder(void* arg) {
+
+    struct Engine* engine = arg;
+    long long start = stats_start();
+    long long batchStart = start;
+    long batch = 0;
+
+    trace_thread_name("ponder");
+
+    // the visit counts are ints, so a long wait must not overflow them
+    while (__atomic_load_n(&engine->stop, __ATOMIC_SEQ_CST) == 0 &&
+            engine->nodes[engine->root].visits < MAX_PONDER_VISITS) {
+        run_playout(engine);
+
+        // playouts are traced in batches, so the trace stays small
+        if (++batch == TRACE_BATCH) {
+            trace_end("playouts", batchStart);
+            batchStart = stats_start();
+            batch = 0;
+        }
+    }
+    trace_end("ponder", start);
+    trace_thread_exit();
+    return NULL;
+}
+
+/* sorts every cell of the board by its distance from the centre, which is
+ * the order moves are tried in (so the fallback move before any playouts is
+ * the most central free cell)
+ *
+ * engine: the engine whose cells are being ordered
+ *
+ */
+void order_cells(struct Engine* engine) {
+
+    long long* keys = malloc(sizeof(long long) * engine->size);
+    int i;
+
+    for (i = 0; i < engine->size; i++) {
+        // distances are measured in doubled coordinates, so that the centre
+        // of an even sized board is still a whole number
+        int rowDistance = 2 * (i / engine->width) - (engine->height - 1);
+        int columnDistance = 2 * (i % engine->width) - (engine->width - 1);
+        int distance;
+
+        if ((rowDistance < 0) == (columnDistance < 0)) {
+            distance = abs(rowDistance) > abs(columnDistance) ?
+                    abs(rowDistance) : abs(columnDistance);
+        } else {
+            distance = abs(rowDistance) + abs(columnDistance);
+        }
+        keys[i] = (long long)distance * engine->size + i;
+    }
+    // each key holds the distance then the cell, so sorting the keys sorts
+    // the cells by distance (with ties kept in row order)
+    qsort(keys, engine->size, sizeof(long long), compare_keys);
+
+    for (i = 0; i < engine->size; i++) {
+        engine->order[i] = (int)(keys[i] % engine->size);
+    }
+    free(keys);
+}
+
+/* compares two sort keys (helper method to order_cells)
+ *
+ * first, second: pointers to the keys being compared
+ *
+ * returns: a negative number, zero or a positive number if first is less
+ *          than, equal to or greater than second
+ *
+ */
+int compare_keys(const void* first, const void* second) {
+
+    long long a = *(const long long*)first;
+    long long b = *(const long long*)second;
+
+    return (a > b) - (a < b);
+}
+
+/* works out how long the engine should search for the current move
+ *
+ * engine: the engine making the move
+ * soft: stores the time after which the search stops once the best move is
+ *       stable (ms)
+ * hard: stores the time after which the search always stops (ms)
+ *
+ */
+void move_budget(struct Engine* engine, long* soft, long* hard) {
+
+    struct TimeControl* clock = &engine->clock;
+
+    if (clock->moveTime > 0) {
+        // fixed time per move
+        *hard = clock->moveTime - TIME_MARGIN;
+        if (*hard < clock->moveTime / 2) {
+            *hard = clock->moveTime / 2;
+        }
+        *soft = *hard * 3 / 4;
+        return;
+    }
+
+    // total game time, shared out over the moves which are likely to be
+    // left (each player makes about half of the remaining moves)
+    int i;
+    int numEmpty = 0;
+    for (i = 0; i < engine->size; i++) {
+        if (engine->cells[i] == '.') {
+            numEmpty++;
+        }
+    }
+    long movesLeft = numEmpty / 2 + 1;
+    if (movesLeft > 40) {
+        movesLeft = 40;
+    }
+    *soft = clock->remaining / movesLeft + clock->increment * 3 / 4;
+    *hard = *soft * 4;
+
+    // never spend more than a third of the remaining time on one move
+    long limit = (clock->remaining + clock->increment) / 3 - TIME_MARGIN;
+    if (*hard > limit) {
+        *hard = limit;
+    }
+    if (*soft > *hard) {
+        *soft = *hard;
+    }
+}
+
+/* checks if the best move at the root of the search is unlikely to change
+ *
+ * engine: the engine being checked
+ *
+ * returns: 1 if the most visited move is well clear of the next best move,
+ *          0 otherwise
+ *
+ */
+int is_stable(struct Engine* engine) {
+
+    struct Node* root = &engine->nodes[engine->root];
+    int first = 0;
+    int second = 0;
+    int i;
+
+    for (i = 0; i < root->numChildren; i++) {
+        int visits = engine->nodes[root->firstChild + i].visits;
+
+        if (visits > first) {
+            second = first;
+            first = visits;
+        } else if (visits > second) {
+            second = visits;
+        }
+    }
+    return first > 0 && first >= second * STABLE_RATIO;
+}
+
+/* runs one iteration of the search, which descends the tree, expands a new
+ * position, plays it out to the end of the game at random, and records the
+ * result along the path that was taken
+ *
+ * engine: the engine running the search
+ *
+ */
+void run_playout(struct Engine* engine) {
+
+    char* cells = engine->scratch;
+    char mover = engine->toMove;
+    int node = engine->root;
+    int pathLength = 0;
+    int i;
+
+    memcpy(cells, engine->cells, sizeof(char) * engine->size);
+    engine->path[pathLength++] = node;
+
+    // descends the tree to a leaf, playing each move onto the scratch board
+    while (engine->nodes[node].numChildren > 0) {
+        node = select_child(engine, node);
+        cells[engine->nodes[node].cell] = mover;
+        mover = other_symbol(mover);
+        engine->path[pathLength++] = node;
+    }
+
+    // grows the tree by one position once a leaf has been visited before
+    if (engine->nodes[node].visits > 0 && expand_node(engine, node, cells)) {
+        node = select_child(engine, node);
+        cells[engine->nodes[node].cell] = mover;
+        mover = other_symbol(mover);
+        engine->path[pathLength++] = node;
+    }
+
+    // (the playout policy may answer the last move of the tree)
+    engine->lastCell = engine->nodes[node].cell;
+    char winner = engine->fill(engine, cells, mover);
+
+    // each node records wins for the player who moved into it (the player
+    // moving into the root is the opponent of the player to move)
+    char moved = other_symbol(engine->toMove);
+    for (i = 0; i < pathLength; i++) {
+        struct Node* current = &engine->nodes[engine->path[i]];
+
+        current->visits++;
+        if (moved == winner) {
+            current->wins++;
+        }
+        moved = other_symbol(moved);
+    }
+    engine->playouts++;
+}
+
+/* selects the child of a node to descend into, balancing the moves which
+ * have won most often against those which have rarely been tried
+ *
+ * engine: the engine running the search
+ * node: the node whose children are being selected from
+ *
+ * returns: the index of the selected child
+ *
+ */
+int select_child(struct Engine* engine, int node) {
+
+    struct Node* parent = &engine->nodes[node];
+    double logVisits = log(parent->visits + 1);
+    double bestValue = -1.0;
+    int best = parent->firstChild;
+    int i;
+
+    for (i = 0; i < parent->numChildren; i++) {
+        struct Node* child = &engine->nodes[parent->firstChild + i];
+
+        // untried moves are always selected first (in order of distance
+        // from the centre)
+        if (child->visits == 0) {
+            return parent->firstChild + i;
+        }
+        double value = (double)child->wins / child->visits +
+                UCT_CONSTANT * sqrt(logVisits / child->visits);
+
+        if (value > bestValue) {
+            bestValue = value;
+            best = parent->firstChild + i;
+        }
+    }
+    return best;
+}
+
+/* adds a child to a node for every free cell on the board
+ *
+ * engine: the engine running the search
+ * node: the node to be expanded
+ * cells: the board at the position represented by node
+ *
+ * returns: 1 if the node was expanded, 0 if there was no free cell or not
+ *          enough space left in the tree
+ *
+ */
+int expand_node(struct Engine* engine, int node, char* cells) {
+
+    int numEmpty = 0;
+    int i;
+
+    for (i = 0; i < engine->size; i++) {
+        if (cells[i] == '.') {
+            numEmpty++;
+        }
+    }
+    if (numEmpty == 0 || engine->numNodes + numEmpty > engine->maxNodes) {
+        return 0;
+    }
+
+    int first = engine->numNodes;
+    int index = first;
+
+    for (i = 0; i < engine->size; i++) {
+        int cell = engine->order[i];
+
+        if (cells[cell] == '.') {
+            engine->nodes[index].cell = cell;
+            engine->nodes[index].visits = 0;
+            engine->nodes[index].wins = 0;
+            engine->nodes[index].firstChild = 0;
+            engine->nodes[index].numChildren = 0;
+            index++;
+        }
+    }
+    engine->nodes[node].firstChild = first;
+    engine->nodes[node].numChildren = numEmpty;
+    engine->numNodes += numEmpty;
+    return 1;
+}
+
+/* the body of full_board_winner, shared with the specialised copies of
+ * fill_board
+ *
+ * cells: the board to be checked, stored one row after another
+ * height, width: the dimensions of the board (constants in the copies)
+ * stack: space for height * width cells still waiting to be visited
+ *
+ * returns: 'O' if O has won, 'X' otherwise
+ *
+ */
+KERNEL char winner_kernel(char* cells, const int height, const int width,
+        int* stack) {
+
+    int numElements = 0;
+    int i;
+
+    for (i = 0; i < height; i++) {
+        if (cells[i * width] == 'O') {
+            cells[i * width] = 'o';
+            stack[numElements++] = i * width;
+        }
+    }
+    while (numElements > 0) {
+        int cell = stack[--numElements];
+        int row = cell / width;
+        int column = cell % width;
+
+        if (column == width - 1) {
+            return 'O';
+        }
+        for (i = 0; i < 6; i++) {
+            int nextRow = row + rowOffsets[i];
+            int nextColumn = column + columnOffsets[i];
+
+            if (nextRow < 0 || nextRow >= height || nextColumn < 0 ||
+                    nextColumn >= width) {
+                continue;
+            }
+            int next = nextRow * width + nextColumn;
+            if (cells[next] == 'O') {
+                cells[next] = 'o';
+                stack[numElements++] = next;
+            }
+        }
+    }
+    return 'X';
+}
+
+/* the body of fill_board and its specialised copies
+ *
+ * engine: the engine running the search
+ * cells: the board to be filled
+ * toMove: the symbol of the player who fills the first free cell
+ * height, width: the dimensions of the board (constants in the copies)
+ *
+ * returns: the symbol of the winning player
+ *
+ */
+KERNEL char fill_kernel(struct Engine* engine, char* cells, char toMove,
+        const int height, const int width) {
+
+    int numEmpty = 0;
+    int i;
+
+    for (i = 0; i < height * width; i++) {
+        if (cells[i] == '.') {
+            engine->empty[numEmpty++] = i;
+        }
+    }
+    // shuffles the free cells, then hands them out alternately
+    for (i = numEmpty - 1; i > 0; i--) {
+        int j = next_random(engine) % (i + 1);
+        int swap = engine->empty[i];
+
+        engine->empty[i] = engine->empty[j];
+        engine->empty[j] = swap;
+    }
+    for (i = 0; i < numEmpty; i++) {
+        cells[engine->empty[i]] = toMove;
+        toMove = other_symbol(toMove);
+    }
+    // (never true for the specialised sizes, so only the generic copy
+    // checks it)
+    if (height * width >= PARALLEL_MIN_CELLS) {
+        return parallel_winner(cells, height, width);
+    }
+    return winner_kernel(cells, height, width, engine->empty);
+}
+
+/* fills every free cell of the board at random, alternating between the
+ * players, and finds the winner of the filled board (a filled hex board
+ * always has exactly one winner, and any path which existed before the
+ * fill is still there afterwards)
+ *
+ * engine: the engine running the search
+ * cells: the board to be filled
+ * toMove: the symbol of the player who fills the first free cell
+ *
+ * returns: the symbol of the winning player
+ *
+ */
+char fill_board(struct Engine* engine, char* cells, char toMove) {
+
+    return fill_kernel(engine, cells, toMove, engine->height, engine->width);
+}
+
+/* defines fill_board_<size>, the copy of fill_board for square boards of
+ * one size */
+#define DEFINE_FILL_BOARD(size) \
+    char fill_board_##size(struct Engine* engine, char* cells, \
+            char toMove) { \
+        return fill_kernel(engine, cells, toMove, size, size); \
+    }
+
+SPECIALISED_SIZES(DEFINE_FILL_BOARD)
+
+/* chooses the version of fill_board for an engine's board: pattern_fill
+ * for an engine which plays out with patterns, otherwise the copy
+ * specialised for its size, or the generic fill_board if there is none
+ *
+ * engine: the engine whose board dimensions have just been set
+ *
+ */
+void select_fill_board(struct Engine* engine) {
+
+#define FILL_BOARD_CASE(size) \
+    case size: \
+        engine->fill = fill_board_##size; \
+        return;
+
+    engine->fill = fill_board;
+    if (engine->patterns) {
+        engine->fill = pattern_fill;
+        return;
+    }
+    if (engine->height == engine->width) {
+        switch (engine->height) {
+            SPECIALISED_SIZES(FILL_BOARD_CASE)
+        }
+    }
+}
+
+/* finds the winner of a completely filled board, by searching for a path of
+ * Os from the left edge to the right edge (if there is none, then X must
+ * have connected the top and bottom edges)
+ * the Os which are reached are overwritten with 'o' to mark them as visited
+ * (unless the board is large enough to be labelled on every core instead,
+ * which leaves it unchanged)
+ *
+ * cells: the board to be checked, stored one row after another
+ * height: the number of rows on the board
+ * width: the number of columns on the board
+ * stack: space for height * width cells still waiting to be visited
+ *
+ * returns: 'O' if O has won, 'X' otherwise
+ *
+ */
+char full_board_winner(char* cells, int height, int width, int* stack) {
+
+    if (height * width >= PARALLEL_MIN_CELLS) {
+        return parallel_winner(cells, height, width);
+    }
+    return winner_kernel(cells, height, width, stack);
+}
+
+/* finds the most visited move at the root of the search tree
+ *
+ * engine: the engine running the search
+ *
+ * returns: the index of the most visited child of the root, or ERROR if the
+ *          root has not been expanded yet
+ *
+ */
+int best_child(struct Engine* engine) {
+
+    struct Node* root = &engine->nodes[engine->root];
+    int best = ERROR;
+    int bestVisits = -1;
+    int i;
+
+    for (i = 0; i < root->numChildren; i++) {
+        if (engine->nodes[root->firstChild + i].visits > bestVisits) {
+            bestVisits = engine->nodes[root->firstChild + i].visits;
+            best = root->firstChild + i;
+        }
+    }
+    return best;
+}
+
+/* gets the cell of the best move found so far, falling back to the most
+ * central free cell if the search has not started yet
+ *
+ * engine: the engine running the search
+ *
+ * returns: the index of the cell (row * width + column)
+ *
+ */
+int best_cell(struct Engine* engine) {
+
+    int best = best_child(engine);
+    int i;
+
+    if (best != ERROR) {
+        return engine->nodes[best].cell;
+    }
+    for (i = 0; i < engine->size; i++) {
+        if (engine->cells[engine->order[i]] == '.') {
+            return engine->order[i];
+        }
+    }
+    return 0;
+}
+
+/* generates the next number from the engine's random number generator
+ * (xorshift64*)
+ *
+ * engine: the engine which owns the generator
+ *
+ * returns: a pseudo-random number
+ *
+ */
+unsigned int next_random(struct Engine* engine) {
+
+    engine->random ^= engine->random >> 12;
+    engine->random ^= engine->random << 25;
+    engine->random ^= engine->random >> 27;
+
+    return (unsigned int)((engine->random * 2685821657736338717ULL) >> 32);
+}
+
+/* gets the current time from a monotonic clock
+ *
+ * returns: the current time in ms
+ *
+ */
+long current_time(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000L + now.tv_nsec / 1000000L;
+}
+
+/* gets the symbol of the opponent of a player
+ *
+ * symbol: the symbol of the player ('O' or 'X')
+ *
+ * returns: 'X' for 'O', and 'O' for 'X'
+ *
+ */
+char other_symbol(char symbol) {
+
+    if (symbol == 'O') {
+        return 'X';
+    }
+    return 'O';
+}
@@ -0,0 +1,134 @@
+/*
+ * engine.h
+ *
+ * structs and function prototypes for engine.c
+ *
+ */
+
+#ifndef ENGINE_H_
+#define ENGINE_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+#include "kernels.h"
+
+/* the move time used when no other limit is given to an engine (ms) */
+#define DEFAULT_MOVE_TIME 1000
+
+/* time kept in reserve so that a move is returned before the hard deadline
+ * runs out (ms) */
+#define TIME_MARGIN 20
+
+#define MAX_NODES (1 << 20)
+
+/* pondering stops once the root has this many visits */
+#define MAX_PONDER_VISITS (1 << 30)
+
+/* Represents a single position in an engine's search tree */
+struct Node {
+    int cell;
+    int visits;
+    int wins;
+    int firstChild;
+    int numChildren;
+};
+
+/* Represents a search based player, along with its search tree
+ *
+ * with patterns set, playouts answer threats to bridges (see patterns.c),
+ * using the neighbours of each cell and the neighbourhood code of each cell
+ * at the root (rootCodes) and during a playout (codes) */
+struct Engine {
+    struct TimeControl clock;
+    int maxPlayouts;
+    unsigned long long random;
+    int height;
+    int width;
+    int size;
+    char toMove;
+    char* cells;
+    char* scratch;
+    int* empty;
+    int* order;
+    int* path;
+    struct Node* nodes;
+    char (*fill)(struct Engine* engine, char* cells, char toMove);
+    int patterns;
+    int lastCell;
+    int* neighbours;
+    unsigned short* codes;
+    unsigned short* rootCodes;
+    int numNodes;
+    int maxNodes;
+    int root;
+    long playouts;
+    pthread_t ponderThread;
+    int ponderEnabled;
+    int pondering;
+    int stop;
+};
+
+void init_engine(struct Engine* engine, struct TimeControl* clock,
+        int maxPlayouts);
+
+void free_engine(struct Engine* engine);
+
+int parse_time_control(char* option, struct TimeControl* clock);
+
+void engine_search(struct Engine* engine, struct Game* game,
+        struct Player* player, int* move);
+
+void set_position(struct Engine* engine, struct Game* game,
+        struct Player* player);
+
+int reuse_tree(struct Engine* engine, struct Game* game,
+        struct Player* player);
+
+void compact_tree(struct Engine* engine, int root);
+
+int find_child(struct Engine* engine, int node, int cell);
+
+void ponder_start(struct Engine* engine, struct Game* game,
+        struct Player* opponent);
+
+void ponder_stop(struct Engine* engine);
+
+void* ponder(void* arg);
+
+void order_cells(struct Engine* engine);
+
+int compare_keys(const void* first, const void* second);
+
+void move_budget(struct Engine* engine, long* soft, long* hard);
+
+int is_stable(struct Engine* engine);
+
+void run_playout(struct Engine* engine);
+
+int select_child(struct Engine* engine, int node);
+
+int expand_node(struct Engine* engine, int node, char* cells);
+
+char fill_board(struct Engine* engine, char* cells, char toMove);
+
+#define DECLARE_FILL_BOARD(size) \
+    char fill_board_##size(struct Engine* engine, char* cells, char toMove);
+
+SPECIALISED_SIZES(DECLARE_FILL_BOARD)
+
+void select_fill_board(struct Engine* engine);
+
+char full_board_winner(char* cells, int height, int width, int* stack);
+
+int best_child(struct Engine* engine);
+
+int best_cell(struct Engine* engine);
+
+unsigned int next_random(struct Engine* engine);
+
+long current_time(void);
+
+char other_symbol(char symbol);
+
+#endif /* ENGINE_H_ */
@@ -0,0 +1,308 @@
+/*
+ * fastforward.c
+ *
+ * plays a game between two auto players straight to its end
+ * (--fast-forward), since the moves of auto players are fixed by their
+ * formulas: the moves are placed on a flat copy of the grid, a win is
+ * found by joining groups of stones as they are placed (rather than
+ * checking the grid after every move), and only the final grid is printed
+ *
+ * given a memo file (--fast-forward=file), the number of moves and the
+ * winner of every game played are kept in it, so a game which has been
+ * played before is replayed without looking for a win at all
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fastforward.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "connectivity.h"
+#include "snapshot.h"
+#include "display.h"
+
+/* plays a game between two auto players to its end, then prints the final
+ * grid and the winner
+ *
+ * game: stores information on the current game
+ * memoFile: the memo file, or NULL if there is none
+ *
+ * returns: WIN once the game has been played, or ERROR if a player had
+ *          already won before the first move (in which case the game is
+ *          left as it was)
+ *
+ * error conditions: unable to allocate the grid, or unable to read or
+ *                   write the memo file
+ *
+ */
+int fast_forward(struct Game* game, char* memoFile) {
+
+    struct MemoRecord record;
+    int moveNumbers[2] = {game->player1->moveNumber,
+            game->player2->moveNumber};
+    int toMove = game->player2->hasNextMove;
+    int empty = 0;
+    int found = 0;
+    int i;
+
+    char* cells = malloc(sizeof(char) * game->size);
+    if (cells == NULL) {
+        exit_with_error("Unable to fast forward game", 7);
+    }
+    for (i = 0; i < game->height; i++) {
+        memcpy(&cells[i * game->width], game->grid[i], game->width);
+    }
+    for (i = 0; i < game->size; i++) {
+        empty += (cells[i] == '.');
+    }
+
+    record.key = game_key(game, cells);
+    record.height = game->height;
+    record.width = game->width;
+    if (memoFile != NULL) {
+        found = find_memo(memoFile, &record);
+    }
+
+    if (found) {
+        if (record.numMoves < 1 || record.numMoves > empty ||
+                (record.winner != 0 && record.winner != 1)) {
+            exit_with_error("Incorrect memo file contents", 5);
+        }
+        play_forward(game, cells, moveNumbers, toMove, record.numMoves,
+                &record.winner);
+
+    } else {
+        record.numMoves = play_forward(game, cells, moveNumbers, toMove,
+                ERROR, &record.winner);
+        if (record.numMoves == ERROR) {
+            free(cells);
+            return ERROR;
+        }
+        if (memoFile != NULL) {
+            add_memo(memoFile, &record);
+        }
+    }
+
+    for (i = 0; i < game->height; i++) {
+        own_grid_row(game, i);
+        memcpy(game->grid[i], &cells[i * game->width], game->width);
+    }
+    free(cells);
+    game->player1->moveNumber = moveNumbers[0];
+    game->player2->moveNumber = moveNumbers[1];
+
+    show_grid(game);
+    return end_game(game, (record.winner == 0) ? game->player1 :
+            game->player2);
+}
+
+/* places the moves of the two auto players (helper method to fast_forward)
+ *
+ * game: stores information on the current game
+ * cells: the cells of the grid (row * width + column), with the moves
+ *        added to them
+ * moveNumbers: the move numbers of O and X (updated as they move)
+ * toMove: the player who moves first (0 for O, 1 for X)
+ * numMoves: the number of moves to place, or ERROR to place moves until
+ *           one of them wins the game
+ * winner: stores the winner (0 for O, 1 for X), if numMoves is ERROR
+ *
+ * returns: the number of moves placed, or ERROR if a player had already
+ *          won before the first move
+ *
+ * error conditions: unable to allocate the groups of stones
+ *
+ */
+int play_forward(struct Game* game, char* cells, int* moveNumbers,
+        int toMove, int numMoves, int* winner) {
+
+    struct Connectivity board;
+    int checked = (numMoves == ERROR);
+    int player = toMove;
+    int played = 0;
+    int i;
+
+    // the groups are only needed to find a win, which is already known
+    // for a game which has been played before
+    if (checked) {
+        if (init_connectivity(&board, game->height, game->width) == ERROR) {
+            exit_with_error("Unable to fast forward game", 7);
+        }
+        for (i = 0; i < game->size; i++) {
+            if (cells[i] != '.' && add_stone(&board, i / game->width,
+                    i % game->width, cells[i]) == WIN) {
+                free_connectivity(&board);
+                return ERROR;
+            }
+        }
+    }
+
+    while (checked || played < numMoves) {
+        char symbol = (player == 0) ? 'O' : 'X';
+        int cell;
+
+        // the formula's positions are tried in turn until a free one is
+        // found, as find_auto_move does
+        do {
+            cell = auto_cell(player, moveNumbers[player], game->height,
+                    game->width);
+            moveNumbers[player]++;
+        } while (cells[cell] != '.');
+
+        cells[cell] = symbol;
+        played++;
+        if (checked && add_stone(&board, cell / game->width,
+                cell % game->width, symbol) == WIN) {
+            *winner = player;
+            break;
+        }
+        player = 1 - player;
+    }
+    if (checked) {
+        free_connectivity(&board);
+    }
+    return played;
+}
+
+/* gets the cell which an auto player tries for a given move number, using
+ * the same formulas as find_auto_move
+ *
+ * player: the auto player (0 for O, 1 for X)
+ * moveNumber: the player's move number
+ * height, width: the dimensions of the grid
+ *
+ * returns: the cell (row * width + column)
+ *
+ */
+int auto_cell(int player, int moveNumber, int height, int width) {
+
+    int m = (height > width) ? height : width;
+    int t;
+
+    if (player == 0) {
+        t = ((moveNumber * 9 % 1000037) + 17);
+    } else {
+        t = ((moveNumber * 7 % 1000213) + 81);
+    }
+    return ((t / m) % height) * width + t % width;
+}
+
+/* gets the hash of everything which decides how a game between auto
+ * players goes: the grid, its dimensions, the move numbers and the player
+ * to move
+ *
+ * game: stores information on the current game
+ * cells: the cells of the grid
+ *
+ * returns: the hash
+ *
+ */
+unsigned long long game_key(struct Game* game, char* cells) {
+
+    int numbers[5] = {game->height, game->width, game->player1->moveNumber,
+            game->player2->moveNumber, game->player2->hasNextMove};
+    unsigned long long hash = FNV_OFFSET;
+    unsigned char* bytes = (unsigned char*)numbers;
+    int i;
+
+    for (i = 0; i < (int)sizeof(numbers); i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    for (i = 0; i < game->size; i++) {
+        hash = (hash ^ (unsigned char)cells[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/* looks up a game in the memo file
+ *
+ * memoFile: the memo file
+ * wanted: the key and dimensions of the game, and stores the number of
+ *         moves and winner if it is found
+ *
+ * returns: 1 if the game was found, 0 otherwise (or if there is no memo
+ *          file yet)
+ *
+ * error conditions: invalid file contents
+ *
+ */
+int find_memo(char* memoFile, struct MemoRecord* wanted) {
+
+    struct stat info;
+    int found = 0;
+    long i;
+
+    int fd = open(memoFile, O_RDONLY);
+    if (fd == -1) {
+        return 0;
+    }
+    if (fstat(fd, &info) == -1 || info.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    if (info.st_size < MEMO_MAGIC_LENGTH || (info.st_size -
+            MEMO_MAGIC_LENGTH) % sizeof(struct MemoRecord) != 0) {
+        exit_with_error("Incorrect memo file contents", 5);
+    }
+    char* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED ||
+            memcmp(mapping, MEMO_MAGIC, MEMO_MAGIC_LENGTH) != 0) {
+        exit_with_error("Incorrect memo file contents", 5);
+    }
+
+    // each run looks up a single game, so the records are just scanned
+    struct MemoRecord* records =
+            (struct MemoRecord*)(mapping + MEMO_MAGIC_LENGTH);
+    long numRecords = (info.st_size - MEMO_MAGIC_LENGTH) /
+            sizeof(struct MemoRecord);
+    for (i = 0; i < numRecords; i++) {
+        if (records[i].key == wanted->key &&
+                records[i].height == wanted->height &&
+                records[i].width == wanted->width) {
+            wanted->numMoves = records[i].numMoves;
+            wanted->winner = records[i].winner;
+            found = 1;
+            break;
+        }
+    }
+    munmap(mapping, info.st_size);
+    return found;
+}
+
+/* adds a game to the end of the memo file, creating it if it does not
+ * exist
+ *
+ * memoFile: the memo file
+ * record: the game's key, dimensions, number of moves and winner
+ *
+ * error conditions: unable to write the file
+ *
+ */
+void add_memo(char* memoFile, struct MemoRecord* record) {
+
+    struct stat info;
+
+    int fd = open(memoFile, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        exit_with_error("Could not write memo file", 4);
+    }
+
+    // a new memo file is just its magic number
+    if (info.st_size == 0 && write(fd, MEMO_MAGIC, MEMO_MAGIC_LENGTH) !=
+            MEMO_MAGIC_LENGTH) {
+        exit_with_error("Could not write memo file", 4);
+    }
+    if (write(fd, record, sizeof(struct MemoRecord)) !=
+            sizeof(struct MemoRecord)) {
+        exit_with_error("Could not write memo file", 4);
+    }
+    close(fd);
+}
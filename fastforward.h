@@ -0,0 +1,45 @@
+/*
+ * fastforward.h
+ *
+ * structs and function prototypes for fastforward.c
+ *
+ */
+
+#ifndef FASTFORWARD_H_
+#define FASTFORWARD_H_
+
+#include "structs.h"
+
+/* the first bytes of every memo file */
+#define MEMO_MAGIC "BOBFFWD1"
+#define MEMO_MAGIC_LENGTH 8
+
+/* the starting value and multiplier of the FNV-1a hash of a game */
+#define FNV_OFFSET 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+/* Represents the outcome of one game between auto players: the number of
+ * moves until the game was won, and the winner (0 for O, 1 for X), stored
+ * under the hash of the game's starting position */
+struct MemoRecord {
+    unsigned long long key;
+    int height;
+    int width;
+    int numMoves;
+    int winner;
+};
+
+int fast_forward(struct Game* game, char* memoFile);
+
+int play_forward(struct Game* game, char* cells, int* moveNumbers,
+        int toMove, int numMoves, int* winner);
+
+int auto_cell(int player, int moveNumber, int height, int width);
+
+unsigned long long game_key(struct Game* game, char* cells);
+
+int find_memo(char* memoFile, struct MemoRecord* wanted);
+
+void add_memo(char* memoFile, struct MemoRecord* record);
+
+#endif /* FASTFORWARD_H_ */
@@ -9,11 +9,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
 
 #include "gameIO.h"
+#include "stats.h"
+#include "trace.h"
 
 #define MAX_INPUT 70
 
+/* the most characters in a number on the first line of a saved game */
+#define MAX_INFO_DIGITS 10
+
+/* the commands read from stdin which have not yet been used */
+struct InputBuffer inputBuffer = {NULL, 0, 0, 0, 0, 0};
+
 /* SAVED GAME IO */
 
 /* saves the current game info and grid state to a file address specified in
@@ -67,7 +78,7 @@ int save_game(char* input, int size, char** grid, struct Game* game) {
         }
     }
 
-    fflush(gameFile);
+    fclose(gameFile);
     return SUCCESS;
 }
 
@@ -82,60 +93,143 @@ int save_game(char* input, int size, char** grid, struct Game* game) {
  *
  */
 char** load_file(FILE* gameFile, struct Game* game) {
+
+    char** grid;
+
+    if (read_saved_game(gameFile, game, &grid) == ERROR) {
+        exit_with_error("Incorrect file contents", 5);
+    }
+    return grid;
+}
+
+/* reads the whole of a saved game file into memory, then loads it into
+ * game (without exiting if the file is invalid, unlike load_file)
+ *
+ * gameFile: file which the game information is stored in
+ * game: stores information on the current game
+ * grid: stores the newly loaded game grid (game->grid is left as it was)
+ *
+ * returns: SUCCESS if the game was loaded, ERROR otherwise
+ *
+ */
+int read_saved_game(FILE* gameFile, struct Game* game, char*** grid) {
+
+    long capacity = 4096;
+    long length = 0;
+    char* contents = malloc(capacity);
+
+    while (contents != NULL) {
+        length += fread(&contents[length], 1, capacity - length, gameFile);
+        if (length < capacity) {
+            break;
+        }
+        capacity *= 2;
+        char* larger = realloc(contents, capacity);
+        if (larger == NULL) {
+            free(contents);
+        }
+        contents = larger;
+    }
+    if (contents == NULL) {
+        return ERROR;
+    }
+    int result = parse_saved_game(contents, length, game, grid, NULL);
+    free(contents);
+    return result;
+}
+
+/* loads a saved game from memory into game, allocating its grid
+ *
+ * contents: the contents of a saved game file
+ * length: the number of characters in contents
+ * game: stores information on the current game
+ * loaded: stores the newly loaded game grid (game->grid is left as it was)
+ * errorAt: stores the offset in contents where it stopped being a valid
+ *          saved game, if it is not one (unless NULL)
+ *
+ * returns: SUCCESS if the game was loaded, ERROR if contents is not a valid
+ *          saved game (in which case nothing is left allocated)
+ *
+ */
+int parse_saved_game(char* contents, long length, struct Game* game,
+        char*** loaded, long* errorAt) {
     int infoLength = 5;
-    int next;
     int fileInfo[infoLength];
-    char** grid;
-    char infoEntry[infoLength];
+    char** grid = NULL;
+    char infoEntry[MAX_INFO_DIGITS + 1];
     int digits = 0, commaCounter = 0, lineCounter = 0, indexCounter = 0;
-    while (1) {
-        next = fgetc(gameFile);
-        if (next == EOF) {
-            // incorrect number of grid lines
-            if (lineCounter != (game->height + 1)) {
-                exit_with_error("Incorrect file contents", 5);
-            }
-            return grid;
-        } else if (next == '\n') {
+    long i;
+
+    for (i = 0; i < length; i++) {
+        char next = contents[i];
+
+        if (next == '\n') {
             if (lineCounter == 0) {
                 // file info line is the wrong length
-                if (commaCounter != infoLength - 1) {
-                    exit_with_error("Incorrect file contents", 5);
+                if (commaCounter != infoLength - 1 || record_number(infoEntry,
+                        &digits, fileInfo, commaCounter) == ERROR) {
+                    break;
                 }
-                record_number(infoEntry, &digits, fileInfo, commaCounter);
                 grid = init_saved_game(game, fileInfo);
+                if (grid == NULL) {
+                    break;
+                }
 
             } else if ((lineCounter > 0) && (indexCounter != game->width)) {
                 // grid line too short or too long
-                exit_with_error("Incorrect file contents", 5);
+                break;
             }
             lineCounter++;
             indexCounter = 0;
 
-        } else if (lineCounter == 0 && (char)next == ',') {
-            record_number(infoEntry, &digits, fileInfo, commaCounter);
+        } else if (lineCounter == 0 && next == ',') {
+            if (commaCounter == infoLength - 1 || record_number(infoEntry,
+                    &digits, fileInfo, commaCounter) == ERROR) {
+                break;
+            }
             commaCounter++;
 
-        } else if (lineCounter == 0 && (char)next != ',') {
+        } else if (lineCounter == 0) {
             // adds each digit of a file info number to a string
-            char charNext = (char)next;
-            infoEntry[digits] = charNext;
+            if (digits == MAX_INFO_DIGITS) {
+                break;
+            }
+            infoEntry[digits] = next;
             digits++;
 
-        } else if (lineCounter > 0) {
-            // bad characters in input grid
-            if ((char)next != 'O' && (char)next != 'X' && (char)next != '.') {
-                exit_with_error("Incorrect file contents", 5);
+        } else {
+            // bad characters in input grid, or too many lines or characters
+            if ((next != 'O' && next != 'X' && next != '.') ||
+                    lineCounter > game->height ||
+                    indexCounter >= game->width) {
+                break;
             }
-            grid[lineCounter - 1][indexCounter] = (char)next;
+            grid[lineCounter - 1][indexCounter] = next;
             indexCounter++;
         }
     }
+
+    // incorrect number of grid lines (or the file ended early, possibly
+    // before the file info line was finished)
+    if (i < length || grid == NULL || lineCounter != (game->height + 1)) {
+        if (errorAt != NULL) {
+            *errorAt = i;
+        }
+        if (grid != NULL) {
+            for (i = 0; i < game->height + 1; i++) {
+                free(grid[i]);
+            }
+            free(grid);
+        }
+        return ERROR;
+    }
+    *loaded = grid;
+    return SUCCESS;
 }
 
 /* initialises a new game based on the information in a saved file (stored
  * in fileInfo)
- * helper method to load_file
+ * helper method to parse_saved_game
  *
  * game: will be used to store information about the new game being
  *       initialised
@@ -143,9 +237,8 @@ char** load_file(FILE* gameFile, struct Game* game) {
  *           initialise a new game
  *
  * returns: a new game grid which has been allocated according to the
- *          dimensions given in fileInfo
- *
- * error conditions: incorrect file contents
+ *          dimensions given in fileInfo, or NULL if the information is
+ *          incorrect
  *
  */
 char** init_saved_game(struct Game* game, int* fileInfo) {
@@ -160,15 +253,15 @@ char** init_saved_game(struct Game* game, int* fileInfo) {
         game->player2->hasNextMove = 0;
 
     } else {
-        // if the first number is neither 0 nor 1, exit
-        exit_with_error("Incorrect file contents", 5);
+        // if the first number is neither 0 nor 1, the file is incorrect
+        return NULL;
     }
 
     // check for invalid saved board dimensions
     if (fileInfo[1] < MIN_BOARD_WIDTH || fileInfo[1] > MAX_BOARD_WIDTH ||
             fileInfo[2] < MIN_BOARD_WIDTH || fileInfo[2] > MAX_BOARD_WIDTH) {
 
-        exit_with_error("Incorrect file contents", 5);
+        return NULL;
     }
     // initialising the game struct
     game->height = fileInfo[1];
@@ -187,17 +280,17 @@ char** init_saved_game(struct Game* game, int* fileInfo) {
 }
 
 /* checks if infoEntry is a number, and if it is, adds it to fileInfo
- * (helper method to load_file)
+ * (helper method to parse_saved_game)
  *
  * infoEntry: a string to be checked to see if it is an integer
  * digits: the number of digits in infoEntry
  * fileInfo: holds values required to initialise a game from a saved file
  * commaCounter: counter for the number of entries already in fileInfo
  *
- * error conditions: invalid file contents
+ * returns: SUCCESS if infoEntry is an integer, ERROR otherwise
  *
  */
-void record_number(char* infoEntry, int* digits, int* fileInfo, 
+int record_number(char* infoEntry, int* digits, int* fileInfo, 
         int commaCounter) {
 
     // null terminates the string
@@ -207,11 +300,12 @@ void record_number(char* infoEntry, int* digits, int* fileInfo,
     int integer = check_int(infoEntry);
 
     if (integer == ERROR) {
-        exit_with_error("Incorrect file contents", 5);
+        return ERROR;
     }
 
     fileInfo[commaCounter] = integer;
     *digits = 0;
+    return SUCCESS;
 }
 
 /* checks if a given string is an integer or not
@@ -251,83 +345,152 @@ void exit_with_error(char* message, int exitStatus) {
 
 /* USER INPUT */
 
-/* reads user input to stdin
+/* reads the next command from the user, where commands are separated by
+ * newlines or by ';' (so several moves can be given on one line)
+ *
+ * input is read from file in large blocks, and each command is returned in
+ * place in the buffer rather than being copied
  *
  * file: the file to be read (in this case, stdin)
- * length: stores the length of the file's contents
+ * length: stores the length of the command
  * game: stores information on the current game
  *
- * returns: an array containing the input
+ * returns: the command, which stays valid until the next call (and must not
+ *          be freed)
  *
  * error conditions: EOF from user while waiting for input
  *
  */
 char* read_line(FILE* file, int* length, struct Game* game) {
-    // starting size
-    int size = 10;
-    char* result = malloc(sizeof(char) * size);
-    int position = 0;
-    int next = 0;
+
+    struct InputBuffer* buffer = &inputBuffer;
+
+    // checks that the previous command was not ended with EOF
+    if (game->checkEOF == 1) {
+        exit_with_error("EOF from user", 6);
+    }
 
     while (1) {
-        // checks that the previous move was not ended with EOF
-        if (game->checkEOF == 1) {
-            free(result);
-            exit_with_error("EOF from user", 6);
+        // a newline straight after a ';' does not start another command
+        if (buffer->afterSeparator && buffer->start < buffer->end) {
+            if (buffer->data[buffer->start] == '\n') {
+                buffer->start++;
+                buffer->scan = buffer->start;
+            }
+            buffer->afterSeparator = 0;
         }
 
-        next = fgetc(file);
-        
-        if ((next == EOF && position == 0)) {
-            // EOF as the first character in the file
-            free(result);
-            exit_with_error("EOF from user", 6);
+        // looks for the end of the command in what has been read so far,
+        // carrying on from where the last search stopped
+        while (buffer->scan < buffer->end) {
+            char next = buffer->data[buffer->scan];
+
+            if (next == '\n' || next == ';') {
+                char* command = &buffer->data[buffer->start];
+
+                buffer->data[buffer->scan] = '\0';
+                *length = buffer->scan - buffer->start;
+                buffer->start = buffer->scan + 1;
+                buffer->scan = buffer->start;
+                buffer->afterSeparator = (next == ';');
+                return command;
+            }
+            buffer->scan++;
+        }
 
-        } else if (next == EOF && position > 0) {
+        if (fill_buffer(buffer, file) == 0) {
+            if (buffer->start == buffer->end) {
+                // EOF as the first character of a command
+                exit_with_error("EOF from user", 6);
+            }
             // EOF after other characters have been entered
-            result[position] = '\0';
-            *length = position;
-            game->checkEOF = 1;
-            return result;
+            char* command = &buffer->data[buffer->start];
 
-        } else if (next == '\n') {
-            result[position] = '\0';
-            *length = position;
-            return result;
+            buffer->data[buffer->end] = '\0';
+            *length = buffer->end - buffer->start;
+            buffer->start = buffer->end;
+            buffer->scan = buffer->end;
+            game->checkEOF = 1;
+            return command;
+        }
+    }
+}
 
+/* reads another block of input into the buffer, first moving any partial
+ * command to the front (and making the buffer larger if the command fills
+ * all of it) (helper method to read_line)
+ *
+ * buffer: the buffer to be filled
+ * file: the file to be read
+ *
+ * returns: the number of characters read, or 0 at EOF
+ *
+ */
+int fill_buffer(struct InputBuffer* buffer, FILE* file) {
+
+    if (buffer->start > 0) {
+        memmove(buffer->data, &buffer->data[buffer->start],
+                buffer->end - buffer->start);
+        buffer->end -= buffer->start;
+        buffer->scan -= buffer->start;
+        buffer->start = 0;
+    }
+    // leaves room for the '\0' at the end of the last command
+    if (buffer->end + 1 >= buffer->capacity) {
+        if (buffer->capacity == 0) {
+            buffer->capacity = INPUT_BUFFER_SIZE;
         } else {
-            // resize result according to how much space is needed
-            if (position > size - 5) {
-                size = size * 2;
-                result = realloc(result, (sizeof(char) * size));
+            buffer->capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        if (buffer->data == NULL) {
+            exit_with_error("Unable to read input", 6);
+        }
+    }
 
-            } else if (position < (size * 0.25)) {
-                size = size * 0.5;
-                result = realloc(result, (sizeof(char) * size));
+    while (1) {
+        // reads whatever is available rather than waiting for a full block,
+        // so a player typing moves is not kept waiting
+        ssize_t numRead = read(fileno(file), &buffer->data[buffer->end],
+                buffer->capacity - buffer->end - 1);
 
-            }
-            result[position] = (char)next;
-            position++;
+        if (numRead < 0 && errno == EINTR) {
+            continue;
         }
+        if (numRead <= 0) {
+            return 0;
+        }
+        buffer->end += numRead;
+        return numRead;
     }
 }
 
-/* checks the raw user input to ensure that it has a valid length and valid
- * number of individual arguments
- * also checks for the presence of an 's' at the start of the input to
- * indicate that the game should be saved
+/* checks if there are commands which have been read but not yet used, so
+ * that the next call to read_line will not have to wait
+ *
+ * returns: 1 if there is unread input in the buffer, 0 otherwise
+ *
+ */
+int input_waiting(void) {
+
+    return inputBuffer.start < inputBuffer.end;
+}
+
+/* checks a command from the user, either saving the game (if the command
+ * starts with an 's') or reading it as a move
  *
  * input: the user input being checked
  * size: the length of the user input
  * game: stores information on the current game
+ * userMove: stores the position of the move, if the input is a move
  *
- * returns: SUCCESS if the input is valid, SAVE_ATTEMPT if the input started
+ * returns: SUCCESS if the input is a move, SAVE_ATTEMPT if the input started
  *          with an 's', and ERROR otherwise
  *
  * error conditions: unable to save to file given in input
  *
  */
-int check_input(char* input, int size, struct Game* game) {
+int check_input(char* input, int size, struct Game* game, int* userMove) {
 
     // checks length of input;
     if (size > MAX_INPUT) {
@@ -336,113 +499,77 @@ int check_input(char* input, int size, struct Game* game) {
     
     // checks for input indicating a file save has been requested ('s')
     if (size > 0 && input[0] == 's') {
+        long long start = stats_start();
         int saveSuccess = save_game(input, size, game->grid, game);
+        trace_end("save_game", start);
         if (saveSuccess == ERROR) {
             fprintf(stderr, "%s\n", "Unable to save game");
         }
         return SAVE_ATTEMPT;
     }
 
-    // checks for the correct number of arguments in the input
-    int inputValid = check_arguments(input, &size);
-    if (inputValid == ERROR) {
-        return ERROR;
-    }
-
-    return SUCCESS;
+    return process_input(input, size, userMove);
 }
 
-/* checks that the user has entered exactly two space-separated values
- * helper method to check_input
- * 
- *
- * input: the user input to be checked
- * size: the length of the input
- *
- * returns: SUCCESS if there are exactly two individual values in input,
- *          ERROR otherwise
- */
-int check_arguments(char* input, int* size) {
-
-    int i;
-    int numSpaces = 0;
-    int numTokens = 0;
-    char previous = ' ';
-
-    // checks that the number of spaces and arguments (tokens) in the input
-    // are correct
-    for (i = 0; i < *size; i++) {
-
-        if (input[i] == ' ') {
-            numSpaces++;
-
-        } else if (previous == ' ' && input[i] != ' ') {
-            // indicates the end of a token
-            numTokens++;
-
-        }
-        // allows us to compare the next character with the current one
-        previous = input[i];
-    }
-    if (numSpaces != 1 || numTokens != 2) {
-        return ERROR;
-    }
-    return SUCCESS;
-}
-
-/* processes input of exactly two arguments, checks that they are integers,
- * and if they are, returns them as a grid position
+/* reads a move of exactly two integers separated by a single space, in one
+ * pass over the input (helper method to check_input)
  *
  * input: the user input to be processed
  * size: the length of the input
+ * userMove: stores the two integers as a grid position
  *
- * returns: a valid userMove if one was entered, otherwise an [ERROR, ERROR]
- *          pair
+ * returns: SUCCESS if input held two integers, ERROR otherwise
  *
  */
-int* process_input(char* input, int* size) {
-
-    int* userMove = malloc(sizeof(int) * 2);
-
-    // to store each individual token of the user input
-    char token1[MAX_INPUT / 2];
-    char token2[MAX_INPUT / 2];
+int process_input(char* input, int size, int* userMove) {
 
     int tokenCount = 0;
-    int stringLength = 0;
+    int digits = 0;
+    int hasSign = 0;
+    int negative = 0;
+    long value = 0;
     int i;
 
-    for (i = 0; i < *size; i++) {
-
-        if (input[i] != ' ' && tokenCount == 0) {
-            // builds up token1
-            token1[stringLength] = input[i];
-            stringLength++;
+    for (i = 0; i <= size; i++) {
+        char next = (i < size) ? input[i] : ' ';
 
-        } else if (input[i] != ' ' && tokenCount == 1) {
-            // builds up token2
-            token2[stringLength] = input[i];
-            stringLength++;
-
-        } else {
-            token1[stringLength] = '\0';
-            stringLength = 0;
+        if (next == ' ') {
+            // the end of a token, which must have been a whole number
+            if (digits == 0 || tokenCount == 2) {
+                return ERROR;
+            }
+            userMove[tokenCount] = (int)(negative ? -value : value);
             tokenCount++;
 
-        }
-    }
+            digits = 0;
+            hasSign = 0;
+            negative = 0;
+            value = 0;
 
-    token2[stringLength] = '\0';
+        } else if (next >= '0' && next <= '9') {
+            // values too large for any board are all kept as one value
+            if (value <= MAX_BOARD_WIDTH) {
+                value = value * 10 + (next - '0');
+            }
+            digits++;
 
-    // converts both tokens to integers (or ERROR, if they cannot be 
-    // converted)
-    int row = check_int(token1);
-    int column = check_int(token2);
+        } else if ((next == '+' || next == '-') && digits == 0 && !hasSign) {
+            hasSign = 1;
+            negative = (next == '-');
 
-    userMove[0] = row;
-    userMove[1] = column;
+        } else if (isspace((unsigned char)next) && digits == 0 && !hasSign) {
+            // other whitespace before a number is skipped (as by strtol)
+            continue;
 
-    return userMove;
+        } else {
+            return ERROR;
+        }
+    }
+    // the final token is ended by the end of the input
+    if (tokenCount != 2) {
+        return ERROR;
+    }
+    return SUCCESS;
 }
 
 /* checks the given userMove to ensure that its coordinates are valid grid
@@ -16,9 +16,14 @@ int save_game(char* input, int size, char** grid, struct Game* game);
 
 char** load_file(FILE* gameFile, struct Game* game);
 
+int read_saved_game(FILE* gameFile, struct Game* game, char*** grid);
+
+int parse_saved_game(char* contents, long length, struct Game* game,
+        char*** loaded, long* errorAt);
+
 char** init_saved_game(struct Game* game, int* fileInfo);
 
-void record_number(char* infoEntry, int* digits, int* fileInfo, 
+int record_number(char* infoEntry, int* digits, int* fileInfo, 
         int commaCounter);
 
 int check_int(char* numberString);
@@ -29,11 +34,13 @@ void exit_with_error(char* message, int exitStatus);
 
 char* read_line(FILE* file, int* length, struct Game* game);
 
-int check_input(char* input, int size, struct Game* game);
+int fill_buffer(struct InputBuffer* buffer, FILE* file);
+
+int input_waiting(void);
 
-int check_arguments(char* input, int* size);
+int check_input(char* input, int size, struct Game* game, int* userMove);
 
-int* process_input(char* input, int* size);
+int process_input(char* input, int size, int* userMove);
 
 int check_user_move(int* userMove, struct Game* game);
 
@@ -0,0 +1,1303 @@
+/*
+ * hexd.c
+ *
+ * a server which hosts many games of hex at once, for clients connecting
+ * over a Unix domain socket (or TCP on localhost)
+ *
+ * one thread runs an epoll event loop over every client, while a pool of
+ * worker threads finds the moves for auto and engine players; each game,
+ * along with its grids, is allocated from its own arena
+ *
+ * clients send one command per line:
+ *   create height width [p1type p2type]   a new game (players default to m)
+ *   load filename [p1type p2type]         a new game from a saved file
+ *   join id                               an existing game
+ *   move row column                       a move for the client's seat
+ *   save filename                         saves the client's game
+ *   show                                  the client's game grid
+ *   leave                                 leaves the client's game
+ *   quit                                  closes the connection
+ *
+ * create, load and join reply "OK id seat" (seat is O, X, or - to watch the
+ * game), show replies "BOARD id height width next" followed by the rows of
+ * the grid, and save replies "OK"; errors reply "ERR message"
+ *
+ * every move is sent to everyone in the game as "MOVE id symbol row column",
+ * and a win as "WIN id symbol"
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "hexd.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "winning.h"
+#include "position.h"
+#include "snapshot.h"
+#include "solvedb.h"
+#include "stats.h"
+#include "trace.h"
+
+/* set by a signal to stop the event loop */
+static volatile sig_atomic_t stopRequested = 0;
+
+int main(int argc, char** argv) {
+
+    struct Server server;
+    struct Options options;
+
+    if (parse_server_options(argc, argv, &server, &options) == ERROR) {
+        exit_with_error("Usage: hexd [--socket=path | --port=number] "
+                "[--workers=number] [--movetime=ms | --time=ms[+ms]] "
+                "[--playouts=number] [--policy=patterns | --policy=random] "
+                "[--layout=rows | --layout=tiled | --layout=morton] "
+                "[--db=file] [--trace=file]", 1);
+    }
+    set_board_layout(options.layout);
+    if (options.dbFile != NULL) {
+        init_solved_db(options.dbFile);
+    }
+    if (options.traceFile != NULL) {
+        init_trace(options.traceFile);
+    }
+
+    // replies to clients which have gone are dropped, rather than stopping
+    // the server
+    signal(SIGPIPE, SIG_IGN);
+
+    struct sigaction stop;
+    memset(&stop, 0, sizeof(struct sigaction));
+    stop.sa_handler = stop_server;
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+
+    // every client needs a file descriptor of its own
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    start_listening(&server);
+    start_workers(&server.pool, &options);
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &server.pool;
+    if (epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.pool.eventFd,
+            &event) == -1) {
+        exit_with_error("Could not start listening", 10);
+    }
+
+    run_server(&server);
+
+    stop_workers(&server.pool);
+    free_server(&server);
+    return 0;
+}
+
+/* reads the arguments given to the server
+ *
+ * argc: argument counter from running the program
+ * argv: the arguments given to the program
+ * server: stores the address to listen on and the number of workers
+ * options: stores the time limits for engine players
+ *
+ * returns: SUCCESS if every argument is valid, ERROR otherwise
+ *
+ */
+int parse_server_options(int argc, char** argv, struct Server* server,
+        struct Options* options) {
+
+    int i;
+
+    memset(server, 0, sizeof(struct Server));
+    memset(options, 0, sizeof(struct Options));
+    server->socketPath = DEFAULT_SOCKET;
+    server->pool.numWorkers = DEFAULT_WORKERS;
+
+    for (i = 1; i < argc; i++) {
+        char* option = argv[i];
+
+        if (strncmp(option, "--socket=", 9) == 0 && option[9] != '\0') {
+            server->socketPath = &option[9];
+            server->port = 0;
+
+        } else if (strncmp(option, "--port=", 7) == 0) {
+            // listens on localhost instead of a Unix domain socket
+            server->port = check_int(&option[7]);
+            server->socketPath = NULL;
+            if (server->port <= 0 || server->port > 65535) {
+                return ERROR;
+            }
+
+        } else if (strncmp(option, "--workers=", 10) == 0) {
+            server->pool.numWorkers = check_int(&option[10]);
+            if (server->pool.numWorkers <= 0 ||
+                    server->pool.numWorkers > MAX_WORKERS) {
+                return ERROR;
+            }
+
+        } else if (strncmp(option, "--movetime=", 11) == 0 ||
+                strncmp(option, "--time=", 7) == 0 ||
+                strncmp(option, "--playouts=", 11) == 0 ||
+                strncmp(option, "--policy=", 9) == 0 ||
+                strncmp(option, "--layout=", 9) == 0 ||
+                strncmp(option, "--db=", 5) == 0 ||
+                strncmp(option, "--trace=", 8) == 0) {
+            // engine players are limited in the same way as in bob
+            if (parse_option(option, options) == ERROR) {
+                return ERROR;
+            }
+
+        } else {
+            return ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
+/* opens the socket which clients connect to, and the epoll instance which
+ * watches it
+ *
+ * server: stores the address to listen on, and the sockets which are opened
+ *
+ * error conditions: unable to listen on the address
+ *
+ */
+void start_listening(struct Server* server) {
+
+    server->epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    if (server->port > 0) {
+        struct sockaddr_in address;
+        int reuse = 1;
+
+        memset(&address, 0, sizeof(struct sockaddr_in));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(server->port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        server->listenFd = socket(AF_INET,
+                SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        setsockopt(server->listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse,
+                sizeof(int));
+        if (server->listenFd == -1 || bind(server->listenFd,
+                (struct sockaddr*)&address, sizeof(address)) == -1) {
+            exit_with_error("Could not start listening", 10);
+        }
+
+    } else {
+        struct sockaddr_un address;
+        struct stat existing;
+
+        memset(&address, 0, sizeof(struct sockaddr_un));
+        address.sun_family = AF_UNIX;
+        if (strlen(server->socketPath) >= sizeof(address.sun_path)) {
+            exit_with_error("Could not start listening", 10);
+        }
+        strcpy(address.sun_path, server->socketPath);
+
+        // a socket left behind by an earlier server is replaced (but no
+        // other kind of file is)
+        if (lstat(server->socketPath, &existing) == 0 &&
+                S_ISSOCK(existing.st_mode)) {
+            unlink(server->socketPath);
+        }
+        server->listenFd = socket(AF_UNIX,
+                SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (server->listenFd == -1 || bind(server->listenFd,
+                (struct sockaddr*)&address, sizeof(address)) == -1) {
+            exit_with_error("Could not start listening", 10);
+        }
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &server->listenFd;
+    if (server->epollFd == -1 || listen(server->listenFd, SOMAXCONN) == -1 ||
+            epoll_ctl(server->epollFd, EPOLL_CTL_ADD, server->listenFd,
+            &event) == -1) {
+        exit_with_error("Could not start listening", 10);
+    }
+}
+
+/* starts the worker threads, each with an engine of its own
+ *
+ * pool: stores the workers (numWorkers is already set)
+ * options: the time limits for engine players
+ *
+ * error conditions: unable to start the workers
+ *
+ */
+void start_workers(struct WorkerPool* pool, struct Options* options) {
+
+    int i;
+
+    pool->workers = malloc(sizeof(struct Worker) * pool->numWorkers);
+    pool->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (pool->workers == NULL || pool->eventFd == -1) {
+        exit_with_error("Unable to start workers", 7);
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->ready, NULL);
+    pool->pending = NULL;
+    pool->pendingTail = NULL;
+    pool->done = NULL;
+    pool->stop = 0;
+
+    for (i = 0; i < pool->numWorkers; i++) {
+        struct Worker* worker = &pool->workers[i];
+
+        init_engine(&worker->engine, &options->clock, options->maxPlayouts);
+        worker->engine.patterns = options->patterns;
+
+        // gives each worker a different sequence of playouts
+        worker->engine.random ^= (unsigned long long)(i + 1) << 32;
+        worker->pool = pool;
+        if (pthread_create(&worker->thread, NULL, run_worker, worker) != 0) {
+            exit_with_error("Unable to start workers", 7);
+        }
+    }
+}
+
+/* stops the worker threads once they have finished their current moves
+ *
+ * pool: stores the workers
+ *
+ */
+void stop_workers(struct WorkerPool* pool) {
+
+    int i;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->numWorkers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+        free_engine(&pool->workers[i].engine);
+    }
+    free(pool->workers);
+    close(pool->eventFd);
+}
+
+/* finds moves for the games waiting on a worker, until the pool is stopped
+ * (the event loop does not touch a game while it is waiting, so its grid
+ * can be read without locking)
+ *
+ * arg: the worker running this thread
+ *
+ * returns: NULL
+ *
+ */
+void* run_worker(void* arg) {
+
+    struct Worker* worker = arg;
+    struct WorkerPool* pool = worker->pool;
+    uint64_t wake = 1;
+
+    trace_thread_name("worker");
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->pending == NULL && !pool->stop) {
+            pthread_cond_wait(&pool->ready, &pool->lock);
+        }
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        struct HostedGame* hosted = pool->pending;
+        pool->pending = hosted->nextJob;
+        if (pool->pending == NULL) {
+            pool->pendingTail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        struct Game* game = &hosted->game;
+        struct Player* player = player_to_move(game);
+        long long start = stats_start();
+
+        if (player->type == 'e') {
+            engine_search(&worker->engine, game, player, hosted->foundMove);
+            hosted->foundMoveNumber = player->moveNumber;
+        } else {
+            hosted->foundMoveNumber = find_auto_move(game, player, game->grid,
+                    hosted->foundMove);
+        }
+        trace_end("worker_move", start);
+
+        // hands the move back to the event loop, which plays it
+        pthread_mutex_lock(&pool->lock);
+        hosted->nextJob = pool->done;
+        pool->done = hosted;
+        pthread_mutex_unlock(&pool->lock);
+        if (write(pool->eventFd, &wake, sizeof(uint64_t)) == -1) {
+            // the counter is already waking the event loop
+            continue;
+        }
+    }
+    return NULL;
+}
+
+/* runs the event loop until the server is stopped by a signal
+ *
+ * server: stores the state of the server
+ *
+ */
+void run_server(struct Server* server) {
+
+    struct epoll_event events[MAX_EVENTS];
+    int i;
+
+    while (!stopRequested) {
+        int numEvents = epoll_wait(server->epollFd, events, MAX_EVENTS, -1);
+        if (numEvents == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (i = 0; i < numEvents; i++) {
+            void* source = events[i].data.ptr;
+
+            if (source == &server->listenFd) {
+                accept_clients(server);
+                continue;
+            }
+            if (source == &server->pool) {
+                finish_jobs(server);
+                continue;
+            }
+            struct Client* client = source;
+            if (client->closing) {
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flush_client(client);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_client(server, client);
+            }
+        }
+
+        // replies are sent once per batch of events, rather than once per
+        // line, and clients are only freed once nothing refers to them
+        flush_clients(server);
+        free_closed_clients(server);
+    }
+}
+
+/* closes the server's sockets and frees every game still being hosted,
+ * once the workers have stopped
+ *
+ * server: stores the state of the server
+ *
+ */
+void free_server(struct Server* server) {
+
+    int i;
+
+    close(server->listenFd);
+    close(server->epollFd);
+    if (server->socketPath != NULL) {
+        unlink(server->socketPath);
+    }
+    for (i = 0; i < server->numGames; i++) {
+        if (server->games[i] != NULL) {
+            free_arena(server->games[i]->arena);
+        }
+    }
+    while (server->freeArenas != NULL) {
+        struct Arena* next = server->freeArenas->next;
+
+        free_arena(server->freeArenas);
+        server->freeArenas = next;
+    }
+    free(server->games);
+}
+
+/* asks the event loop to stop (signal handler for SIGINT and SIGTERM)
+ *
+ * signalNumber: the signal which was received
+ *
+ */
+void stop_server(int signalNumber) {
+
+    stopRequested = 1;
+}
+
+/* accepts every client waiting to connect
+ *
+ * server: stores the state of the server
+ *
+ */
+void accept_clients(struct Server* server) {
+
+    while (1) {
+        int fd = accept(server->listenFd, NULL, NULL);
+        if (fd == -1) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        struct Client* client = calloc(1, sizeof(struct Client));
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+        if (server->port > 0) {
+            // replies are small, and should not wait to be combined
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(int));
+        }
+        client->fd = fd;
+        client->server = server;
+        client->seat = SPECTATOR;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            close(fd);
+            free(client);
+        }
+    }
+}
+
+/* reads everything a client has sent, and handles each complete command
+ *
+ * server: stores the state of the server
+ * client: the client to read from
+ *
+ */
+void read_client(struct Server* server, struct Client* client) {
+
+    while (!client->closing) {
+        int count = read(client->fd, &client->input[client->inputLength],
+                CLIENT_LINE_SIZE - client->inputLength);
+        if (count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (count <= 0) {
+            close_client(server, client);
+            return;
+        }
+        client->inputLength += count;
+
+        // each command ends with a newline (with an optional carriage
+        // return before it)
+        int start = 0;
+        char* newline;
+        while (!client->closing && (newline = memchr(&client->input[start],
+                '\n', client->inputLength - start)) != NULL) {
+
+            int length = newline - &client->input[start];
+            if (length > 0 && client->input[start + length - 1] == '\r') {
+                length--;
+            }
+            client->input[start + length] = '\0';
+            handle_command(server, client, &client->input[start], length);
+            start = newline - client->input + 1;
+        }
+        memmove(client->input, &client->input[start],
+                client->inputLength - start);
+        client->inputLength -= start;
+
+        if (client->inputLength == CLIENT_LINE_SIZE) {
+            reply(client, "ERR Command too long\n");
+            close_client(server, client);
+        }
+    }
+}
+
+/* carries out a single command from a client
+ *
+ * server: stores the state of the server
+ * client: the client which sent the command
+ * command: the command, without its newline
+ * length: the length of command
+ *
+ */
+void handle_command(struct Server* server, struct Client* client,
+        char* command, int length) {
+
+    // the arguments follow the first space
+    char* args = memchr(command, ' ', length);
+    if (args != NULL) {
+        *args = '\0';
+        args++;
+    } else {
+        args = &command[length];
+    }
+
+    if (length == 0) {
+        return;
+    } else if (strcmp(command, "create") == 0) {
+        create_game(server, client, args);
+    } else if (strcmp(command, "join") == 0) {
+        join_game(server, client, args);
+    } else if (strcmp(command, "move") == 0) {
+        move_in_game(server, client, args);
+    } else if (strcmp(command, "save") == 0) {
+        save_hosted_game(client, args);
+    } else if (strcmp(command, "load") == 0) {
+        load_game(server, client, args);
+    } else if (strcmp(command, "show") == 0) {
+        show_game(client);
+    } else if (strcmp(command, "leave") == 0) {
+        leave_game(server, client);
+        reply(client, "OK\n");
+    } else if (strcmp(command, "quit") == 0) {
+        close_client(server, client);
+    } else {
+        reply(client, "ERR Unknown command\n");
+    }
+}
+
+/* starts a new game for a client ("create height width [p1type p2type]")
+ *
+ * server: stores the state of the server
+ * client: the client creating the game
+ * args: the arguments to the command
+ *
+ */
+void create_game(struct Server* server, struct Client* client, char* args) {
+
+    char* words[MAX_WORDS];
+    char types[2];
+    int numWords = split_words(args, words);
+
+    if (numWords < 2 || read_types(&words[2], numWords - 2, types) ==
+            ERROR) {
+        reply(client, "ERR Usage: create height width [p1type p2type]\n");
+        return;
+    }
+    int height = check_int(words[0]);
+    int width = check_int(words[1]);
+
+    if (height < MIN_BOARD_WIDTH || height > MAX_BOARD_WIDTH ||
+            width < MIN_BOARD_WIDTH || width > MAX_BOARD_WIDTH) {
+        reply(client, "ERR Sensible board dimensions please!\n");
+        return;
+    }
+    struct HostedGame* hosted = host_game(server, height, width, types);
+    if (hosted == NULL) {
+        reply(client, "ERR Unable to create game\n");
+        return;
+    }
+    leave_game(server, client);
+    seat_client(client, hosted);
+    schedule_move(server, hosted);
+}
+
+/* seats a client in (or lets it watch) an existing game ("join id")
+ *
+ * server: stores the state of the server
+ * client: the client joining the game
+ * args: the arguments to the command
+ *
+ */
+void join_game(struct Server* server, struct Client* client, char* args) {
+
+    int id = check_int(args);
+
+    if (id <= 0 || id > server->numGames || server->games[id - 1] == NULL) {
+        reply(client, "ERR No such game\n");
+        return;
+    }
+    struct HostedGame* hosted = server->games[id - 1];
+    if (client->game == hosted) {
+        // the client keeps its seat, rather than leaving (and possibly
+        // closing) the game first
+        reply(client, "OK %d %c\n", hosted->id, client->seat == SPECTATOR ?
+                '-' : hosted->players[client->seat].playerSymbol);
+        return;
+    }
+    leave_game(server, client);
+    seat_client(client, hosted);
+}
+
+/* plays a move for a client's seat ("move row column")
+ *
+ * server: stores the state of the server
+ * client: the client making the move
+ * args: the arguments to the command
+ *
+ */
+void move_in_game(struct Server* server, struct Client* client, char* args) {
+
+    struct HostedGame* hosted = client->game;
+    int userMove[2];
+
+    if (hosted == NULL) {
+        reply(client, "ERR Not in a game\n");
+        return;
+    }
+    if (hosted->finished) {
+        reply(client, "ERR Game is over\n");
+        return;
+    }
+    struct Game* game = &hosted->game;
+    if (client->seat == SPECTATOR ||
+            player_to_move(game) != &hosted->players[client->seat]) {
+        reply(client, "ERR Not your turn\n");
+        return;
+    }
+
+    // check_user_move compares rows with the width and columns with the
+    // height (as bob does), so moves off the grid are ruled out first
+    if (process_input(args, strlen(args), userMove) == ERROR ||
+            userMove[0] < 0 || userMove[0] >= game->height ||
+            userMove[1] < 0 || userMove[1] >= game->width ||
+            check_user_move(userMove, game) == ERROR) {
+        reply(client, "ERR Invalid move\n");
+        return;
+    }
+    apply_move(server, hosted, userMove);
+}
+
+/* saves a client's game to a file ("save filename")
+ *
+ * client: the client saving the game
+ * args: the arguments to the command
+ *
+ */
+void save_hosted_game(struct Client* client, char* args) {
+
+    char input[MAX_FILE_NAME + 2];
+    int length = strlen(args);
+
+    if (client->game == NULL) {
+        reply(client, "ERR Not in a game\n");
+        return;
+    }
+    if (length == 0 || length > MAX_FILE_NAME) {
+        reply(client, "ERR Unable to save game\n");
+        return;
+    }
+    // save_game takes the same "sfilename" input as a manual player gives
+    input[0] = 's';
+    strcpy(&input[1], args);
+
+    struct Game* game = &client->game->game;
+    if (save_game(input, length + 1, game->grid, game) == ERROR) {
+        reply(client, "ERR Unable to save game\n");
+        return;
+    }
+    reply(client, "OK\n");
+}
+
+/* starts a new game for a client from a saved file
+ * ("load filename [p1type p2type]")
+ *
+ * server: stores the state of the server
+ * client: the client loading the game
+ * args: the arguments to the command
+ *
+ */
+void load_game(struct Server* server, struct Client* client, char* args) {
+
+    char* words[MAX_WORDS];
+    char types[2];
+    int numWords = split_words(args, words);
+    int i;
+
+    if (numWords < 1 || read_types(&words[1], numWords - 1, types) ==
+            ERROR) {
+        reply(client, "ERR Usage: load filename [p1type p2type]\n");
+        return;
+    }
+    FILE* gameFile = fopen(words[0], "r");
+    if (gameFile == NULL) {
+        reply(client, "ERR Could not start reading from savefile\n");
+        return;
+    }
+
+    // the saved game is read into a game of its own, then copied into the
+    // hosted game's arena once its dimensions are known
+    struct Game loaded;
+    struct Player player1;
+    struct Player player2;
+    init_game(&loaded, &player1, &player2);
+    int result = read_saved_game(gameFile, &loaded, &loaded.grid);
+    fclose(gameFile);
+    if (result == ERROR) {
+        reply(client, "ERR Incorrect file contents\n");
+        return;
+    }
+
+    struct HostedGame* hosted = host_game(server, loaded.height,
+            loaded.width, types);
+    if (hosted != NULL) {
+        struct Game* game = &hosted->game;
+
+        for (i = 0; i < game->height; i++) {
+            memcpy(game->grid[i], loaded.grid[i], game->width);
+        }
+        for (i = 0; i < 2; i++) {
+            hosted->players[i].hasNextMove =
+                    (i == 0 ? player1 : player2).hasNextMove;
+            hosted->players[i].moveNumber =
+                    (i == 0 ? player1 : player2).moveNumber;
+        }
+        // a saved game may already have been won
+        check_start(game, game->grid, game->connectionGrid);
+        hosted->finished = (is_winner(game, game->connectionGrid) == WIN);
+    }
+    for (i = 0; i < loaded.height + 1; i++) {
+        free(loaded.grid[i]);
+    }
+    free(loaded.grid);
+
+    if (hosted == NULL) {
+        reply(client, "ERR Unable to create game\n");
+        return;
+    }
+    leave_game(server, client);
+    seat_client(client, hosted);
+    schedule_move(server, hosted);
+}
+
+/* sends a client the grid of its game
+ *
+ * client: the client asking for the grid
+ *
+ */
+void show_game(struct Client* client) {
+
+    struct HostedGame* hosted = client->game;
+    int i;
+
+    if (hosted == NULL) {
+        reply(client, "ERR Not in a game\n");
+        return;
+    }
+    struct Game* game = &hosted->game;
+    char next = hosted->finished ? '-' : player_to_move(game)->playerSymbol;
+
+    reply(client, "BOARD %d %d %d %c\n", hosted->id, game->height,
+            game->width, next);
+    for (i = 0; i < game->height; i++) {
+        queue_output(client, game->grid[i], game->width);
+        queue_output(client, "\n", 1);
+    }
+}
+
+/* splits the arguments to a command into words separated by spaces
+ *
+ * args: the arguments (changed in place)
+ * words: stores the start of each word
+ *
+ * returns: the number of words, or ERROR if there are more than MAX_WORDS
+ *
+ */
+int split_words(char* args, char** words) {
+
+    int numWords = 0;
+    char* save;
+    char* word = strtok_r(args, " ", &save);
+
+    while (word != NULL) {
+        if (numWords == MAX_WORDS) {
+            return ERROR;
+        }
+        words[numWords] = word;
+        numWords++;
+        word = strtok_r(NULL, " ", &save);
+    }
+    return numWords;
+}
+
+/* reads the optional player types at the end of a create or load command
+ *
+ * words: the words which may hold the types
+ * numWords: the number of words (0 for two manual players)
+ * types: stores the types of player 1 and player 2
+ *
+ * returns: SUCCESS if the types are valid, ERROR otherwise
+ *
+ */
+int read_types(char** words, int numWords, char* types) {
+
+    if (numWords == 0) {
+        types[0] = 'm';
+        types[1] = 'm';
+        return SUCCESS;
+    }
+    if (numWords != 2 || check_type(words[0]) == ERROR ||
+            check_type(words[1]) == ERROR) {
+        return ERROR;
+    }
+    types[0] = *words[0];
+    types[1] = *words[1];
+    return SUCCESS;
+}
+
+/* allocates a new, empty game from an arena of its own, and gives it the
+ * next id
+ *
+ * server: stores the state of the server
+ * height, width: the dimensions of the game
+ * types: the types of player 1 and player 2
+ *
+ * returns: the new game, or NULL if it could not be allocated
+ *
+ */
+struct HostedGame* host_game(struct Server* server, int height, int width,
+        char* types) {
+
+    int i;
+
+    // the game and both of its grids are allocated together, with each grid
+    // in one block
+    size_t size = arena_round(sizeof(struct HostedGame)) +
+            arena_round(sizeof(char*) * height) +
+            arena_round(sizeof(char) * height * width) +
+            arena_round(sizeof(int*) * height) +
+            arena_round(sizeof(int) * height * width);
+
+    if (server->numGames == server->maxGames) {
+        int maxGames = server->maxGames == 0 ? 1024 : server->maxGames * 2;
+        struct HostedGame** games = realloc(server->games,
+                sizeof(struct HostedGame*) * maxGames);
+        if (games == NULL) {
+            return NULL;
+        }
+        server->games = games;
+        server->maxGames = maxGames;
+    }
+    struct Arena* arena = take_arena(server, size);
+    if (arena == NULL) {
+        return NULL;
+    }
+
+    struct HostedGame* hosted = arena_alloc(arena, sizeof(struct HostedGame));
+    memset(hosted, 0, sizeof(struct HostedGame));
+    hosted->arena = arena;
+
+    struct Game* game = &hosted->game;
+    init_game(game, &hosted->players[0], &hosted->players[1]);
+    game->height = height;
+    game->width = width;
+    game->size = height * width;
+
+    for (i = 0; i < 2; i++) {
+        hosted->players[i].type = types[i];
+        hosted->players[i].hasNextMove = (i == 0);
+        hosted->players[i].moveNumber = 0;
+    }
+
+    char* cells = arena_alloc(arena, sizeof(char) * game->size);
+    int* connections = arena_alloc(arena, sizeof(int) * game->size);
+    game->grid = arena_alloc(arena, sizeof(char*) * height);
+    game->connectionGrid = arena_alloc(arena, sizeof(int*) * height);
+
+    memset(cells, '.', game->size);
+    memset(connections, 0, sizeof(int) * game->size);
+    for (i = 0; i < height; i++) {
+        game->grid[i] = &cells[i * width];
+        game->connectionGrid[i] = &connections[i * width];
+    }
+
+    server->games[server->numGames] = hosted;
+    server->numGames++;
+    hosted->id = server->numGames;
+    return hosted;
+}
+
+/* seats a client in the first free manual seat of a game, or lets it watch
+ * the game if there is none, and tells the client which it was given
+ *
+ * client: the client joining the game
+ * hosted: the game being joined
+ *
+ */
+void seat_client(struct Client* client, struct HostedGame* hosted) {
+
+    int i;
+
+    client->game = hosted;
+    client->seat = SPECTATOR;
+    for (i = 0; i < 2; i++) {
+        if (hosted->players[i].type == 'm' && hosted->seats[i] == NULL) {
+            hosted->seats[i] = client;
+            client->seat = i;
+            break;
+        }
+    }
+    client->nextInGame = hosted->clients;
+    hosted->clients = client;
+
+    reply(client, "OK %d %c\n", hosted->id, client->seat == SPECTATOR ? '-' :
+            hosted->players[client->seat].playerSymbol);
+}
+
+/* takes a client out of its game, closing the game once nobody is left in
+ * it
+ *
+ * server: stores the state of the server
+ * client: the client leaving its game
+ *
+ */
+void leave_game(struct Server* server, struct Client* client) {
+
+    struct HostedGame* hosted = client->game;
+
+    if (hosted == NULL) {
+        return;
+    }
+    struct Client** link = &hosted->clients;
+    while (*link != client) {
+        link = &(*link)->nextInGame;
+    }
+    *link = client->nextInGame;
+
+    if (client->seat != SPECTATOR) {
+        hosted->seats[client->seat] = NULL;
+    }
+    client->game = NULL;
+    client->seat = SPECTATOR;
+
+    // a game still waiting on a worker is closed once its move comes back
+    if (hosted->clients == NULL && !hosted->busy) {
+        close_game(server, hosted);
+    }
+}
+
+/* removes a game from the server, giving its arena back to the pool
+ *
+ * server: stores the state of the server
+ * hosted: the game to close
+ *
+ */
+void close_game(struct Server* server, struct HostedGame* hosted) {
+
+    server->games[hosted->id - 1] = NULL;
+    give_back_arena(server, hosted->arena);
+}
+
+/* places a move for the player to move, tells everyone in the game about
+ * it, and checks for a win
+ *
+ * server: stores the state of the server
+ * hosted: the game the move is in
+ * move: the position of the move (already checked to be free)
+ *
+ */
+void apply_move(struct Server* server, struct HostedGame* hosted, int* move) {
+
+    struct Game* game = &hosted->game;
+    struct Player* player = player_to_move(game);
+
+    own_grid_row(game, move[0]);
+    game->grid[move[0]][move[1]] = player->playerSymbol;
+    broadcast(hosted, "MOVE %d %c %d %d\n", hosted->id, player->playerSymbol,
+            move[0], move[1]);
+
+    if (check_win(game, game->grid, game->connectionGrid, move, player) ==
+            WIN) {
+        hosted->finished = 1;
+        broadcast(hosted, "WIN %d %c\n", hosted->id, player->playerSymbol);
+        return;
+    }
+    player->hasNextMove = 0;
+    opponent_of(game, player)->hasNextMove = 1;
+    schedule_move(server, hosted);
+}
+
+/* hands a game to the workers if an auto or engine player is to move
+ *
+ * server: stores the state of the server
+ * hosted: the game which may need a move
+ *
+ */
+void schedule_move(struct Server* server, struct HostedGame* hosted) {
+
+    struct WorkerPool* pool = &server->pool;
+
+    if (hosted->finished || hosted->busy ||
+            player_to_move(&hosted->game)->type == 'm') {
+        return;
+    }
+    hosted->busy = 1;
+    hosted->nextJob = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->pendingTail == NULL) {
+        pool->pending = hosted;
+    } else {
+        pool->pendingTail->nextJob = hosted;
+    }
+    pool->pendingTail = hosted;
+    pthread_cond_signal(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* plays the moves which the workers have found
+ *
+ * server: stores the state of the server
+ *
+ */
+void finish_jobs(struct Server* server) {
+
+    struct WorkerPool* pool = &server->pool;
+    uint64_t count;
+
+    if (read(pool->eventFd, &count, sizeof(uint64_t)) == -1) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    struct HostedGame* hosted = pool->done;
+    pool->done = NULL;
+    pthread_mutex_unlock(&pool->lock);
+
+    while (hosted != NULL) {
+        struct HostedGame* next = hosted->nextJob;
+
+        hosted->busy = 0;
+        if (hosted->clients == NULL) {
+            // everyone left while the move was being found
+            close_game(server, hosted);
+        } else {
+            player_to_move(&hosted->game)->moveNumber =
+                    hosted->foundMoveNumber;
+            apply_move(server, hosted, hosted->foundMove);
+        }
+        hosted = next;
+    }
+}
+
+/* gets an arena of at least a given size, reusing a pooled one if possible
+ *
+ * server: stores the pool of arenas
+ * size: the number of bytes needed
+ *
+ * returns: an empty arena, or NULL if one could not be allocated
+ *
+ */
+struct Arena* take_arena(struct Server* server, size_t size) {
+
+    struct Arena** link = &server->freeArenas;
+
+    while (*link != NULL) {
+        struct Arena* arena = *link;
+
+        if (arena->size >= size) {
+            *link = arena->next;
+            server->numFreeArenas--;
+            reset_arena(arena);
+            return arena;
+        }
+        link = &arena->next;
+    }
+    return new_arena(size);
+}
+
+/* gives an arena back to the pool, or frees it if the pool is full
+ *
+ * server: stores the pool of arenas
+ * arena: the arena which is no longer needed
+ *
+ */
+void give_back_arena(struct Server* server, struct Arena* arena) {
+
+    if (server->numFreeArenas == MAX_FREE_ARENAS) {
+        free_arena(arena);
+        return;
+    }
+    arena->next = server->freeArenas;
+    server->freeArenas = arena;
+    server->numFreeArenas++;
+}
+
+/* queues a formatted line to be sent to a client
+ *
+ * client: the client to send the line to
+ * format: the format of the line (as for printf)
+ *
+ */
+void reply(struct Client* client, const char* format, ...) {
+
+    char line[CLIENT_LINE_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(line, CLIENT_LINE_SIZE, format, args);
+    va_end(args);
+    queue_output(client, line, length);
+}
+
+/* queues a formatted line to be sent to everyone in a game
+ *
+ * hosted: the game whose clients are sent the line
+ * format: the format of the line (as for printf)
+ *
+ */
+void broadcast(struct HostedGame* hosted, const char* format, ...) {
+
+    char line[CLIENT_LINE_SIZE];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(line, CLIENT_LINE_SIZE, format, args);
+    va_end(args);
+
+    struct Client* client;
+    for (client = hosted->clients; client != NULL;
+            client = client->nextInGame) {
+        queue_output(client, line, length);
+    }
+}
+
+/* adds text to the output waiting to be sent to a client (a client which
+ * has fallen too far behind is disconnected)
+ *
+ * client: the client to send the text to
+ * text: the text to send
+ * length: the length of text
+ *
+ */
+void queue_output(struct Client* client, char* text, int length) {
+
+    if (client->closing) {
+        return;
+    }
+    if (client->outputLength + length > MAX_CLIENT_OUTPUT) {
+        close_client(client->server, client);
+        return;
+    }
+    if (client->outputLength + length > client->outputCapacity) {
+        int capacity = client->outputCapacity == 0 ? CLIENT_LINE_SIZE :
+                client->outputCapacity;
+        while (capacity < client->outputLength + length) {
+            capacity *= 2;
+        }
+        char* output = realloc(client->output, capacity);
+        if (output == NULL) {
+            close_client(client->server, client);
+            return;
+        }
+        client->output = output;
+        client->outputCapacity = capacity;
+    }
+    memcpy(&client->output[client->outputLength], text, length);
+    client->outputLength += length;
+
+    if (!client->queued) {
+        client->queued = 1;
+        client->nextQueued = client->server->queued;
+        client->server->queued = client;
+    }
+}
+
+/* sends as much of a client's output as its socket will take, watching for
+ * the socket to have room again if any is left over
+ *
+ * client: the client to send to
+ *
+ */
+void flush_client(struct Client* client) {
+
+    struct Server* server = client->server;
+    int sent = 0;
+
+    while (sent < client->outputLength) {
+        int count = send(client->fd, &client->output[sent],
+                client->outputLength - sent, MSG_NOSIGNAL);
+        if (count == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            close_client(server, client);
+            return;
+        }
+        sent += count;
+    }
+    memmove(client->output, &client->output[sent],
+            client->outputLength - sent);
+    client->outputLength -= sent;
+
+    int waiting = (client->outputLength > 0);
+    if (waiting != client->waiting) {
+        struct epoll_event event;
+        event.events = waiting ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.ptr = client;
+        epoll_ctl(server->epollFd, EPOLL_CTL_MOD, client->fd, &event);
+        client->waiting = waiting;
+    }
+}
+
+/* sends the output queued for every client during the last batch of events
+ *
+ * server: stores the state of the server
+ *
+ */
+void flush_clients(struct Server* server) {
+
+    while (server->queued != NULL) {
+        struct Client* client = server->queued;
+
+        server->queued = client->nextQueued;
+        client->queued = 0;
+        if (!client->closing) {
+            flush_client(client);
+        }
+    }
+}
+
+/* disconnects a client (it is freed by free_closed_clients, once the
+ * current batch of events has been handled)
+ *
+ * server: stores the state of the server
+ * client: the client to disconnect
+ *
+ */
+void close_client(struct Server* server, struct Client* client) {
+
+    if (client->closing) {
+        return;
+    }
+    client->closing = 1;
+    close(client->fd);
+    client->nextClosing = server->closing;
+    server->closing = client;
+}
+
+/* takes the clients disconnected during the last batch of events out of
+ * their games, and frees them
+ *
+ * server: stores the state of the server
+ *
+ */
+void free_closed_clients(struct Server* server) {
+
+    while (server->closing != NULL) {
+        struct Client* client = server->closing;
+
+        server->closing = client->nextClosing;
+        leave_game(server, client);
+        free(client->output);
+        free(client);
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * hexd.h
+ *
+ * structs and function prototypes for hexd.c
+ *
+ */
+
+#ifndef HEXD_H_
+#define HEXD_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+#include "engine.h"
+#include "arena.h"
+
+/* the Unix domain socket listened on when no other address is given */
+#define DEFAULT_SOCKET "hexd.sock"
+
+#define DEFAULT_WORKERS 4
+
+#define MAX_WORKERS 256
+
+/* the number of events handled for each call to epoll_wait */
+#define MAX_EVENTS 256
+
+/* the longest command a client can send (including the newline) */
+#define CLIENT_LINE_SIZE 256
+
+/* clients which fall further behind than this on their replies are
+ * disconnected (bytes) */
+#define MAX_CLIENT_OUTPUT (1 << 22)
+
+/* finished games give their arenas back to a pool of at most this many, so
+ * that new games rarely need to allocate */
+#define MAX_FREE_ARENAS 64
+
+/* the longest file name which can be given to save or load (save_game keeps
+ * the name and a leading 's' in 70 characters) */
+#define MAX_FILE_NAME 68
+
+/* the most words in a command after its name */
+#define MAX_WORDS 4
+
+/* the seat of a client which is watching a game rather than playing */
+#define SPECTATOR -1
+
+/* Represents a connection to the server, which can be seated in (or
+ * watching) one game at a time */
+struct Client {
+    int fd;
+    struct Server* server;
+    struct HostedGame* game;
+    int seat;
+    int closing;
+    char input[CLIENT_LINE_SIZE];
+    int inputLength;
+    char* output;
+    int outputLength;
+    int outputCapacity;
+    int queued;
+    int waiting;
+    struct Client* nextInGame;
+    struct Client* nextQueued;
+    struct Client* nextClosing;
+};
+
+/* Represents a game being hosted by the server (allocated, along with its
+ * grids, from the game's own arena) */
+struct HostedGame {
+    int id;
+    struct Arena* arena;
+    struct Game game;
+    struct Player players[2];
+    struct Client* seats[2];
+    struct Client* clients;
+    int busy;
+    int finished;
+    int foundMove[2];
+    int foundMoveNumber;
+    struct HostedGame* nextJob;
+};
+
+/* Represents a thread which finds moves, with its own engine */
+struct Worker {
+    pthread_t thread;
+    struct Engine engine;
+    struct WorkerPool* pool;
+};
+
+/* Represents the threads which find moves for auto and engine players, so
+ * that searching never holds up the event loop */
+struct WorkerPool {
+    struct Worker* workers;
+    int numWorkers;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    struct HostedGame* pending;
+    struct HostedGame* pendingTail;
+    struct HostedGame* done;
+    int eventFd;
+    int stop;
+};
+
+/* Represents the whole server: its sockets, games and workers */
+struct Server {
+    int epollFd;
+    int listenFd;
+    char* socketPath;
+    int port;
+    struct HostedGame** games;
+    int numGames;
+    int maxGames;
+    struct Arena* freeArenas;
+    int numFreeArenas;
+    struct Client* queued;
+    struct Client* closing;
+    struct WorkerPool pool;
+};
+
+int parse_server_options(int argc, char** argv, struct Server* server,
+        struct Options* options);
+
+void start_listening(struct Server* server);
+
+void start_workers(struct WorkerPool* pool, struct Options* options);
+
+void stop_workers(struct WorkerPool* pool);
+
+void* run_worker(void* arg);
+
+void run_server(struct Server* server);
+
+void free_server(struct Server* server);
+
+void stop_server(int signalNumber);
+
+void accept_clients(struct Server* server);
+
+void read_client(struct Server* server, struct Client* client);
+
+void handle_command(struct Server* server, struct Client* client,
+        char* command, int length);
+
+void create_game(struct Server* server, struct Client* client, char* args);
+
+void join_game(struct Server* server, struct Client* client, char* args);
+
+void move_in_game(struct Server* server, struct Client* client, char* args);
+
+void save_hosted_game(struct Client* client, char* args);
+
+void load_game(struct Server* server, struct Client* client, char* args);
+
+void show_game(struct Client* client);
+
+int split_words(char* args, char** words);
+
+int read_types(char** words, int numWords, char* types);
+
+struct HostedGame* host_game(struct Server* server, int height, int width,
+        char* types);
+
+void seat_client(struct Client* client, struct HostedGame* hosted);
+
+void leave_game(struct Server* server, struct Client* client);
+
+void close_game(struct Server* server, struct HostedGame* hosted);
+
+void apply_move(struct Server* server, struct HostedGame* hosted, int* move);
+
+void schedule_move(struct Server* server, struct HostedGame* hosted);
+
+void finish_jobs(struct Server* server);
+
+struct Arena* take_arena(struct Server* server, size_t size);
+
+void give_back_arena(struct Server* server, struct Arena* arena);
+
+void reply(struct Client* client, const char* format, ...);
+
+void broadcast(struct HostedGame* hosted, const char* format, ...);
+
+void queue_output(struct Client* client, char* text, int length);
+
+void flush_client(struct Client* client);
+
+void flush_clients(struct Server* server);
+
+void close_client(struct Server* server, struct Client* client);
+
+void free_closed_clients(struct Server* server);
+
+#endif /* HEXD_H_ */
@@ -0,0 +1,515 @@
+/*
+ * htp.c
+ *
+ * plays as an engine for a GUI or referee over the Hex Text Protocol (the
+ * Go Text Protocol with hex moves), with commands read from stdin and
+ * responses written to stdout (--htp)
+ *
+ * nothing is drawn or prompted for unless showboard is asked for
+ *
+ * the protocol's first player (black) moves first and connects the top and
+ * bottom of its board, and "a1" is the top left corner with each row shifted
+ * right of the one above; bob's board is that board transposed and mirrored,
+ * so that black is O (connecting left and right) and the neighbours of every
+ * cell are the same
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+
+#include "htp.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "stats.h"
+#include "trace.h"
+#include "position.h"
+#include "snapshot.h"
+
+/* the commands which are understood, as listed by list_commands */
+static const char* commands[] = {"protocol_version", "name", "version",
+        "known_command", "list_commands", "boardsize", "clear_board", "play",
+        "genmove", "undo", "showboard", "quit", NULL};
+
+/* reads and answers commands until quit is given or stdin ends
+ *
+ * game: stores information on the current game
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the optional player types)
+ * options: the options given to the program
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: invalid arguments, or unable to allocate the board
+ *
+ */
+int run_htp(struct Game* game, int argc, char** argv,
+        struct Options* options) {
+
+    struct HtpSession session;
+    char* line = NULL;
+    size_t capacity = 0;
+    int i;
+
+    // engine players are used unless other types are given
+    if (argc != 1 && argc != 3) {
+        exit_with_error("Usage: bob --htp [p1type p2type]", 1);
+    }
+    game->player1->type = 'e';
+    game->player2->type = 'e';
+    if (argc == 3) {
+        if (check_type(argv[1]) == ERROR || check_type(argv[2]) == ERROR ||
+                *argv[1] == 'm' || *argv[2] == 'm') {
+            exit_with_error("Invalid type", 2);
+        }
+        game->player1->type = *argv[1];
+        game->player2->type = *argv[2];
+    }
+
+    session.game = game;
+    session.options = options;
+    attach_engine(game->player1, &session.engines[0], options);
+    attach_engine(game->player2, &session.engines[1], options);
+
+    game->grid = NULL;
+    if (new_board(&session, HTP_DEFAULT_SIZE, HTP_DEFAULT_SIZE) == ERROR) {
+        exit_with_error("Unable to start game", 7);
+    }
+
+    int quit = 0;
+    while (!quit && getline(&line, &capacity, stdin) != -1) {
+        quit = htp_command(&session, line);
+    }
+
+    free(line);
+    free_board(&session);
+    for (i = 0; i < 2; i++) {
+        struct Player* player = (i == 0) ? game->player1 : game->player2;
+        if (player->engine != NULL) {
+            free_engine(player->engine);
+        }
+    }
+    return 0;
+}
+
+/* answers a single command
+ *
+ * session: stores the game being played
+ * line: the command, as read (changed in place)
+ *
+ * returns: 1 if the command was quit, 0 otherwise
+ *
+ */
+int htp_command(struct HtpSession* session, char* line) {
+
+    struct Game* game = session->game;
+    char* words[MAX_HTP_ARGS + 2];
+    char* id = "";
+    int i;
+
+    int numWords = split_command(line, words);
+    if (numWords == 0) {
+        return 0;
+    }
+    if (numWords == ERROR) {
+        htp_reply(id, 0, "too many arguments");
+        return 0;
+    }
+    // commands may start with a number, which is repeated in the response
+    if (isdigit((unsigned char)words[0][0])) {
+        id = words[0];
+        numWords--;
+        memmove(words, &words[1], sizeof(char*) * numWords);
+        if (numWords == 0) {
+            htp_reply(id, 0, "unknown command");
+            return 0;
+        }
+    }
+    if (numWords > MAX_HTP_ARGS + 1) {
+        htp_reply(id, 0, "too many arguments");
+        return 0;
+    }
+    char* command = words[0];
+    char** args = &words[1];
+    int numArgs = numWords - 1;
+
+    if (strcmp(command, "protocol_version") == 0) {
+        htp_reply(id, 1, "2");
+
+    } else if (strcmp(command, "name") == 0) {
+        htp_reply(id, 1, "bob");
+
+    } else if (strcmp(command, "version") == 0) {
+        htp_reply(id, 1, "1.0");
+
+    } else if (strcmp(command, "known_command") == 0) {
+        int known = 0;
+        for (i = 0; numArgs == 1 && commands[i] != NULL; i++) {
+            known |= (strcmp(commands[i], args[0]) == 0);
+        }
+        htp_reply(id, 1, known ? "true" : "false");
+
+    } else if (strcmp(command, "list_commands") == 0) {
+        printf("=%s", id);
+        for (i = 0; commands[i] != NULL; i++) {
+            printf("%s%s\n", i == 0 ? " " : "", commands[i]);
+        }
+        printf("\n");
+        fflush(stdout);
+
+    } else if (strcmp(command, "boardsize") == 0) {
+        // the protocol gives the number of columns, then of rows (which are
+        // bob's rows and columns)
+        int columns = (numArgs >= 1) ? check_int(args[0]) : ERROR;
+        int rows = (numArgs == 2) ? check_int(args[1]) : columns;
+
+        if (numArgs < 1 || numArgs > 2 || columns < MIN_BOARD_WIDTH ||
+                columns > MAX_BOARD_WIDTH || rows < MIN_BOARD_WIDTH ||
+                rows > MAX_BOARD_WIDTH) {
+            htp_reply(id, 0, "unacceptable size");
+        } else if (new_board(session, columns, rows) == ERROR) {
+            htp_reply(id, 0, "unable to allocate board");
+        } else {
+            htp_reply(id, 1, "");
+        }
+
+    } else if (strcmp(command, "clear_board") == 0) {
+        if (new_board(session, game->height, game->width) == ERROR) {
+            htp_reply(id, 0, "unable to allocate board");
+        } else {
+            htp_reply(id, 1, "");
+        }
+
+    } else if (strcmp(command, "play") == 0) {
+        htp_play(session, id, args, numArgs);
+
+    } else if (strcmp(command, "genmove") == 0) {
+        htp_genmove(session, id, args, numArgs);
+
+    } else if (strcmp(command, "undo") == 0) {
+        if (undo_move(game) == ERROR) {
+            htp_reply(id, 0, "cannot undo");
+        } else {
+            if (session->winningMove > game->position->numMoves) {
+                session->winningMove = 0;
+            }
+            htp_reply(id, 1, "");
+        }
+
+    } else if (strcmp(command, "showboard") == 0) {
+        long long start = stats_start();
+        printf("=%s\n", id);
+        draw_grid(game, game->grid);
+        printf("\n");
+        fflush(stdout);
+        stats_stop(STAT_RENDER, start);
+        trace_end("draw_grid", start);
+
+    } else if (strcmp(command, "quit") == 0) {
+        htp_reply(id, 1, "");
+        return 1;
+
+    } else {
+        htp_reply(id, 0, "unknown command");
+    }
+    return 0;
+}
+
+/* splits a command into words, after removing any comment and control
+ * characters (helper method to htp_command)
+ *
+ * line: the command (changed in place)
+ * words: stores the start of each word
+ *
+ * returns: the number of words, or ERROR if there are too many
+ *
+ */
+int split_command(char* line, char** words) {
+
+    int numWords = 0;
+    char* save;
+    char* next;
+
+    for (next = line; *next != '\0'; next++) {
+        if (*next == '#') {
+            *next = '\0';
+            break;
+        }
+        if (iscntrl((unsigned char)*next)) {
+            *next = ' ';
+        }
+    }
+
+    char* word = strtok_r(line, " ", &save);
+    while (word != NULL) {
+        if (numWords == MAX_HTP_ARGS + 2) {
+            return ERROR;
+        }
+        words[numWords] = word;
+        numWords++;
+        word = strtok_r(NULL, " ", &save);
+    }
+    return numWords;
+}
+
+/* writes the response to a command, followed by the blank line which ends
+ * every response
+ *
+ * id: the number given with the command (or an empty string)
+ * success: 1 if the command succeeded, 0 if it failed
+ * format: the format of the response (as for printf)
+ *
+ */
+void htp_reply(char* id, int success, const char* format, ...) {
+
+    va_list args;
+
+    printf("%c%s ", success ? '=' : '?', id);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n\n");
+    fflush(stdout);
+}
+
+/* replaces the board with an empty one of the given dimensions, with O to
+ * move first
+ *
+ * session: stores the game being played
+ * height, width: the dimensions of the new board
+ *
+ * returns: SUCCESS if the board was allocated, ERROR otherwise (leaving the
+ *          old board in place)
+ *
+ */
+int new_board(struct HtpSession* session, int height, int width) {
+
+    struct Game* game = session->game;
+    struct Game board = *game;
+
+    board.height = height;
+    board.width = width;
+    board.size = height * width;
+    board.position = NULL;
+    board.gridRefs = NULL;
+    board.connectionRefs = NULL;
+
+    init_grids(&board);
+    if (init_position(&board) == ERROR) {
+        free_grids(&board);
+        return ERROR;
+    }
+    if (game->grid != NULL) {
+        free_board(session);
+    }
+    *game = board;
+    game->player1->hasNextMove = 1;
+    game->player2->hasNextMove = 0;
+    game->player1->moveNumber = 0;
+    game->player2->moveNumber = 0;
+    session->winningMove = 0;
+    return SUCCESS;
+}
+
+/* frees the board of the game being played
+ *
+ * session: stores the game being played
+ *
+ */
+void free_board(struct HtpSession* session) {
+
+    free_grids(session->game);
+    free_position(session->game);
+}
+
+/* plays a move given by the other program ("play color vertex")
+ *
+ * session: stores the game being played
+ * id: the number given with the command (or an empty string)
+ * args: the arguments to the command
+ * numArgs: the number of arguments
+ *
+ * returns: SUCCESS if the move was played, ERROR otherwise
+ *
+ */
+int htp_play(struct HtpSession* session, char* id, char** args,
+        int numArgs) {
+
+    struct Game* game = session->game;
+    int move[2];
+
+    if (numArgs != 2) {
+        htp_reply(id, 0, "syntax error");
+        return ERROR;
+    }
+    struct Player* player = read_color(game, args[0]);
+    if (player == NULL) {
+        htp_reply(id, 0, "invalid color");
+        return ERROR;
+    }
+    if (strcmp(args[1], "resign") == 0) {
+        htp_reply(id, 1, "");
+        return SUCCESS;
+    }
+    if (session->winningMove > 0) {
+        htp_reply(id, 0, "game is over");
+        return ERROR;
+    }
+    if (read_vertex(game, args[1], move) == ERROR ||
+            check_position(game->grid, move[0], move[1]) == ERROR) {
+        htp_reply(id, 0, "illegal move");
+        return ERROR;
+    }
+
+    // either player can be given a move, whoever was to move
+    player->hasNextMove = 1;
+    opponent_of(game, player)->hasNextMove = 0;
+
+    long long start = stats_start();
+    if (play_move(game, move) == WIN) {
+        session->winningMove = game->position->numMoves;
+    }
+    stats_stop(STAT_WIN_CHECK, start);
+    trace_end("check_win", start);
+    stats_end_move();
+
+    htp_reply(id, 1, "");
+    return SUCCESS;
+}
+
+/* finds and plays a move for one of bob's players ("genmove color"), and
+ * gives it to the other program
+ *
+ * session: stores the game being played
+ * id: the number given with the command (or an empty string)
+ * args: the arguments to the command
+ * numArgs: the number of arguments
+ *
+ * returns: SUCCESS if a move was played, ERROR otherwise
+ *
+ */
+int htp_genmove(struct HtpSession* session, char* id, char** args,
+        int numArgs) {
+
+    struct Game* game = session->game;
+    char vertex[16];
+    int move[2];
+
+    struct Player* player = (numArgs == 1) ? read_color(game, args[0]) :
+            NULL;
+    if (player == NULL) {
+        htp_reply(id, 0, "invalid color");
+        return ERROR;
+    }
+    if (session->winningMove > 0) {
+        // there is nothing left to play for
+        htp_reply(id, 1, "resign");
+        return ERROR;
+    }
+    player->hasNextMove = 1;
+    opponent_of(game, player)->hasNextMove = 0;
+
+    long long start = stats_start();
+    int result;
+    if (player->type == 'e') {
+        engine_search(player->engine, game, player, move);
+        result = play_move(game, move);
+    } else {
+        result = play_auto_move(game, move);
+    }
+    stats_stop(STAT_MOVE_GENERATION, start);
+    trace_end("move_generation", start);
+    stats_end_move();
+
+    if (result == WIN) {
+        session->winningMove = game->position->numMoves;
+    }
+    write_vertex(game, move, vertex);
+    htp_reply(id, 1, "%s", vertex);
+    return SUCCESS;
+}
+
+/* reads a color given to play or genmove
+ *
+ * game: stores information on the current game
+ * color: the color ("black" or "b" for O, "white" or "w" for X)
+ *
+ * returns: the player with that color, or NULL if color is invalid
+ *
+ */
+struct Player* read_color(struct Game* game, char* color) {
+
+    if (strcasecmp(color, "b") == 0 || strcasecmp(color, "black") == 0) {
+        return game->player1;
+    }
+    if (strcasecmp(color, "w") == 0 || strcasecmp(color, "white") == 0) {
+        return game->player2;
+    }
+    return NULL;
+}
+
+/* reads a cell given in the protocol's notation (a column of letters, then
+ * a row number starting from 1) as a position on bob's board
+ *
+ * game: stores information on the current game
+ * vertex: the cell to read (such as "c4", or "aa12" past column z)
+ * move: stores the position of the cell
+ *
+ * returns: SUCCESS if vertex is a cell on the board, ERROR otherwise
+ *
+ */
+int read_vertex(struct Game* game, char* vertex, int* move) {
+
+    int column = 0;
+    int letters = 0;
+
+    while (isalpha((unsigned char)vertex[letters])) {
+        column = column * 26 + (tolower((unsigned char)vertex[letters]) -
+                'a' + 1);
+        letters++;
+        if (column > MAX_BOARD_WIDTH) {
+            return ERROR;
+        }
+    }
+    int row = check_int(&vertex[letters]);
+
+    if (letters == 0 || row == ERROR || row < 1 || row > game->width ||
+            column > game->height) {
+        return ERROR;
+    }
+    // the protocol's columns are bob's rows, and its rows are bob's columns
+    // from right to left
+    move[0] = column - 1;
+    move[1] = game->width - row;
+    return SUCCESS;
+}
+
+/* writes a position on bob's board in the protocol's notation (the reverse
+ * of read_vertex)
+ *
+ * game: stores information on the current game
+ * move: the position to write
+ * vertex: stores the cell
+ *
+ */
+void write_vertex(struct Game* game, int* move, char* vertex) {
+
+    char letters[8];
+    int numLetters = 0;
+    int column = move[0] + 1;
+
+    while (column > 0) {
+        letters[numLetters] = 'a' + (column - 1) % 26;
+        numLetters++;
+        column = (column - 1) / 26;
+    }
+    int i;
+    for (i = 0; i < numLetters; i++) {
+        vertex[i] = letters[numLetters - 1 - i];
+    }
+    sprintf(&vertex[numLetters], "%d", game->width - move[1]);
+}
@@ -0,0 +1,53 @@
+/*
+ * htp.h
+ *
+ * structs and function prototypes for htp.c
+ *
+ */
+
+#ifndef HTP_H_
+#define HTP_H_
+
+#include "structs.h"
+#include "engine.h"
+
+/* the board used until a boardsize command is given */
+#define HTP_DEFAULT_SIZE 11
+
+/* the most arguments a command can have */
+#define MAX_HTP_ARGS 4
+
+/* Represents a game being played over the Hex Text Protocol */
+struct HtpSession {
+    struct Game* game;
+    struct Options* options;
+    struct Engine engines[2];
+    int winningMove;
+};
+
+int run_htp(struct Game* game, int argc, char** argv,
+        struct Options* options);
+
+int htp_command(struct HtpSession* session, char* line);
+
+int split_command(char* line, char** words);
+
+void htp_reply(char* id, int success, const char* format, ...);
+
+int new_board(struct HtpSession* session, int height, int width);
+
+void free_board(struct HtpSession* session);
+
+int htp_play(struct HtpSession* session, char* id, char** args,
+        int numArgs);
+
+int htp_genmove(struct HtpSession* session, char* id, char** args,
+        int numArgs);
+
+struct Player* read_color(struct Game* game, char* color);
+
+int read_vertex(struct Game* game, char* vertex, int* move);
+
+void write_vertex(struct Game* game, int* move, char* vertex);
+
+#endif /* HTP_H_ */
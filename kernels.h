@@ -0,0 +1,21 @@
+/*
+ * kernels.h
+ *
+ * the board sizes which the hottest routines are specialised for
+ *
+ */
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+/* calls X(size) for each square board size which has its own copies of the
+ * hottest routines, compiled with the dimensions as constants (so that
+ * bounds checks fold away and loops can be unrolled); every other size uses
+ * the generic routines */
+#define SPECIALISED_SIZES(X) X(11) X(13) X(14) X(19)
+
+/* marks the body shared by a generic routine and its specialised copies,
+ * which is inlined into each of them even without optimisation */
+#define KERNEL static inline __attribute__((always_inline))
+
+#endif /* KERNELS_H_ */
@@ -0,0 +1,505 @@
+/*
+ * match.c
+ *
+ * plays a match between two player configurations on every core
+ * (--match=games), stopping early once a sequential probability ratio test
+ * decides whether the first configuration is stronger, and reports the
+ * difference between them in Elo
+ *
+ * a configuration is a player type ('a' or 'e') followed by any options for
+ * that player, separated by commas ("e,--playouts=400"); the games start
+ * from the saved game files given after the configurations, two games from
+ * each file in turn so that each configuration plays both colours from it
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "match.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "position.h"
+#include "connectivity.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "trace.h"
+
+/* plays the match given by the arguments, and reports its result
+ *
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the two configurations, then
+ *       the opening files)
+ * options: the options given to the program (the most games to play, and
+ *          the Elo differences tested)
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: invalid arguments, or unable to read an opening
+ *
+ */
+int run_match(int argc, char** argv, struct Options* options) {
+
+    struct Match match;
+    pthread_t threads[MAX_MATCH_THREADS];
+    int numThreads = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    if (argc < 4) {
+        exit_with_error("Usage: bob --match=games config1 config2 "
+                "opening...", 1);
+    }
+    memset(&match, 0, sizeof(struct Match));
+    match.maxGames = options->matchGames;
+    match.elo0 = options->sprtGiven ? options->sprtElo0 : DEFAULT_SPRT_ELO0;
+    match.elo1 = options->sprtGiven ? options->sprtElo1 : DEFAULT_SPRT_ELO1;
+
+    for (i = 0; i < 2; i++) {
+        match.configs[i].options = *options;
+        read_config(argv[i + 1], &match.configs[i]);
+    }
+    match.numOpenings = argc - 3;
+    match.openings = malloc(sizeof(struct Opening) * match.numOpenings);
+    if (match.openings == NULL) {
+        exit_with_error("Unable to start match", 7);
+    }
+    for (i = 0; i < match.numOpenings; i++) {
+        load_opening(argv[i + 3], &match.openings[i]);
+    }
+    pthread_mutex_init(&match.lock, NULL);
+
+    // a thread which cannot be started just leaves more games for the rest
+    while (numThreads < cores - 1 && numThreads < MAX_MATCH_THREADS &&
+            numThreads < match.maxGames - 1) {
+        if (pthread_create(&threads[numThreads], NULL, match_worker,
+                &match) != 0) {
+            break;
+        }
+        numThreads++;
+    }
+    match_worker(&match);
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&match.lock);
+
+    report_match(&match);
+    for (i = 0; i < 2; i++) {
+        free(match.configs[i].name);
+    }
+    for (i = 0; i < match.numOpenings; i++) {
+        free(match.openings[i].cells);
+    }
+    free(match.openings);
+    return 0;
+}
+
+/* reads the Elo differences for the sequential probability ratio test
+ * ("0,10" tests whether the first configuration is 10 Elo stronger rather
+ * than no stronger)
+ *
+ * option: the value of the --sprt option
+ * options: stores the Elo differences which were read
+ *
+ * returns: SUCCESS if option is a valid pair of Elo differences, ERROR
+ *          otherwise
+ *
+ */
+int parse_sprt(char* option, struct Options* options) {
+
+    char* end;
+    double elo0 = strtod(option, &end);
+
+    if (end == option || *end != ',') {
+        return ERROR;
+    }
+    char* second = end + 1;
+    double elo1 = strtod(second, &end);
+
+    if (end == second || *end != '\0' || elo1 <= elo0) {
+        return ERROR;
+    }
+    options->sprtElo0 = elo0;
+    options->sprtElo1 = elo1;
+    options->sprtGiven = 1;
+    return SUCCESS;
+}
+
+/* reads a player configuration, on top of the options given to the program
+ *
+ * config: the configuration (changed in place, as it is split up)
+ * matchConfig: stores the player type and options of the configuration
+ *
+ * error conditions: the configuration has an invalid type or option
+ *
+ */
+void read_config(char* config, struct MatchConfig* matchConfig) {
+
+    matchConfig->name = strdup(config);
+    if (matchConfig->name == NULL) {
+        exit_with_error("Unable to start match", 7);
+    }
+
+    // only computer players can take part in a match
+    char* option = strtok(config, ",");
+    if (option == NULL || strlen(option) != 1 ||
+            (option[0] != 'a' && option[0] != 'e')) {
+        exit_with_error("Invalid player configuration", 2);
+    }
+    matchConfig->type = option[0];
+
+    while ((option = strtok(NULL, ",")) != NULL) {
+        if (parse_option(option, &matchConfig->options) == ERROR) {
+            exit_with_error("Invalid player configuration", 2);
+        }
+    }
+}
+
+/* reads an opening from a saved game file
+ *
+ * fileName: the saved game file
+ * opening: stores the opening
+ *
+ * error conditions: unable to open the file, the file is invalid, or the
+ *                   game in it has already been won
+ *
+ */
+void load_opening(char* fileName, struct Opening* opening) {
+
+    struct Game game;
+    struct Player player1;
+    struct Player player2;
+    struct Connectivity board;
+    int won = 0;
+    int i;
+    int j;
+
+    FILE* gameFile = fopen(fileName, "r");
+    if (gameFile == NULL) {
+        exit_with_error("Could not start reading from savefile", 4);
+    }
+    init_game(&game, &player1, &player2);
+    game.grid = load_file(gameFile, &game);
+    fclose(gameFile);
+
+    opening->height = game.height;
+    opening->width = game.width;
+    opening->toMove = player2.hasNextMove;
+    opening->moveNumbers[0] = player1.moveNumber;
+    opening->moveNumbers[1] = player2.moveNumber;
+    opening->cells = malloc(game.size);
+    if (opening->cells == NULL || init_connectivity(&board, game.height,
+            game.width) == ERROR) {
+        exit_with_error("Unable to start match", 7);
+    }
+
+    // a game which has already been won would have no moves to play
+    for (i = 0; i < game.height; i++) {
+        for (j = 0; j < game.width; j++) {
+            char symbol = game.grid[i][j];
+
+            opening->cells[i * game.width + j] = symbol;
+            if (symbol != '.' && add_stone(&board, i, j, symbol) == WIN) {
+                won = 1;
+            }
+        }
+    }
+    free_connectivity(&board);
+    for (i = 0; i < game.height + 1; i++) {
+        free(game.grid[i]);
+    }
+    free(game.grid);
+
+    if (won) {
+        exit_with_error("Opening has already been won", 5);
+    }
+}
+
+/* plays games until the match is over, with a game and an engine for each
+ * configuration of its own
+ *
+ * arg: the match being played
+ *
+ * returns: NULL
+ *
+ */
+void* match_worker(void* arg) {
+
+    struct Match* match = arg;
+    struct Game game;
+    struct Player playerO;
+    struct Player playerX;
+    struct Engine engines[2];
+    int i;
+
+    trace_worker_start("match");
+    init_game(&game, &playerO, &playerX);
+    for (i = 0; i < 2; i++) {
+        init_engine(&engines[i], &match->configs[i].options.clock,
+                match->configs[i].options.maxPlayouts);
+        engines[i].patterns = match->configs[i].options.patterns;
+    }
+
+    while (1) {
+        // games which have already started are finished after a decision,
+        // and still count towards the result
+        pthread_mutex_lock(&match->lock);
+        long gameNumber = match->nextGame;
+        int over = (match->decision != SPRT_CONTINUE ||
+                gameNumber >= match->maxGames);
+        if (!over) {
+            match->nextGame++;
+        }
+        pthread_mutex_unlock(&match->lock);
+
+        if (over) {
+            break;
+        }
+        long long start = stats_start();
+        play_match_game(match, &game, engines, gameNumber);
+        trace_end("match_game", start);
+    }
+    for (i = 0; i < 2; i++) {
+        free_engine(&engines[i]);
+    }
+    trace_worker_exit();
+    return NULL;
+}
+
+/* plays a single game of the match, and records its result
+ *
+ * match: the match being played
+ * game: stores the board and players of the game
+ * engines: the engines for each configuration
+ * gameNumber: the number of the game (which picks its opening and colours,
+ *             and seeds its engines)
+ *
+ * returns: the configuration which won the game
+ *
+ * error conditions: unable to allocate the board, or a player gave an
+ *                   invalid move
+ *
+ */
+int play_match_game(struct Match* match, struct Game* game,
+        struct Engine* engines, long gameNumber) {
+
+    struct Opening* opening =
+            &match->openings[(gameNumber / 2) % match->numOpenings];
+    struct Player* players[2] = {game->player1, game->player2};
+    unsigned long long state = MATCH_SEED + gameNumber;
+    int configs[2];
+    int move[2];
+    int result = SUCCESS;
+    int i;
+
+    // the first configuration plays O in even games, and X in odd games
+    for (i = 0; i < 2; i++) {
+        configs[i] = (i + gameNumber) % 2;
+
+        struct MatchConfig* config = &match->configs[configs[i]];
+        struct Engine* engine = &engines[configs[i]];
+
+        players[i]->type = config->type;
+        players[i]->engine = (config->type == 'e') ? engine : NULL;
+        players[i]->hasNextMove = (opening->toMove == i);
+        players[i]->moveNumber = opening->moveNumbers[i];
+
+        // each game is played out differently, and with a full clock
+        engine->random = next_key(&state);
+        if (config->options.clock.remaining > 0) {
+            engine->clock.remaining = config->options.clock.remaining;
+        }
+    }
+
+    game->height = opening->height;
+    game->width = opening->width;
+    game->size = game->height * game->width;
+    init_grids(game);
+    for (i = 0; i < game->height; i++) {
+        memcpy(game->grid[i], &opening->cells[i * game->width],
+                game->width);
+    }
+    if (init_position(game) == ERROR) {
+        exit_with_error("Unable to start match", 7);
+    }
+
+    struct Player* player = NULL;
+    while (result != WIN) {
+        player = player_to_move(game);
+
+        if (player->type == 'a') {
+            result = play_auto_move(game, move);
+        } else {
+            engine_search(player->engine, game, player, move);
+            result = play_move(game, move);
+        }
+        if (result == ERROR) {
+            exit_with_error("Player gave an invalid move", 7);
+        }
+    }
+    int winnerColour = (player == game->player2);
+    int winner = configs[winnerColour];
+
+    free_grids(game);
+    free_position(game);
+    record_result(match, winner, winnerColour);
+    return winner;
+}
+
+/* counts a finished game, and checks whether the test can stop the match
+ *
+ * match: the match being played
+ * winner: the configuration which won the game
+ * winnerColour: the colour which won the game (0 for O, 1 for X)
+ *
+ */
+void record_result(struct Match* match, int winner, int winnerColour) {
+
+    pthread_mutex_lock(&match->lock);
+    match->played++;
+    match->wins[winner]++;
+    match->colourWins[winnerColour]++;
+    match->llr = sprt_llr(match->wins[0], match->wins[1], match->elo0,
+            match->elo1);
+
+    // the first bound reached decides the test, whatever happens after
+    if (match->decision == SPRT_CONTINUE) {
+        if (match->llr >= log((1 - SPRT_BETA) / SPRT_ALPHA)) {
+            match->decision = SPRT_ACCEPT_H1;
+        } else if (match->llr <= log(SPRT_BETA / (1 - SPRT_ALPHA))) {
+            match->decision = SPRT_ACCEPT_H0;
+        }
+    }
+    pthread_mutex_unlock(&match->lock);
+}
+
+/* gets the expected score of a player with a given Elo advantage
+ *
+ * elo: the Elo difference
+ *
+ * returns: the expected score (between 0 and 1)
+ *
+ */
+double elo_to_score(double elo) {
+
+    return 1 / (1 + pow(10, -elo / 400));
+}
+
+/* gets the Elo advantage of a player with the score of a match (the point
+ * estimate reported by report_match)
+ *
+ * score: the score of the match
+ * games: the number of games the score is from, which limits it to half a
+ *        game from either end (so that a match won or lost in every game
+ *        still has a finite Elo difference)
+ *
+ * returns: the Elo difference
+ *
+ */
+double score_to_elo(double score, long games) {
+
+    double least = 0.5 / games;
+
+    if (score < least) {
+        score = least;
+    }
+    if (score > 1 - least) {
+        score = 1 - least;
+    }
+    return elo_of(score);
+}
+
+/* gets the Elo advantage of a player with a given expected score
+ *
+ * score: the expected score (strictly between 0 and 1)
+ *
+ * returns: the Elo difference
+ *
+ */
+double elo_of(double score) {
+
+    // (an even score is 0, rather than -0)
+    return 400 * log10(score / (1 - score));
+}
+
+/* writes one end of the confidence interval of a match's Elo difference
+ * (helper method to report_match)
+ *
+ * text: stores the end, with room for ELO_TEXT_LENGTH characters
+ * bound: the end of the interval of the score
+ * unbounded: whether the interval has no end on this side
+ * infinity: what is written for an end which is unbounded
+ *
+ */
+void format_bound(char* text, double bound, int unbounded, char* infinity) {
+
+    if (unbounded) {
+        snprintf(text, ELO_TEXT_LENGTH, "%s", infinity);
+    } else {
+        snprintf(text, ELO_TEXT_LENGTH, "%.1f", elo_of(bound));
+    }
+}
+
+/* gets the log likelihood ratio of the two hypotheses of the test, where
+ * every game is either won or lost (hex has no draws)
+ *
+ * wins: the games won by the first configuration
+ * losses: the games lost by the first configuration
+ * elo0: the Elo difference of the first hypothesis
+ * elo1: the Elo difference of the second hypothesis
+ *
+ * returns: the log likelihood ratio (positive when the second hypothesis
+ *          is more likely)
+ *
+ */
+double sprt_llr(long wins, long losses, double elo0, double elo1) {
+
+    double score0 = elo_to_score(elo0);
+    double score1 = elo_to_score(elo1);
+
+    return wins * log(score1 / score0) +
+            losses * log((1 - score1) / (1 - score0));
+}
+
+/* prints the result of a match
+ *
+ * match: the match which was played
+ *
+ */
+void report_match(struct Match* match) {
+
+    char* decisions[] = {"inconclusive", "H0 accepted", "H1 accepted"};
+    long games = match->played;
+    double score = (double)match->wins[0] / games;
+
+    // the Wilson score interval, which unlike the normal approximation
+    // does not shrink to nothing for a score of 0 or 1
+    double z2 = CONFIDENCE_Z * CONFIDENCE_Z / games;
+    double centre = (score + z2 / 2) / (1 + z2);
+    double error = CONFIDENCE_Z / (1 + z2) * sqrt(score * (1 - score) /
+            games + z2 / (4 * games));
+    char lower[ELO_TEXT_LENGTH];
+    char upper[ELO_TEXT_LENGTH];
+
+    // the interval has no end on the side of a match won or lost in every
+    // game
+    format_bound(lower, centre - error, match->wins[0] == 0, "-inf");
+    format_bound(upper, centre + error, match->wins[0] == games, "+inf");
+
+    printf("%ld games played\n", match->played);
+    printf("%s wins %ld\n", match->configs[0].name, match->wins[0]);
+    printf("%s wins %ld\n", match->configs[1].name, match->wins[1]);
+    printf("Player O wins %ld\n", match->colourWins[0]);
+    printf("Player X wins %ld\n", match->colourWins[1]);
+    printf("Elo difference %.1f (95%% confidence %s to %s)\n",
+            score_to_elo(score, games), lower, upper);
+    printf("SPRT elo0 %.1f elo1 %.1f: %s (LLR %.2f, bounds %.2f to %.2f)\n",
+            match->elo0, match->elo1, decisions[match->decision],
+            match->llr, log(SPRT_BETA / (1 - SPRT_ALPHA)),
+            log((1 - SPRT_BETA) / SPRT_ALPHA));
+}
@@ -0,0 +1,111 @@
+/*
+ * match.h
+ *
+ * structs and function prototypes for match.c
+ *
+ */
+
+#ifndef MATCH_H_
+#define MATCH_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+#include "engine.h"
+
+/* the most threads playing games at once */
+#define MAX_MATCH_THREADS 64
+
+/* the seed of the engines' random numbers for each game */
+#define MATCH_SEED 0x9E6C63D0676A9A99ULL
+
+/* the Elo differences tested by the sequential probability ratio test,
+ * unless --sprt is given */
+#define DEFAULT_SPRT_ELO0 0.0
+#define DEFAULT_SPRT_ELO1 10.0
+
+/* the chances of accepting the second hypothesis when the first is true
+ * (alpha), and the first when the second is true (beta) */
+#define SPRT_ALPHA 0.05
+#define SPRT_BETA 0.05
+
+/* the results of the sequential probability ratio test */
+#define SPRT_CONTINUE 0
+#define SPRT_ACCEPT_H0 1
+#define SPRT_ACCEPT_H1 2
+
+/* the room for an end of the confidence interval of an Elo difference, as
+ * text */
+#define ELO_TEXT_LENGTH 32
+
+/* the normal quantile for a 95% confidence interval */
+#define CONFIDENCE_Z 1.959964
+
+/* Represents a position which a pair of games starts from, read from a
+ * saved game file */
+struct Opening {
+    int height;
+    int width;
+    char* cells;
+    int toMove;
+    int moveNumbers[2];
+};
+
+/* Represents one side of a match: a player type and the options limiting
+ * it (as given by a configuration such as "e,--playouts=400") */
+struct MatchConfig {
+    char* name;
+    char type;
+    struct Options options;
+};
+
+/* Represents a match between two configurations, shared between the
+ * threads playing its games
+ *
+ * the games are played in pairs from the same opening, with the
+ * configurations swapping colours, and wins counts the games won by each
+ * configuration (colourWins those won by O and by X) */
+struct Match {
+    struct MatchConfig configs[2];
+    struct Opening* openings;
+    int numOpenings;
+    long maxGames;
+    long nextGame;
+    long played;
+    long wins[2];
+    long colourWins[2];
+    double elo0;
+    double elo1;
+    double llr;
+    int decision;
+    pthread_mutex_t lock;
+};
+
+int run_match(int argc, char** argv, struct Options* options);
+
+int parse_sprt(char* option, struct Options* options);
+
+void read_config(char* config, struct MatchConfig* matchConfig);
+
+void load_opening(char* fileName, struct Opening* opening);
+
+void* match_worker(void* arg);
+
+int play_match_game(struct Match* match, struct Game* game,
+        struct Engine* engines, long gameNumber);
+
+void record_result(struct Match* match, int winner, int winnerColour);
+
+double elo_to_score(double elo);
+
+double score_to_elo(double score, long games);
+
+double elo_of(double score);
+
+void format_bound(char* text, double bound, int unbounded, char* infinity);
+
+double sprt_llr(long wins, long losses, double elo0, double elo1);
+
+void report_match(struct Match* match);
+
+#endif /* MATCH_H_ */
@@ -0,0 +1,289 @@
+/*
+ * patterns.c
+ *
+ * a playout policy for the engine (--policy=patterns) which answers the
+ * last move when it threatens one of the mover's bridges, instead of always
+ * filling the board at random
+ *
+ * every empty cell keeps a code for its neighbourhood (what each of its six
+ * neighbours holds, with the cells off the board counted as the player
+ * whose edge they are), which is updated as each stone is placed; a
+ * precomputed table says for each code which neighbours of the cell would
+ * be intruding into a bridge the cell saves, so checking whether a cell
+ * answers the last move is a single lookup
+ *
+ * a bridge is two stones sharing two empty neighbours: once the opponent
+ * takes one of them, the other joins the stones (and a stone next to two
+ * empty cells of its own edge is joined to the edge in the same way)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "patterns.h"
+#include "gameIO.h"
+
+/* the offsets of the neighbours of a cell, in the same order as
+ * get_neighbours (each neighbour is next to the ones before and after it,
+ * going round the cell) */
+static const int rowOffsets[6] = {-1, 0, 1, 1, 0, -1};
+static const int columnOffsets[6] = {0, 1, 1, 0, -1, -1};
+
+/* which neighbour a cell is of each of its neighbours (the opposite one) */
+static const int opposites[6] = {3, 4, 5, 0, 1, 2};
+
+/* for each code, the neighbours of a cell where a stone of the opponent
+ * would be intruding into a bridge of O (0) or X (1) which the cell saves
+ * (one bit for each neighbour) */
+unsigned char patternTable[2][PATTERN_CODES];
+
+/* builds patternTable the first time any engine needs it */
+pthread_once_t patternTableOnce = PTHREAD_ONCE_INIT;
+
+/* sets up the state an engine needs to play out with patterns, once its
+ * board dimensions are known (called by set_position)
+ *
+ * engine: the engine, with its board dimensions set
+ *
+ * error conditions: unable to allocate the state
+ *
+ */
+void init_patterns(struct Engine* engine) {
+
+    int cell;
+    int i;
+
+    pthread_once(&patternTableOnce, build_pattern_table);
+
+    engine->neighbours = malloc(sizeof(int) * 6 * engine->size);
+    engine->codes = malloc(sizeof(unsigned short) * engine->size);
+    engine->rootCodes = malloc(sizeof(unsigned short) * engine->size);
+    if (engine->neighbours == NULL || engine->codes == NULL ||
+            engine->rootCodes == NULL) {
+        exit_with_error("Engine out of memory", 7);
+    }
+
+    for (cell = 0; cell < engine->size; cell++) {
+        int row = cell / engine->width;
+        int column = cell % engine->width;
+
+        for (i = 0; i < 6; i++) {
+            int nextRow = row + rowOffsets[i];
+            int nextColumn = column + columnOffsets[i];
+            int* neighbour = &engine->neighbours[cell * 6 + i];
+
+            // (a neighbour past a corner is counted as off the top or the
+            // bottom)
+            if (nextRow < 0 || nextRow >= engine->height) {
+                *neighbour = EDGE_X;
+            } else if (nextColumn < 0 || nextColumn >= engine->width) {
+                *neighbour = EDGE_O;
+            } else {
+                *neighbour = nextRow * engine->width + nextColumn;
+            }
+        }
+    }
+}
+
+/* fills in patternTable (called once, through pthread_once)
+ *
+ */
+void build_pattern_table(void) {
+
+    int code;
+
+    for (code = 0; code < PATTERN_CODES; code++) {
+        patternTable[0][code] = saves_bridge(code, PATTERN_O);
+        patternTable[1][code] = saves_bridge(code, PATTERN_X);
+    }
+}
+
+/* finds the neighbours of a cell holding a stone of the opponent which
+ * intrudes into a bridge of a player, joining two of their stones (or a
+ * stone and their edge), which playing in the cell would save (helper
+ * method to build_pattern_table)
+ *
+ * code: the neighbourhood of the cell
+ * player: PATTERN_O or PATTERN_X
+ *
+ * returns: a bit (1 << neighbour) for each such neighbour
+ *
+ */
+int saves_bridge(int code, int player) {
+
+    int opponent = (player == PATTERN_O) ? PATTERN_X : PATTERN_O;
+    int intruders = 0;
+    int i;
+
+    // the two stones are either side of the opponent's stone, going round
+    // the cell
+    for (i = 0; i < 6; i++) {
+        int before = (code >> (2 * ((i + 5) % 6))) & 3;
+        int middle = (code >> (2 * i)) & 3;
+        int after = (code >> (2 * ((i + 1) % 6))) & 3;
+
+        if (before == player && middle == opponent && after == player) {
+            intruders |= 1 << i;
+        }
+    }
+    return intruders;
+}
+
+/* works out the neighbourhood code of every cell of a board
+ *
+ * engine: the engine whose board it is
+ * cells: the board
+ * codes: stores the code of each cell
+ *
+ */
+void pattern_codes(struct Engine* engine, char* cells,
+        unsigned short* codes) {
+
+    int cell;
+    int i;
+
+    for (cell = 0; cell < engine->size; cell++) {
+        int code = 0;
+
+        for (i = 0; i < 6; i++) {
+            int neighbour = engine->neighbours[cell * 6 + i];
+            int holds = -neighbour;
+
+            if (neighbour >= 0) {
+                holds = (cells[neighbour] == 'O') ? PATTERN_O :
+                        (cells[neighbour] == 'X') ? PATTERN_X : PATTERN_EMPTY;
+            }
+            code |= holds << (2 * i);
+        }
+        codes[cell] = code;
+    }
+}
+
+/* updates the codes of the neighbours of a cell which a stone has just
+ * been placed on, and finds the opponent's answer to the stone while the
+ * neighbours are being visited
+ *
+ * engine: the engine whose board it is
+ * cells: the board, with the stone placed
+ * codes: the code of each cell
+ * cell: the cell of the stone
+ * symbol: the symbol of the stone
+ *
+ * returns: a free neighbour of the stone which saves a bridge of the
+ *          opponent that the stone intrudes into, or ERROR if there is
+ *          none
+ *
+ */
+int place_pattern_stone(struct Engine* engine, char* cells,
+        unsigned short* codes, int cell, char symbol) {
+
+    int holds = (symbol == 'O') ? PATTERN_O : PATTERN_X;
+    unsigned char* table = patternTable[(symbol == 'O') ? 1 : 0];
+    int* neighbours = &engine->neighbours[cell * 6];
+    int reply = ERROR;
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        int neighbour = neighbours[i];
+
+        if (neighbour >= 0) {
+            codes[neighbour] |= holds << (2 * opposites[i]);
+            if (reply == ERROR && cells[neighbour] == '.' &&
+                    (table[codes[neighbour]] & (1 << opposites[i]))) {
+                reply = neighbour;
+            }
+        }
+    }
+    return reply;
+}
+
+/* fills every free cell of the board, alternating between the players,
+ * answering each move which threatens a bridge of the next player and
+ * playing at random otherwise, then finds the winner of the filled board
+ * (used in place of fill_board, with the same arguments and result)
+ *
+ * engine: the engine running the search
+ * cells: the board to be filled
+ * toMove: the symbol of the player who fills the first free cell
+ *
+ * returns: the symbol of the winning player
+ *
+ */
+char pattern_fill(struct Engine* engine, char* cells, char toMove) {
+
+    unsigned short* codes = engine->codes;
+    int numEmpty = 0;
+    int next = 0;
+    int i;
+
+    // the codes of the root are brought up to date with the moves made
+    // down the tree
+    memcpy(codes, engine->rootCodes, sizeof(unsigned short) * engine->size);
+    for (i = 0; i < engine->size; i++) {
+        if (cells[i] == '.') {
+            engine->empty[numEmpty++] = i;
+        } else if (cells[i] != engine->cells[i]) {
+            place_pattern_stone(engine, cells, codes, i, cells[i]);
+        }
+    }
+    for (i = numEmpty - 1; i > 0; i--) {
+        int j = next_random(engine) % (i + 1);
+        int swap = engine->empty[i];
+
+        engine->empty[i] = engine->empty[j];
+        engine->empty[j] = swap;
+    }
+
+    int reply = pattern_reply(engine, cells, engine->lastCell, toMove);
+    for (i = 0; i < numEmpty; i++) {
+        int cell = reply;
+
+        // otherwise the next free cell in the shuffled order (cells taken
+        // by replies are skipped over)
+        if (cell == ERROR) {
+            while (cells[engine->empty[next]] != '.') {
+                next++;
+            }
+            cell = engine->empty[next++];
+        }
+        cells[cell] = toMove;
+        reply = place_pattern_stone(engine, cells, codes, cell, toMove);
+        toMove = other_symbol(toMove);
+    }
+    return full_board_winner(cells, engine->height, engine->width,
+            engine->empty);
+}
+
+/* finds a free neighbour of the last move of the tree which saves a
+ * bridge of the player to move (helper method to pattern_fill)
+ *
+ * engine: the engine running the search
+ * cells: the board
+ * lastCell: the cell of the last move, or ERROR if it is not known
+ * toMove: the symbol of the player to move
+ *
+ * returns: the cell, or ERROR if there is none
+ *
+ */
+int pattern_reply(struct Engine* engine, char* cells, int lastCell,
+        char toMove) {
+
+    unsigned char* table = patternTable[(toMove == 'O') ? 0 : 1];
+    int i;
+
+    if (lastCell == ERROR) {
+        return ERROR;
+    }
+    for (i = 0; i < 6; i++) {
+        int neighbour = engine->neighbours[lastCell * 6 + i];
+
+        if (neighbour >= 0 && cells[neighbour] == '.' &&
+                (table[engine->codes[neighbour]] & (1 << opposites[i]))) {
+            return neighbour;
+        }
+    }
+    return ERROR;
+}
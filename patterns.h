@@ -0,0 +1,45 @@
+/*
+ * patterns.h
+ *
+ * structs and function prototypes for patterns.c
+ *
+ */
+
+#ifndef PATTERNS_H_
+#define PATTERNS_H_
+
+#include "engine.h"
+
+/* the number of neighbourhoods of a cell: 2 bits for each of its six
+ * neighbours, in the order of get_neighbours */
+#define PATTERN_CODES 4096
+
+/* what a neighbour of a cell holds (off the board, the player whose edge
+ * it is) */
+#define PATTERN_EMPTY 0
+#define PATTERN_O 1
+#define PATTERN_X 2
+
+/* the neighbours off the board are stored as the negative of the player
+ * whose edge they are */
+#define EDGE_O (-PATTERN_O)
+#define EDGE_X (-PATTERN_X)
+
+void init_patterns(struct Engine* engine);
+
+void build_pattern_table(void);
+
+int saves_bridge(int code, int player);
+
+void pattern_codes(struct Engine* engine, char* cells,
+        unsigned short* codes);
+
+int place_pattern_stone(struct Engine* engine, char* cells,
+        unsigned short* codes, int cell, char symbol);
+
+char pattern_fill(struct Engine* engine, char* cells, char toMove);
+
+int pattern_reply(struct Engine* engine, char* cells, int lastCell,
+        char toMove);
+
+#endif /* PATTERNS_H_ */
@@ -0,0 +1,227 @@
+/*
+ * position.c
+ *
+ * plays moves in place on a game and takes them back again, keeping the
+ * grid, the groups of connected stones, a hash of the position and the
+ * players' move numbers in step (without allocating for each move)
+ *
+ * a game using these functions does not update its connectionGrid, since
+ * wins are found from the groups of connected stones instead
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "position.h"
+#include "bob.h"
+#include "snapshot.h"
+
+/* sets up a game for play_move and undo_move, starting from the stones
+ * already on its grid (which cannot be taken back)
+ *
+ * game: stores information on the current game
+ *
+ * returns: SUCCESS if the position was set up, ERROR otherwise
+ *
+ */
+int init_position(struct Game* game) {
+
+    struct Position* position = malloc(sizeof(struct Position));
+    int i;
+    int j;
+
+    if (position == NULL) {
+        return ERROR;
+    }
+    game->position = position;
+    position->keys = NULL;
+    position->history = NULL;
+    position->numMoves = 0;
+
+    if (init_connectivity(&position->board, game->height, game->width) ==
+            ERROR) {
+        free(position);
+        game->position = NULL;
+        return ERROR;
+    }
+
+    // every cell has a key for an O and a key for an X
+    position->keys = malloc(sizeof(unsigned long long) * game->size * 2);
+    position->history = malloc(sizeof(struct MoveRecord) * game->size);
+    if (position->keys == NULL || position->history == NULL) {
+        free_position(game);
+        return ERROR;
+    }
+    unsigned long long state = ZOBRIST_SEED;
+    for (i = 0; i < game->size * 2; i++) {
+        position->keys[i] = next_key(&state);
+    }
+    position->sideKey = next_key(&state);
+    position->hash = 0;
+
+    for (i = 0; i < game->height; i++) {
+        for (j = 0; j < game->width; j++) {
+            char symbol = game->grid[i][j];
+            if (symbol == '.') {
+                continue;
+            }
+            add_stone(&position->board, i, j, symbol);
+            position->hash ^= position->keys[(i * game->width + j) * 2 +
+                    (symbol == 'X')];
+        }
+    }
+    if (game->player2->hasNextMove) {
+        position->hash ^= position->sideKey;
+    }
+
+    // only the moves played from here on are logged
+    if (enable_undo(&position->board) == ERROR) {
+        free_position(game);
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/* frees the memory allocated by init_position
+ *
+ * game: stores information on the current game
+ *
+ */
+void free_position(struct Game* game) {
+
+    struct Position* position = game->position;
+
+    if (position == NULL) {
+        return;
+    }
+    free_connectivity(&position->board);
+    free(position->keys);
+    free(position->history);
+    free(position);
+    game->position = NULL;
+}
+
+/* places a stone for the player to move, then passes the turn to the other
+ * player
+ *
+ * game: stores information on the current game
+ * move: the position of the move
+ *
+ * returns: WIN if the move wins the game, ERROR if the position is off the
+ *          board or already taken, SUCCESS otherwise
+ *
+ */
+int play_move(struct Game* game, int* move) {
+
+    struct Position* position = game->position;
+    struct Player* player = player_to_move(game);
+    struct MoveRecord* record = &position->history[position->numMoves];
+
+    // the move numbers are recorded first, since play_auto_move changes
+    // them after the move has been played
+    record->cell = move[0] * game->width + move[1];
+    record->moveNumbers[0] = game->player1->moveNumber;
+    record->moveNumbers[1] = game->player2->moveNumber;
+    record->hasNextMove[0] = game->player1->hasNextMove;
+    record->hasNextMove[1] = game->player2->hasNextMove;
+
+    int result = add_stone(&position->board, move[0], move[1],
+            player->playerSymbol);
+    if (result == ERROR) {
+        return ERROR;
+    }
+    position->numMoves++;
+
+    own_grid_row(game, move[0]);
+    game->grid[move[0]][move[1]] = player->playerSymbol;
+    position->hash ^= position->keys[record->cell * 2 +
+            (player->playerSymbol == 'X')] ^ position->sideKey;
+
+    player->hasNextMove = 0;
+    opponent_of(game, player)->hasNextMove = 1;
+    return result;
+}
+
+/* finds and plays the next move for the player to move as an auto player
+ *
+ * game: stores information on the current game
+ * move: stores the position of the move
+ *
+ * returns: WIN if the move wins the game, SUCCESS otherwise
+ *
+ */
+int play_auto_move(struct Game* game, int* move) {
+
+    struct Player* player = player_to_move(game);
+    int moveNumber = find_auto_move(game, player, game->grid, move);
+
+    int result = play_move(game, move);
+    player->moveNumber = moveNumber;
+    return result;
+}
+
+/* takes back the last move played with play_move or play_auto_move
+ *
+ * game: stores information on the current game
+ *
+ * returns: SUCCESS if a move was taken back, ERROR if there are no moves to
+ *          take back
+ *
+ */
+int undo_move(struct Game* game) {
+
+    struct Position* position = game->position;
+
+    if (position->numMoves == 0) {
+        return ERROR;
+    }
+    position->numMoves--;
+    struct MoveRecord* record = &position->history[position->numMoves];
+    int row = record->cell / game->width;
+    int column = record->cell % game->width;
+    char symbol = game->grid[row][column];
+
+    remove_last_stone(&position->board);
+    own_grid_row(game, row);
+    game->grid[row][column] = '.';
+    position->hash ^= position->keys[record->cell * 2 + (symbol == 'X')] ^
+            position->sideKey;
+
+    game->player1->moveNumber = record->moveNumbers[0];
+    game->player2->moveNumber = record->moveNumbers[1];
+    game->player1->hasNextMove = record->hasNextMove[0];
+    game->player2->hasNextMove = record->hasNextMove[1];
+    return SUCCESS;
+}
+
+/* gets the player whose turn it is
+ *
+ * game: stores information on the current game
+ *
+ * returns: the player with the next move
+ *
+ */
+struct Player* player_to_move(struct Game* game) {
+
+    if (game->player1->hasNextMove == 1) {
+        return game->player1;
+    }
+    return game->player2;
+}
+
+/* generates the next key for hashing positions (splitmix64)
+ *
+ * state: the state of the generator (updated)
+ *
+ * returns: the next key
+ *
+ */
+unsigned long long next_key(unsigned long long* state) {
+
+    unsigned long long key = (*state += 0x9E3779B97F4A7C15ULL);
+
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
@@ -0,0 +1,51 @@
+/*
+ * position.h
+ *
+ * structs and function prototypes for position.c
+ *
+ */
+
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include "structs.h"
+#include "connectivity.h"
+
+/* the seed for the random keys used to hash positions */
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+
+/* Represents a move which can be taken back, with the state of the game
+ * from before it was played */
+struct MoveRecord {
+    int cell;
+    int moveNumbers[2];
+    int hasNextMove[2];
+};
+
+/* Represents the state a game needs to play moves and take them back
+ * cheaply: the groups of connected stones, a hash of the position, and the
+ * moves which have been played */
+struct Position {
+    struct Connectivity board;
+    unsigned long long hash;
+    unsigned long long* keys;
+    unsigned long long sideKey;
+    struct MoveRecord* history;
+    int numMoves;
+};
+
+int init_position(struct Game* game);
+
+void free_position(struct Game* game);
+
+int play_move(struct Game* game, int* move);
+
+int play_auto_move(struct Game* game, int* move);
+
+int undo_move(struct Game* game);
+
+struct Player* player_to_move(struct Game* game);
+
+unsigned long long next_key(unsigned long long* state);
+
+#endif /* POSITION_H_ */
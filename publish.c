@@ -0,0 +1,306 @@
+/*
+ * publish.c
+ *
+ * publishes the board of the game being played to a named shared memory
+ * segment (--publish=/name) after every move, so that other programs can
+ * follow the game at any rate without sockets and without parsing the
+ * printed grid, and watches a published board (--watch=/name)
+ *
+ * the game never waits for a reader: each write is bracketed by a sequence
+ * counter (a seqlock), and a reader which finds the counter changed while
+ * it was copying the board simply copies it again; a move only writes the
+ * cell it changed, so publishing costs the same on every size of board
+ *
+ * the segment is left behind when the game ends, so the final board can
+ * still be read, and is replaced when the next game publishes to it
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "publish.h"
+#include "bob.h"
+#include "gameIO.h"
+
+/* the board being published, if any */
+struct Publisher publisher;
+
+/* creates the shared memory segment and publishes the starting board
+ *
+ * name: the name of the segment (starting with '/')
+ * game: stores information on the current game
+ *
+ * error conditions: unable to create the segment
+ *
+ */
+void init_publish(char* name, struct Game* game) {
+
+    publisher.length = sizeof(struct Feed) + game->size;
+
+    // a segment left by an earlier game may have other dimensions, and
+    // anyone still reading it keeps their own copy once it is unlinked
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd == -1 || ftruncate(fd, publisher.length) == -1) {
+        exit_with_error("Could not publish board", 4);
+    }
+    publisher.feed = mmap(NULL, publisher.length, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (publisher.feed == MAP_FAILED) {
+        exit_with_error("Could not publish board", 4);
+    }
+
+    // (a new segment is all zeroes, so the sequence starts at 0)
+    struct Feed* feed = publisher.feed;
+    feed->height = game->height;
+    feed->width = game->width;
+    feed->winner = '.';
+    feed->lastRow = -1;
+    feed->lastColumn = -1;
+    publish_grid(game);
+
+    // the magic number goes last, so a reader never sees a segment whose
+    // dimensions are still being written
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(feed->magic, FEED_MAGIC, FEED_MAGIC_LENGTH);
+}
+
+/* publishes the whole board and the player to move (once at the start of
+ * the game)
+ *
+ * game: stores information on the current game
+ *
+ */
+void publish_grid(struct Game* game) {
+
+    struct Feed* feed = publisher.feed;
+    int i;
+
+    if (feed == NULL) {
+        return;
+    }
+    begin_write(feed);
+    for (i = 0; i < game->height; i++) {
+        memcpy(&feed->cells[i * game->width], game->grid[i], game->width);
+    }
+    feed->toMove = game->player2->hasNextMove ? 'X' : 'O';
+    end_write(feed);
+}
+
+/* publishes a move which has just been placed on the grid, along with the
+ * player now to move
+ *
+ * game: stores information on the current game
+ * move: the position of the move
+ *
+ */
+void publish_move(struct Game* game, int* move) {
+
+    struct Feed* feed = publisher.feed;
+    char symbol = game->grid[move[0]][move[1]];
+
+    if (feed == NULL) {
+        return;
+    }
+    begin_write(feed);
+    feed->cells[move[0] * game->width + move[1]] = symbol;
+    feed->toMove = (symbol == 'O') ? 'X' : 'O';
+    feed->lastRow = move[0];
+    feed->lastColumn = move[1];
+    feed->numMoves++;
+    end_write(feed);
+}
+
+/* publishes the winner of the game, after which nobody is to move
+ *
+ * symbol: the symbol of the winning player
+ *
+ */
+void publish_winner(char symbol) {
+
+    struct Feed* feed = publisher.feed;
+
+    if (feed == NULL) {
+        return;
+    }
+    begin_write(feed);
+    feed->winner = symbol;
+    feed->toMove = '.';
+    end_write(feed);
+}
+
+/* marks the published board as being written, before any of it changes
+ * (the game is the only writer)
+ *
+ * feed: the published board
+ *
+ */
+void begin_write(struct Feed* feed) {
+
+    __atomic_store_n(&feed->sequence, feed->sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/* marks the published board as consistent again, once every change has
+ * been written
+ *
+ * feed: the published board
+ *
+ */
+void end_write(struct Feed* feed) {
+
+    __atomic_store_n(&feed->sequence, feed->sequence + 1, __ATOMIC_RELEASE);
+}
+
+/* prints a published board each time a move is published to it, until a
+ * player wins
+ *
+ * name: the name of the segment (starting with '/')
+ *
+ * returns: 0 once a player has won (the exit status of the program)
+ *
+ * error conditions: unable to open the segment, or it does not hold a
+ *                   published board
+ *
+ */
+int run_watch(char* name) {
+
+    struct timespec interval = {0, WATCH_INTERVAL * 1000000L};
+    size_t length;
+    long shown = -1;
+
+    struct Feed* feed = open_feed(name, &length);
+    struct Feed* copy = malloc(length);
+    if (copy == NULL) {
+        exit_with_error("Unable to watch board", 7);
+    }
+
+    while (1) {
+        read_feed(feed, copy, length);
+        if (copy->numMoves != shown || copy->winner != '.') {
+            show_feed(copy);
+            shown = copy->numMoves;
+        }
+        if (copy->winner != '.') {
+            break;
+        }
+        nanosleep(&interval, NULL);
+    }
+    munmap(feed, length);
+    free(copy);
+    return 0;
+}
+
+/* maps a published board to be read (helper method to run_watch)
+ *
+ * name: the name of the segment
+ * length: stores the length of the segment
+ *
+ * returns: the published board
+ *
+ * error conditions: unable to open the segment, or it does not hold a
+ *                   published board
+ *
+ */
+struct Feed* open_feed(char* name, size_t* length) {
+
+    struct stat info;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        exit_with_error("Could not open published board", 4);
+    }
+    if (info.st_size < (off_t)sizeof(struct Feed)) {
+        exit_with_error("Incorrect published board contents", 5);
+    }
+    *length = info.st_size;
+    struct Feed* feed = mmap(NULL, *length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (feed == MAP_FAILED) {
+        exit_with_error("Could not open published board", 4);
+    }
+
+    // the dimensions are only read once the magic number shows that they
+    // have been written
+    if (memcmp(feed->magic, FEED_MAGIC, FEED_MAGIC_LENGTH) != 0) {
+        exit_with_error("Incorrect published board contents", 5);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (feed->height < MIN_BOARD_WIDTH ||
+            feed->height > MAX_BOARD_WIDTH ||
+            feed->width < MIN_BOARD_WIDTH || feed->width > MAX_BOARD_WIDTH ||
+            *length != sizeof(struct Feed) + feed->height * feed->width) {
+        exit_with_error("Incorrect published board contents", 5);
+    }
+    return feed;
+}
+
+/* copies a published board, trying again for as long as the game writes to
+ * it during the copy (helper method to run_watch)
+ *
+ * feed: the published board
+ * copy: stores the copy
+ * length: the length of the published board
+ *
+ */
+void read_feed(struct Feed* feed, struct Feed* copy, size_t length) {
+
+    unsigned long sequence;
+
+    while (1) {
+        sequence = __atomic_load_n(&feed->sequence, __ATOMIC_ACQUIRE);
+
+        // (the game is part way through a write)
+        if (sequence % 2 == 1) {
+            continue;
+        }
+        memcpy(copy, feed, length);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&feed->sequence, __ATOMIC_RELAXED) == sequence) {
+            return;
+        }
+    }
+}
+
+/* prints a copy of a published board, with the player to move or the
+ * winner (helper method to run_watch)
+ *
+ * copy: the copy of the published board
+ *
+ */
+void show_feed(struct Feed* copy) {
+
+    struct Game game;
+    char** grid = malloc(sizeof(char*) * copy->height);
+    int i;
+
+    if (grid == NULL) {
+        exit_with_error("Unable to watch board", 7);
+    }
+    for (i = 0; i < copy->height; i++) {
+        grid[i] = &copy->cells[i * copy->width];
+    }
+    game.height = copy->height;
+    game.width = copy->width;
+
+    if (copy->lastRow != -1) {
+        printf("Move %ld => %d %d\n", copy->numMoves, copy->lastRow,
+                copy->lastColumn);
+    }
+    draw_grid(&game, grid);
+    if (copy->winner != '.') {
+        printf("Player %c wins\n", copy->winner);
+    } else {
+        printf("Player %c to move\n", copy->toMove);
+    }
+    fflush(stdout);
+    free(grid);
+}
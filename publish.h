@@ -0,0 +1,70 @@
+/*
+ * publish.h
+ *
+ * structs and function prototypes for publish.c
+ *
+ */
+
+#ifndef PUBLISH_H_
+#define PUBLISH_H_
+
+#include "structs.h"
+
+/* the first bytes of every published board */
+#define FEED_MAGIC "BOBFEED1"
+#define FEED_MAGIC_LENGTH 8
+
+/* how often --watch looks for a new move (ms) */
+#define WATCH_INTERVAL 100
+
+/* Represents the board published to a shared memory segment (--publish),
+ * which other programs read without ever blocking the game
+ *
+ * sequence is odd while the game is writing, and goes up by two with each
+ * write, so a reader which sees the same even sequence before and after
+ * copying the board knows it got a consistent copy (a seqlock); height and
+ * width never change once the segment is created
+ *
+ * toMove is the symbol of the player to move, or '.' once winner is set,
+ * lastRow and lastColumn are -1 until the first move, and numMoves counts
+ * the moves published since the game started */
+struct Feed {
+    char magic[FEED_MAGIC_LENGTH];
+    unsigned long sequence;
+    int height;
+    int width;
+    char toMove;
+    char winner;
+    int lastRow;
+    int lastColumn;
+    long numMoves;
+    char cells[];
+};
+
+/* Represents the game's side of the published board */
+struct Publisher {
+    struct Feed* feed;
+    size_t length;
+};
+
+void init_publish(char* name, struct Game* game);
+
+void publish_grid(struct Game* game);
+
+void publish_move(struct Game* game, int* move);
+
+void publish_winner(char symbol);
+
+void begin_write(struct Feed* feed);
+
+void end_write(struct Feed* feed);
+
+int run_watch(char* name);
+
+struct Feed* open_feed(char* name, size_t* length);
+
+void read_feed(struct Feed* feed, struct Feed* copy, size_t length);
+
+void show_feed(struct Feed* copy);
+
+#endif /* PUBLISH_H_ */
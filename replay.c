@@ -0,0 +1,216 @@
+/*
+ * replay.c
+ *
+ * replays a log of moves without playing through the game loop
+ * (--replay FILE), and reports which player won and on which move
+ *
+ * a move log has a header line of "height,width", followed by one
+ * "row column" line per move, with O moving first
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "replay.h"
+#include "gameIO.h"
+
+/* replays every move in a move log, then prints the winner and the move
+ * on which the game was won
+ *
+ * fileName: the move log to be replayed
+ * prefixStats: 1 to print statistics after every move, 0 otherwise
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: unable to read the move log
+ *                   invalid move log contents
+ *
+ */
+int replay_game(char* fileName, int prefixStats) {
+
+    // the whole log is mapped into memory rather than read line by line
+    int file = open(fileName, O_RDONLY);
+    struct stat fileInfo;
+    if (file < 0 || fstat(file, &fileInfo) < 0) {
+        exit_with_error("Could not start reading from move log", 4);
+    }
+    if (fileInfo.st_size == 0) {
+        exit_with_error("Incorrect move log contents (line 1)", 5);
+    }
+    char* contents = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE,
+            file, 0);
+    if (contents == MAP_FAILED) {
+        exit_with_error("Could not start reading from move log", 4);
+    }
+    close(file);
+    madvise(contents, fileInfo.st_size, MADV_SEQUENTIAL);
+
+    struct MoveLog log;
+    log.position = contents;
+    log.end = contents + fileInfo.st_size;
+    log.line = 1;
+
+    // reads the dimensions of the board from the header
+    int height;
+    int width;
+    if (read_number(&log, &height, ',') == ERROR ||
+            read_number(&log, &width, '\n') == ERROR ||
+            height < MIN_BOARD_WIDTH || height > MAX_BOARD_WIDTH ||
+            width < MIN_BOARD_WIDTH || width > MAX_BOARD_WIDTH) {
+        bad_move_log(&log);
+    }
+    log.line++;
+
+    struct Connectivity board;
+    if (init_connectivity(&board, height, width) == ERROR) {
+        exit_with_error("Unable to replay move log", 5);
+    }
+    replay_moves(&log, &board, prefixStats);
+
+    free_connectivity(&board);
+    munmap(contents, fileInfo.st_size);
+    return 0;
+}
+
+/* plays each move in the log in turn, keeping track of the first move which
+ * wins the game (helper method to replay_game)
+ *
+ * log: the move log, positioned after its header
+ * board: the empty board to play the moves on
+ * prefixStats: 1 to print statistics after every move, 0 otherwise
+ *
+ * error conditions: invalid move in the log
+ *
+ */
+void replay_moves(struct MoveLog* log, struct Connectivity* board,
+        int prefixStats) {
+
+    char symbol = 'O';
+    char winner = '.';
+    long winningMove = 0;
+    long moves = 0;
+    int row;
+    int column;
+
+    if (prefixStats) {
+        printf("move,player,row,column,group_size,groups_o,groups_x\n");
+    }
+
+    while (read_move(log, &row, &column) == SUCCESS) {
+        int result = add_stone(board, row, column, symbol);
+        if (result == ERROR) {
+            bad_move_log(log);
+        }
+        moves++;
+
+        if (result == WIN && winner == '.') {
+            winner = symbol;
+            winningMove = moves;
+        }
+        if (prefixStats) {
+            printf("%ld,%c,%d,%d,%d,%d,%d\n", moves, symbol, row, column,
+                    group_size(board, row, column), board->numGroups[0],
+                    board->numGroups[1]);
+        }
+        log->line++;
+        symbol = (symbol == 'O') ? 'X' : 'O';
+    }
+
+    if (winner == '.') {
+        printf("No winner after %ld moves\n", moves);
+    } else {
+        printf("Player %c wins at move %ld of %ld\n", winner, winningMove,
+                moves);
+    }
+}
+
+/* reads the next move from the log, skipping any blank lines
+ *
+ * log: the move log being read
+ * row, column: store the position of the move
+ *
+ * returns: SUCCESS if a move was read, 0 at the end of the log
+ *
+ * error conditions: invalid move in the log
+ *
+ */
+int read_move(struct MoveLog* log, int* row, int* column) {
+
+    while (log->position < log->end && (*log->position == '\n' ||
+            *log->position == '\r')) {
+        if (*log->position == '\n') {
+            log->line++;
+        }
+        log->position++;
+    }
+    if (log->position == log->end) {
+        return 0;
+    }
+    if (read_number(log, row, ' ') == ERROR ||
+            read_number(log, column, '\n') == ERROR) {
+        bad_move_log(log);
+    }
+    return SUCCESS;
+}
+
+/* reads a number from the log, which must be followed by separator (a
+ * newline separator may also be "\r\n", or the end of the log)
+ *
+ * log: the move log being read
+ * value: stores the number which was read
+ * separator: the character which must follow the number
+ *
+ * returns: SUCCESS if a number was read, ERROR otherwise
+ *
+ */
+int read_number(struct MoveLog* log, int* value, char separator) {
+
+    int digits = 0;
+    *value = 0;
+
+    while (log->position < log->end && *log->position >= '0' &&
+            *log->position <= '9') {
+        // numbers too large for any board are all kept as one value
+        if (*value <= MAX_BOARD_WIDTH) {
+            *value = *value * 10 + (*log->position - '0');
+        }
+        log->position++;
+        digits++;
+    }
+    if (digits == 0) {
+        return ERROR;
+    }
+
+    if (separator == '\n') {
+        if (log->position == log->end) {
+            return SUCCESS;
+        }
+        if (*log->position == '\r' && log->position + 1 < log->end) {
+            log->position++;
+        }
+    }
+    if (log->position == log->end || *log->position != separator) {
+        return ERROR;
+    }
+    log->position++;
+    return SUCCESS;
+}
+
+/* exits with an error giving the line of the log which could not be read
+ *
+ * log: the move log being read
+ *
+ */
+void bad_move_log(struct MoveLog* log) {
+
+    char message[64];
+
+    snprintf(message, sizeof(message), "Incorrect move log contents "
+            "(line %d)", log->line);
+    exit_with_error(message, 5);
+}
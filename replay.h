@@ -0,0 +1,32 @@
+/*
+ * replay.h
+ *
+ * structs and function prototypes for replay.c
+ *
+ */
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "connectivity.h"
+
+/* Represents a move log being read, as the characters from position to end
+ * (line is the line number of position, for error messages) */
+struct MoveLog {
+    char* position;
+    char* end;
+    int line;
+};
+
+int replay_game(char* fileName, int prefixStats);
+
+void replay_moves(struct MoveLog* log, struct Connectivity* board,
+        int prefixStats);
+
+int read_move(struct MoveLog* log, int* row, int* column);
+
+int read_number(struct MoveLog* log, int* value, char separator);
+
+void bad_move_log(struct MoveLog* log);
+
+#endif /* REPLAY_H_ */
@@ -0,0 +1,436 @@
+/*
+ * selfplay.c
+ *
+ * plays games between two engine players on every core and streams each
+ * game to a compact binary record file (--selfplay=games), and prints
+ * record files back out as text (--dump=file)
+ *
+ * a record file is RECORD_MAGIC followed by one chunk for each game, in the
+ * order the games finished; each chunk starts with its length (4 bytes,
+ * least significant first) so that a reader can take one game at a time
+ * and skip any it does not need
+ *
+ * the dump has a line for every move: the game number, the move number
+ * (from 1), the player, the row and column of the move, and the winner of
+ * the game
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "selfplay.h"
+#include "bob.h"
+#include "gameIO.h"
+#include "engine.h"
+#include "position.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "trace.h"
+
+/* plays the games given by the arguments, writing them to the record file
+ *
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the board dimensions and the
+ *       record file)
+ * options: the options given to the program (the number of games, and the
+ *          limits for the engine players)
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: invalid arguments, or unable to write the record file
+ *
+ */
+int run_selfplay(int argc, char** argv, struct Options* options) {
+
+    struct SelfPlay selfPlay;
+    pthread_t threads[MAX_SELFPLAY_THREADS];
+    int numThreads = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    if (argc != 4) {
+        exit_with_error("Usage: bob --selfplay=games height width file", 1);
+    }
+    memset(&selfPlay, 0, sizeof(struct SelfPlay));
+    selfPlay.options = options;
+    selfPlay.numGames = options->selfPlayGames;
+    selfPlay.height = check_int(argv[1]);
+    selfPlay.width = check_int(argv[2]);
+
+    if (selfPlay.height < MIN_BOARD_WIDTH ||
+            selfPlay.height > MAX_BOARD_WIDTH ||
+            selfPlay.width < MIN_BOARD_WIDTH ||
+            selfPlay.width > MAX_BOARD_WIDTH) {
+        exit_with_error("Sensible board dimensions please!", 3);
+    }
+    selfPlay.recordFile = fopen(argv[3], "wb");
+    if (selfPlay.recordFile == NULL || fwrite(RECORD_MAGIC, 1,
+            RECORD_MAGIC_LENGTH, selfPlay.recordFile) !=
+            RECORD_MAGIC_LENGTH) {
+        exit_with_error("Could not write record file", 4);
+    }
+    pthread_mutex_init(&selfPlay.lock, NULL);
+
+    // a thread which cannot be started just leaves more games for the rest
+    while (numThreads < cores - 1 && numThreads < MAX_SELFPLAY_THREADS &&
+            numThreads < selfPlay.numGames - 1) {
+        if (pthread_create(&threads[numThreads], NULL, selfplay_worker,
+                &selfPlay) != 0) {
+            break;
+        }
+        numThreads++;
+    }
+    selfplay_worker(&selfPlay);
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&selfPlay.lock);
+
+    if (fclose(selfPlay.recordFile) != 0 || selfPlay.writeFailed) {
+        exit_with_error("Could not write record file", 4);
+    }
+    printf("%ld games written to %s\n", selfPlay.numGames, argv[3]);
+    printf("Player O wins %ld\n", selfPlay.wins[0]);
+    printf("Player X wins %ld\n", selfPlay.wins[1]);
+    return 0;
+}
+
+/* plays games until every game has been started, with a game and a pair of
+ * engines of its own
+ *
+ * arg: the run of games being played
+ *
+ * returns: NULL
+ *
+ * error conditions: unable to allocate a game
+ *
+ */
+void* selfplay_worker(void* arg) {
+
+    struct SelfPlay* selfPlay = arg;
+    struct Game game;
+    struct Player playerO;
+    struct Player playerX;
+    struct Engine engineO;
+    struct Engine engineX;
+
+    trace_worker_start("selfplay");
+    init_game(&game, &playerO, &playerX);
+    playerO.type = 'e';
+    playerX.type = 'e';
+    attach_engine(&playerO, &engineO, selfPlay->options);
+    attach_engine(&playerX, &engineX, selfPlay->options);
+
+    game.height = selfPlay->height;
+    game.width = selfPlay->width;
+    game.size = game.height * game.width;
+
+    // a chunk can hold every cell of the board, with its header and winner
+    unsigned char* chunk = malloc(MAX_VARINT_BYTES * (game.size + 4) + 1);
+    if (chunk == NULL) {
+        exit_with_error("Unable to start self-play", 7);
+    }
+
+    while (1) {
+        pthread_mutex_lock(&selfPlay->lock);
+        long gameNumber = selfPlay->nextGame++;
+        pthread_mutex_unlock(&selfPlay->lock);
+
+        if (gameNumber >= selfPlay->numGames) {
+            break;
+        }
+        long long start = stats_start();
+        int length = play_selfplay_game(selfPlay, &game, gameNumber, chunk);
+        write_chunk(selfPlay, chunk, length);
+        trace_end("selfplay_game", start);
+    }
+    free(chunk);
+    free_engine(&engineO);
+    free_engine(&engineX);
+    trace_worker_exit();
+    return NULL;
+}
+
+/* plays a single game, and stores it as a chunk of the record file
+ *
+ * selfPlay: the run of games being played
+ * game: stores the board dimensions and players of the game
+ * gameNumber: the number of the game (which seeds its engines)
+ * chunk: stores the chunk for the game (without its length)
+ *
+ * returns: the length of the chunk
+ *
+ * error conditions: unable to allocate the board, or an engine player
+ *                   gave an invalid move
+ *
+ */
+int play_selfplay_game(struct SelfPlay* selfPlay, struct Game* game,
+        long gameNumber, unsigned char* chunk) {
+
+    struct Player* players[2] = {game->player1, game->player2};
+    unsigned long long state = SELFPLAY_SEED + gameNumber;
+    int move[2];
+    int result = SUCCESS;
+    int length = 0;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        players[i]->hasNextMove = (i == 0);
+        players[i]->moveNumber = 0;
+
+        // each game is played out differently, and with a full clock
+        players[i]->engine->random = next_key(&state);
+        if (selfPlay->options->clock.remaining > 0) {
+            players[i]->engine->clock.remaining =
+                    selfPlay->options->clock.remaining;
+        }
+    }
+    init_grids(game);
+    if (init_position(game) == ERROR) {
+        exit_with_error("Unable to start self-play", 7);
+    }
+
+    while (result != WIN) {
+        struct Player* player = player_to_move(game);
+
+        engine_search(player->engine, game, player, move);
+        result = play_move(game, move);
+        if (result == ERROR) {
+            exit_with_error("Engine player gave an invalid move", 7);
+        }
+    }
+    struct Position* position = game->position;
+
+    // O moves first, so O made the winning move if there were an odd number
+    length += write_varint(&chunk[length], gameNumber);
+    length += write_varint(&chunk[length], game->height);
+    length += write_varint(&chunk[length], game->width);
+    length += write_varint(&chunk[length], position->numMoves);
+    for (i = 0; i < position->numMoves; i++) {
+        length += write_varint(&chunk[length], position->history[i].cell);
+    }
+    chunk[length++] = (position->numMoves % 2 == 1) ? 0 : 1;
+
+    free_grids(game);
+    free_position(game);
+    return length;
+}
+
+/* writes a chunk to the record file after its length, and counts the game
+ * towards its winner
+ *
+ * selfPlay: the run of games being played
+ * chunk: the chunk for the game
+ * length: the length of the chunk
+ *
+ */
+void write_chunk(struct SelfPlay* selfPlay, unsigned char* chunk,
+        int length) {
+
+    unsigned char prefix[CHUNK_LENGTH_BYTES];
+    int i;
+
+    for (i = 0; i < CHUNK_LENGTH_BYTES; i++) {
+        prefix[i] = (length >> (8 * i)) & 0xFF;
+    }
+
+    pthread_mutex_lock(&selfPlay->lock);
+    if (fwrite(prefix, 1, CHUNK_LENGTH_BYTES, selfPlay->recordFile) !=
+            CHUNK_LENGTH_BYTES || fwrite(chunk, 1, length,
+            selfPlay->recordFile) != (size_t)length) {
+        selfPlay->writeFailed = 1;
+    }
+    selfPlay->wins[chunk[length - 1]]++;
+    pthread_mutex_unlock(&selfPlay->lock);
+}
+
+/* writes a number as a varint: 7 bits at a time, least significant first,
+ * with the top bit of each byte set if there are more to come
+ *
+ * buffer: stores the varint
+ * value: the number to write
+ *
+ * returns: the number of bytes written
+ *
+ */
+int write_varint(unsigned char* buffer, unsigned long value) {
+
+    int length = 0;
+
+    while (value >= 0x80) {
+        buffer[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+/* reads a varint written by write_varint
+ *
+ * buffer: the bytes to read from
+ * length: the number of bytes in buffer
+ * offset: the position of the varint in buffer (moved past it)
+ * value: stores the number which was read
+ *
+ * returns: SUCCESS if a varint was read, ERROR if it runs past the end of
+ *          buffer or is too long
+ *
+ */
+int read_varint(unsigned char* buffer, int length, int* offset,
+        unsigned long* value) {
+
+    int i;
+
+    *value = 0;
+    for (i = 0; i < MAX_VARINT_BYTES && *offset < length; i++) {
+        unsigned char byte = buffer[(*offset)++];
+
+        *value |= (unsigned long)(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0) {
+            return SUCCESS;
+        }
+    }
+    return ERROR;
+}
+
+/* prints every move in a record file, reading one chunk at a time
+ *
+ * fileName: the record file
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: unable to open the file, or invalid file contents
+ *
+ */
+int dump_records(char* fileName) {
+
+    char magic[RECORD_MAGIC_LENGTH];
+    unsigned char* chunk = NULL;
+    int capacity = 0;
+    int length;
+
+    FILE* recordFile = fopen(fileName, "rb");
+    if (recordFile == NULL) {
+        exit_with_error("Could not open record file", 4);
+    }
+    if (fread(magic, 1, RECORD_MAGIC_LENGTH, recordFile) !=
+            RECORD_MAGIC_LENGTH ||
+            memcmp(magic, RECORD_MAGIC, RECORD_MAGIC_LENGTH) != 0) {
+        exit_with_error("Incorrect record file contents", 5);
+    }
+
+    while ((length = read_chunk(recordFile, &chunk, &capacity)) > 0) {
+        if (dump_chunk(chunk, length) == ERROR) {
+            exit_with_error("Incorrect record file contents", 5);
+        }
+    }
+    if (length == ERROR) {
+        exit_with_error("Incorrect record file contents", 5);
+    }
+    free(chunk);
+    fclose(recordFile);
+    return 0;
+}
+
+/* reads the next chunk of a record file
+ *
+ * recordFile: the record file, just after the previous chunk
+ * chunk: stores the chunk (grown if it is too small)
+ * capacity: the size of chunk (updated if it is grown)
+ *
+ * returns: the length of the chunk, 0 at the end of the file, or ERROR if
+ *          the chunk is cut short or could not be allocated
+ *
+ */
+int read_chunk(FILE* recordFile, unsigned char** chunk, int* capacity) {
+
+    unsigned char prefix[CHUNK_LENGTH_BYTES];
+    int length = 0;
+    int i;
+
+    size_t numRead = fread(prefix, 1, CHUNK_LENGTH_BYTES, recordFile);
+    if (numRead == 0 && feof(recordFile)) {
+        return 0;
+    }
+    if (numRead != CHUNK_LENGTH_BYTES) {
+        return ERROR;
+    }
+    for (i = CHUNK_LENGTH_BYTES - 1; i >= 0; i--) {
+        length = (length << 8) | prefix[i];
+    }
+    // the smallest chunk is four single byte varints and the winner
+    if (length < 5) {
+        return ERROR;
+    }
+
+    if (length > *capacity) {
+        unsigned char* larger = realloc(*chunk, length);
+        if (larger == NULL) {
+            return ERROR;
+        }
+        *chunk = larger;
+        *capacity = length;
+    }
+    if (fread(*chunk, 1, length, recordFile) != (size_t)length) {
+        return ERROR;
+    }
+    return length;
+}
+
+/* prints the moves of the game in a chunk (helper method to dump_records)
+ *
+ * chunk: the chunk to print
+ * length: the length of the chunk
+ *
+ * returns: SUCCESS if the chunk was printed, ERROR if it is invalid
+ *
+ */
+int dump_chunk(unsigned char* chunk, int length) {
+
+    unsigned long gameNumber;
+    unsigned long height;
+    unsigned long width;
+    unsigned long numMoves;
+    unsigned long cell;
+    int offset = 0;
+    unsigned long i;
+
+    if (read_varint(chunk, length, &offset, &gameNumber) == ERROR ||
+            read_varint(chunk, length, &offset, &height) == ERROR ||
+            read_varint(chunk, length, &offset, &width) == ERROR ||
+            read_varint(chunk, length, &offset, &numMoves) == ERROR) {
+        return ERROR;
+    }
+    if (height < MIN_BOARD_WIDTH || height > MAX_BOARD_WIDTH ||
+            width < MIN_BOARD_WIDTH || width > MAX_BOARD_WIDTH ||
+            numMoves > height * width) {
+        return ERROR;
+    }
+
+    // the winner comes after the moves, so they are checked before any are
+    // printed
+    int movesStart = offset;
+    for (i = 0; i < numMoves; i++) {
+        if (read_varint(chunk, length, &offset, &cell) == ERROR ||
+                cell >= height * width) {
+            return ERROR;
+        }
+    }
+    if (offset != length - 1 || chunk[offset] > 1) {
+        return ERROR;
+    }
+    char winner = (chunk[offset] == 0) ? 'O' : 'X';
+
+    offset = movesStart;
+    for (i = 0; i < numMoves; i++) {
+        read_varint(chunk, length, &offset, &cell);
+        printf("%lu %lu %c %lu %lu %c\n", gameNumber, i + 1,
+                (i % 2 == 0) ? 'O' : 'X', cell / width, cell % width,
+                winner);
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,72 @@
+/*
+ * selfplay.h
+ *
+ * structs and function prototypes for selfplay.c
+ *
+ */
+
+#ifndef SELFPLAY_H_
+#define SELFPLAY_H_
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "structs.h"
+
+/* the first bytes of every record file */
+#define RECORD_MAGIC "BOBGAME1"
+#define RECORD_MAGIC_LENGTH 8
+
+/* the bytes in the length before each chunk */
+#define CHUNK_LENGTH_BYTES 4
+
+/* the most bytes in a varint (7 bits of the number in each) */
+#define MAX_VARINT_BYTES 5
+
+/* the most threads playing games at once */
+#define MAX_SELFPLAY_THREADS 64
+
+/* the seed of the engines' random numbers for each game */
+#define SELFPLAY_SEED 0x2545F4914F6CDD1DULL
+
+/* Represents a run of games between engine players, shared between the
+ * threads playing them
+ *
+ * each game is written to the record file as one chunk, which is its
+ * length followed by the game number, the board height and width, the
+ * number of moves, each move (as row * width + column) and then the winner
+ * (0 for O, 1 for X), with every number but the winner as a varint */
+struct SelfPlay {
+    struct Options* options;
+    int height;
+    int width;
+    long numGames;
+    long nextGame;
+    long wins[2];
+    FILE* recordFile;
+    int writeFailed;
+    pthread_mutex_t lock;
+};
+
+int run_selfplay(int argc, char** argv, struct Options* options);
+
+void* selfplay_worker(void* arg);
+
+int play_selfplay_game(struct SelfPlay* selfPlay, struct Game* game,
+        long gameNumber, unsigned char* chunk);
+
+void write_chunk(struct SelfPlay* selfPlay, unsigned char* chunk,
+        int length);
+
+int write_varint(unsigned char* buffer, unsigned long value);
+
+int read_varint(unsigned char* buffer, int length, int* offset,
+        unsigned long* value);
+
+int dump_records(char* fileName);
+
+int read_chunk(FILE* recordFile, unsigned char** chunk, int* capacity);
+
+int dump_chunk(unsigned char* chunk, int length);
+
+#endif /* SELFPLAY_H_ */
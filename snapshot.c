@@ -0,0 +1,222 @@
+/*
+ * snapshot.c
+ *
+ * forks a game into an independent copy which shares the rows of its grid
+ * and connectionGrid with the original, copying a row only when one of the
+ * games first writes to it (so a fork costs O(height), not O(size))
+ *
+ * every write to the grid or connectionGrid of a game which may have been
+ * forked must first call own_grid_row or own_connection_row for that row
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snapshot.h"
+#include "gameIO.h"
+
+/* forks a game, so that the fork starts from the same position but can be
+ * played on without changing the original (or any other fork)
+ *
+ * the fork has no engines and no position for play_move (init_position can
+ * be called on it), and is freed with free_grids
+ *
+ * game: the game to be forked
+ * fork: stores the forked game
+ * player1, player2: store the players of the forked game
+ *
+ * returns: SUCCESS if the game was forked, ERROR otherwise
+ *
+ */
+int fork_game(struct Game* game, struct Game* fork, struct Player* player1,
+        struct Player* player2) {
+
+    // the first fork of a game starts counting the games sharing its rows
+    if (share_rows(&game->gridRefs, game->height) == ERROR ||
+            share_rows(&game->connectionRefs, game->height) == ERROR) {
+        return ERROR;
+    }
+
+    *fork = *game;
+    *player1 = *game->player1;
+    *player2 = *game->player2;
+    player1->engine = NULL;
+    player2->engine = NULL;
+    fork->player1 = player1;
+    fork->player2 = player2;
+    fork->position = NULL;
+
+    fork->grid = malloc(sizeof(char*) * game->height);
+    fork->connectionGrid = malloc(sizeof(int*) * game->height);
+    fork->gridRefs = malloc(sizeof(int*) * game->height);
+    fork->connectionRefs = malloc(sizeof(int*) * game->height);
+    if (fork->grid == NULL || fork->connectionGrid == NULL ||
+            fork->gridRefs == NULL || fork->connectionRefs == NULL) {
+        free(fork->grid);
+        free(fork->connectionGrid);
+        free(fork->gridRefs);
+        free(fork->connectionRefs);
+        return ERROR;
+    }
+
+    // only the row pointers are copied, with one more game sharing each row
+    memcpy(fork->grid, game->grid, sizeof(char*) * game->height);
+    memcpy(fork->connectionGrid, game->connectionGrid,
+            sizeof(int*) * game->height);
+    memcpy(fork->gridRefs, game->gridRefs, sizeof(int*) * game->height);
+    memcpy(fork->connectionRefs, game->connectionRefs,
+            sizeof(int*) * game->height);
+
+    int i;
+    for (i = 0; i < game->height; i++) {
+        __atomic_fetch_add(fork->gridRefs[i], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(fork->connectionRefs[i], 1, __ATOMIC_RELAXED);
+    }
+    return SUCCESS;
+}
+
+/* starts counting the games which share each row of a grid, if they are not
+ * already being counted (helper method to fork_game)
+ *
+ * refs: stores the counts for each row
+ * height: the number of rows
+ *
+ * returns: SUCCESS if the rows are being counted, ERROR otherwise
+ *
+ */
+int share_rows(int*** refs, int height) {
+
+    int i;
+
+    if (*refs != NULL) {
+        return SUCCESS;
+    }
+    *refs = malloc(sizeof(int*) * height);
+    if (*refs == NULL) {
+        return ERROR;
+    }
+    for (i = 0; i < height; i++) {
+        (*refs)[i] = malloc(sizeof(int));
+        if ((*refs)[i] == NULL) {
+            // nothing is shared yet, so the counts can simply be dropped
+            while (i > 0) {
+                i--;
+                free((*refs)[i]);
+            }
+            free(*refs);
+            *refs = NULL;
+            return ERROR;
+        }
+        *(*refs)[i] = 1;
+    }
+    return SUCCESS;
+}
+
+/* makes sure that a row of the grid belongs to this game alone before it is
+ * written to, copying it if it is shared with a fork
+ *
+ * game: stores information on the current game
+ * row: the row about to be written to
+ *
+ */
+void own_grid_row(struct Game* game, int row) {
+
+    if (game->gridRefs == NULL) {
+        return;
+    }
+    game->grid[row] = own_row(game->grid[row], &game->gridRefs[row],
+            sizeof(char) * game->width);
+}
+
+/* makes sure that a row of the connectionGrid belongs to this game alone
+ * before it is written to, copying it if it is shared with a fork
+ *
+ * game: stores information on the current game
+ * row: the row about to be written to
+ *
+ */
+void own_connection_row(struct Game* game, int row) {
+
+    if (game->connectionRefs == NULL) {
+        return;
+    }
+    game->connectionGrid[row] = own_row(game->connectionGrid[row],
+            &game->connectionRefs[row], sizeof(int) * game->width);
+}
+
+/* copies a row if any other game shares it (helper method to own_grid_row
+ * and own_connection_row)
+ *
+ * row: the row about to be written to
+ * ref: the number of games sharing the row (replaced for a copy)
+ * rowSize: the size of the row in bytes
+ *
+ * returns: the row to write to (either row, or a copy of it)
+ *
+ * error conditions: unable to copy the row
+ *
+ */
+void* own_row(void* row, int** ref, size_t rowSize) {
+
+    if (__atomic_load_n(*ref, __ATOMIC_ACQUIRE) == 1) {
+        return row;
+    }
+    void* copy = malloc(rowSize);
+    int* copyRef = malloc(sizeof(int));
+    if (copy == NULL || copyRef == NULL) {
+        exit_with_error("Unable to copy game", 7);
+    }
+    memcpy(copy, row, rowSize);
+    *copyRef = 1;
+
+    // the last game to let go of the shared row frees it (another game can
+    // copy it at the same time, leaving no game using the original)
+    release_row(row, *ref);
+    *ref = copyRef;
+    return copy;
+}
+
+/* frees the grid and connectionGrid of a game, keeping any rows which are
+ * still shared with a fork
+ *
+ * game: stores information on the current game
+ *
+ */
+void free_grids(struct Game* game) {
+
+    int i;
+
+    for (i = 0; i < game->height; i++) {
+        release_row(game->grid[i],
+                game->gridRefs == NULL ? NULL : game->gridRefs[i]);
+        release_row(game->connectionGrid[i],
+                game->connectionRefs == NULL ? NULL : game->connectionRefs[i]);
+    }
+    free(game->grid);
+    free(game->connectionGrid);
+    free(game->gridRefs);
+    free(game->connectionRefs);
+
+    game->grid = NULL;
+    game->connectionGrid = NULL;
+    game->gridRefs = NULL;
+    game->connectionRefs = NULL;
+}
+
+/* lets go of a row, freeing it if no other game shares it
+ *
+ * row: the row to let go of
+ * ref: the number of games sharing the row (NULL if it was never shared)
+ *
+ */
+void release_row(void* row, int* ref) {
+
+    if (ref == NULL) {
+        free(row);
+    } else if (__atomic_sub_fetch(ref, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(row);
+        free(ref);
+    }
+}
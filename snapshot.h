@@ -0,0 +1,30 @@
+/*
+ * snapshot.h
+ *
+ * function prototypes for snapshot.c
+ *
+ */
+
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <stddef.h>
+
+#include "structs.h"
+
+int fork_game(struct Game* game, struct Game* fork, struct Player* player1,
+        struct Player* player2);
+
+int share_rows(int*** refs, int height);
+
+void own_grid_row(struct Game* game, int row);
+
+void own_connection_row(struct Game* game, int row);
+
+void* own_row(void* row, int** ref, size_t rowSize);
+
+void free_grids(struct Game* game);
+
+void release_row(void* row, int* ref);
+
+#endif /* SNAPSHOT_H_ */
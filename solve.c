@@ -0,0 +1,910 @@
+/*
+ * solve.c
+ *
+ * proves whether the player to move in a saved game can win, and finds a
+ * winning move if so (--solve), with a depth-first proof-number search
+ *
+ * positions are held as one bitboard for each player, so boards of up to
+ * MAX_SOLVE_CELLS cells can be solved, and are stored in a transposition
+ * table shared between the threads (keyed by the smallest hash of the
+ * position under the board's symmetries)
+ *
+ * the moves searched from each position are cut down by must-play pruning
+ * on virtual connections: chains of stones joined by bridges (two stones
+ * sharing two empty neighbours) and edge templates (a stone next to two
+ * empty cells of its edge), whose pairs of empty cells (their carriers) do
+ * not overlap, so that either cell of a pair can be answered with the
+ * other
+ *
+ * a player to move wins if some move gives them a virtual connection
+ * between their edges; otherwise every move which gives the opponent one
+ * is a threat, and the player has to play in the threat's cell or its
+ * carrier, so only the cells in every threat's carrier are searched (and
+ * a position where no cell is in all of them is lost)
+ *
+ * only the chains found by joining bridges and edge templates one at a
+ * time are used, so some virtual connections are missed (the search is
+ * still exact, but is pruned less there), and larger edge templates are
+ * not used at all
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "solve.h"
+#include "gameIO.h"
+#include "position.h"
+#include "solvedb.h"
+#include "stats.h"
+#include "trace.h"
+
+/* loads a saved game and solves it, printing whether the player to move
+ * wins and how
+ *
+ * game: stores information on the game being solved
+ * argc: argument counter, after any options have been removed
+ * argv: the arguments given to the program (the saved game's filename)
+ *
+ * returns: 0 (the exit status of the program)
+ *
+ * error conditions: invalid arguments, unable to read the saved game, the
+ *                   board is too large, or unable to allocate the search
+ *
+ */
+int solve_game(struct Game* game, int argc, char** argv) {
+
+    struct Solver solver;
+    int i;
+
+    if (argc != 2) {
+        exit_with_error("Usage: bob --solve filename", 1);
+    }
+    FILE* savedGame = fopen(argv[1], "r");
+    if (savedGame == NULL) {
+        exit_with_error("Could not start reading from savefile", 4);
+    }
+    game->grid = load_file(savedGame, game);
+    fclose(savedGame);
+
+    if (game->size > MAX_SOLVE_CELLS) {
+        exit_with_error("Board too large to solve", 3);
+    }
+    if (init_solver(&solver, game) == ERROR) {
+        exit_with_error("Unable to start solver", 7);
+    }
+    char symbol = (solver.root.toMove == 0) ? 'O' : 'X';
+    char other = (solver.root.toMove == 0) ? 'X' : 'O';
+    int move[2];
+
+    if (has_connected(&solver, solver.root.stones[0], 0)) {
+        printf("Player O has already won\n");
+
+    } else if (has_connected(&solver, solver.root.stones[1], 1)) {
+        printf("Player X has already won\n");
+
+    } else {
+        // positions solved before are read back instead of searched again
+        int value = db_lookup(game, game->grid, move);
+        if (value == SOLVE_UNKNOWN) {
+            solve_root(&solver);
+            value = (solver.winningMove != -1) ? SOLVE_WON : SOLVE_LOST;
+            move[0] = solver.winningMove / solver.width;
+            move[1] = solver.winningMove % solver.width;
+            db_record(game, game->grid, value, move);
+        }
+
+        if (value == SOLVE_WON) {
+            printf("Player %c to move wins with %d %d\n", symbol, move[0],
+                    move[1]);
+        } else {
+            printf("Player %c to move loses to player %c\n", symbol, other);
+        }
+        if (solver.positions == 0) {
+            printf("Found in the solved database\n");
+        } else {
+            printf("%ld positions searched\n", solver.positions);
+        }
+    }
+    for (i = 0; i < game->height + 1; i++) {
+        free(game->grid[i]);
+    }
+    free(game->grid);
+    free_solver(&solver);
+    return 0;
+}
+
+/* sets up a solver for the position of a game
+ *
+ * solver: the solver to set up
+ * game: stores information on the game being solved
+ *
+ * returns: SUCCESS if the solver was set up, ERROR if its transposition
+ *          table could not be allocated
+ *
+ */
+int init_solver(struct Solver* solver, struct Game* game) {
+
+    unsigned long long state = SOLVE_SEED;
+    int cell[2];
+    int result[2];
+    int i;
+    int j;
+
+    memset(solver, 0, sizeof(struct Solver));
+    solver->height = game->height;
+    solver->width = game->width;
+    solver->size = game->size;
+    solver->numTransforms = num_transforms(game);
+    solver->boardMask = (solver->size == 64) ? ~0ULL :
+            (1ULL << solver->size) - 1;
+
+    for (i = 0; i < solver->size; i++) {
+        int row = i / solver->width;
+        int column = i % solver->width;
+
+        // O connects left to right, and X connects top to bottom
+        if (column == 0) {
+            solver->firstColumn |= 1ULL << i;
+        }
+        if (column == solver->width - 1) {
+            solver->lastColumn |= 1ULL << i;
+        }
+        if (row == 0) {
+            solver->firstRow |= 1ULL << i;
+        }
+        if (row == solver->height - 1) {
+            solver->lastRow |= 1ULL << i;
+        }
+        solver->keys[i][0] = next_key(&state);
+        solver->keys[i][1] = next_key(&state);
+        solver->neighbours[i] = spread(solver, 1ULL << i);
+    }
+    for (i = 0; i < solver->size; i++) {
+        for (j = 0; j < solver->size; j++) {
+            unsigned long long shared = solver->neighbours[i] &
+                    solver->neighbours[j];
+
+            if (j != i && (solver->neighbours[i] & (1ULL << j)) == 0 &&
+                    __builtin_popcountll(shared) == 2) {
+                solver->bridges[i] |= 1ULL << j;
+            }
+        }
+    }
+    sort_cells(solver);
+    solver->sideKeys[0] = next_key(&state);
+    solver->sideKeys[1] = next_key(&state);
+
+    for (i = 0; i < solver->numTransforms; i++) {
+        for (cell[0] = 0; cell[0] < solver->height; cell[0]++) {
+            for (cell[1] = 0; cell[1] < solver->width; cell[1]++) {
+                transform_cell(game, i, cell, result);
+                solver->cellMaps[i][cell[0] * solver->width + cell[1]] =
+                        result[0] * solver->width + result[1];
+            }
+        }
+        solver->swapsPlayers[i] = (transform_symbol(i, 'O') == 'X');
+    }
+
+    // the stones are placed as if each player had moved in turn
+    for (cell[0] = 0; cell[0] < solver->height; cell[0]++) {
+        for (cell[1] = 0; cell[1] < solver->width; cell[1]++) {
+            char symbol = game->grid[cell[0]][cell[1]];
+            if (symbol == '.') {
+                continue;
+            }
+            solver->root.toMove = (symbol == 'O') ? 0 : 1;
+            place_stone(solver, &solver->root,
+                    cell[0] * solver->width + cell[1]);
+        }
+    }
+    solver->root.toMove = (side_to_move(game) == 'O') ? 0 : 1;
+
+    solver->table = calloc(1 << SOLVE_TABLE_BITS, sizeof(struct SolveEntry));
+    if (solver->table == NULL) {
+        return ERROR;
+    }
+    for (i = 0; i < SOLVE_LOCKS; i++) {
+        pthread_mutex_init(&solver->tableLocks[i], NULL);
+    }
+    pthread_mutex_init(&solver->lock, NULL);
+    return SUCCESS;
+}
+
+/* orders the cells of the board by their distance from its centre, which
+ * is the order moves are searched in when nothing else tells them apart
+ * (helper method to init_solver)
+ *
+ * solver: the solver whose board dimensions have been set
+ *
+ */
+void sort_cells(struct Solver* solver) {
+
+    int distances[MAX_SOLVE_CELLS];
+    int i;
+    int j;
+
+    for (i = 0; i < solver->size; i++) {
+        // doubled, so that the centre of an even board is a whole number
+        int row = 2 * (i / solver->width) - (solver->height - 1);
+        int column = 2 * (i % solver->width) - (solver->width - 1);
+
+        // the distance between cells on a hex board (the rows and columns
+        // of neighbours move by 1 in the same direction, or in only one)
+        if ((row < 0) == (column < 0)) {
+            distances[i] = abs(row) > abs(column) ? abs(row) : abs(column);
+        } else {
+            distances[i] = abs(row) + abs(column);
+        }
+        // inserts the cell after every cell no further from the centre
+        for (j = i; j > 0 && distances[solver->cellOrder[j - 1]] >
+                distances[i]; j--) {
+            solver->cellOrder[j] = solver->cellOrder[j - 1];
+        }
+        solver->cellOrder[j] = i;
+    }
+}
+
+/* frees the memory allocated by init_solver
+ *
+ * solver: the solver to be freed
+ *
+ */
+void free_solver(struct Solver* solver) {
+
+    int i;
+
+    for (i = 0; i < SOLVE_LOCKS; i++) {
+        pthread_mutex_destroy(&solver->tableLocks[i]);
+    }
+    pthread_mutex_destroy(&solver->lock);
+    free(solver->table);
+    solver->table = NULL;
+}
+
+/* solves the root position with a thread for each core, and stores the
+ * move which wins it in winningMove (-1 if it is lost)
+ *
+ * when more than one move wins, the move found can depend on which thread
+ * finishes first
+ *
+ * solver: the solver for the position
+ *
+ */
+void solve_root(struct Solver* solver) {
+
+    pthread_t threads[MAX_SOLVE_THREADS];
+    struct SolveThread helpers[MAX_SOLVE_THREADS];
+    struct SolveThread first;
+    int numThreads = 0;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int i;
+
+    solver->solved = 0;
+    solver->winningMove = -1;
+
+    // a thread which cannot be started just leaves the search to the rest
+    while (numThreads < cores - 1 && numThreads < MAX_SOLVE_THREADS) {
+        helpers[numThreads].solver = solver;
+        helpers[numThreads].rootRank = numThreads + 1;
+        if (pthread_create(&threads[numThreads], NULL, solve_worker,
+                &helpers[numThreads]) != 0) {
+            break;
+        }
+        numThreads++;
+    }
+    first.solver = solver;
+    first.rootRank = 0;
+    solve_worker(&first);
+
+    for (i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+/* searches from the root until it has been solved, by this thread or any
+ * other
+ *
+ * arg: the thread doing the search
+ *
+ * returns: NULL
+ *
+ */
+void* solve_worker(void* arg) {
+
+    struct SolveThread* thread = arg;
+    struct Solver* solver = thread->solver;
+    struct SolveBoard root = solver->root;
+    int proof;
+    int disproof;
+
+    trace_worker_start("solver");
+    long long start = stats_start();
+
+    thread->positions = 0;
+    thread->winningMove = -1;
+    solve_node(thread, &root, 0, PN_INFINITY, PN_INFINITY, &proof,
+            &disproof);
+    trace_end("solve", start);
+
+    pthread_mutex_lock(&solver->lock);
+    if (!solver->solved && (proof == 0 || disproof == 0)) {
+        solver->winningMove = thread->winningMove;
+        __atomic_store_n(&solver->solved, 1, __ATOMIC_RELAXED);
+    }
+    solver->positions += thread->positions;
+    pthread_mutex_unlock(&solver->lock);
+    trace_worker_exit();
+    return NULL;
+}
+
+/* searches a position until its proof number reaches proofLimit or its
+ * disproof number reaches disproofLimit (or another thread has solved the
+ * root), always expanding the move which is closest to proving the
+ * position
+ *
+ * thread: the thread doing the search
+ * board: the position to search
+ * depth: the number of moves played since the root
+ * proofLimit, disproofLimit: the limits to search until
+ * proof, disproof: store the proof and disproof numbers of the position
+ *
+ */
+void solve_node(struct SolveThread* thread, struct SolveBoard* board,
+        int depth, int proofLimit, int disproofLimit, int* proof,
+        int* disproof) {
+
+    struct Solver* solver = thread->solver;
+    int moves[MAX_SOLVE_CELLS];
+    int childProofs[MAX_SOLVE_CELLS];
+    int childDisproofs[MAX_SOLVE_CELLS];
+    int numMoves = 0;
+    int result;
+    int i;
+
+    unsigned long long key = board_key(solver, board);
+    thread->positions++;
+
+    unsigned long long candidates = candidate_moves(solver, board, &result);
+    if (result != SOLVE_UNKNOWN) {
+        *proof = (result == SOLVE_WON) ? 0 : PN_INFINITY;
+        *disproof = (result == SOLVE_WON) ? PN_INFINITY : 0;
+        if (depth == 0 && result == SOLVE_WON) {
+            thread->winningMove = __builtin_ctzll(candidates);
+        }
+        store_entry(solver, key, *proof, *disproof);
+        return;
+    }
+    // the moves nearest the centre are tried first
+    for (i = 0; i < solver->size; i++) {
+        if ((candidates & (1ULL << solver->cellOrder[i])) == 0) {
+            continue;
+        }
+        moves[numMoves] = solver->cellOrder[i];
+
+        struct SolveBoard child = *board;
+        place_stone(solver, &child, moves[numMoves]);
+        evaluate_board(solver, &child, &childProofs[numMoves],
+                &childDisproofs[numMoves]);
+        numMoves++;
+    }
+
+    while (1) {
+        // the position is proven by any child which is disproven, and
+        // disproven only once every child is proven
+        *proof = PN_INFINITY;
+        *disproof = 0;
+        for (i = 0; i < numMoves; i++) {
+            if (childDisproofs[i] < *proof) {
+                *proof = childDisproofs[i];
+            }
+            *disproof += childProofs[i];
+            if (*disproof > PN_INFINITY) {
+                *disproof = PN_INFINITY;
+            }
+        }
+        if (*proof >= proofLimit || *disproof >= disproofLimit ||
+                __atomic_load_n(&solver->solved, __ATOMIC_RELAXED)) {
+            break;
+        }
+
+        // the best child is searched until it stops being the best, except
+        // that the helper threads each solve another move at the root
+        int second;
+        int rank = (depth == 0) ? thread->rootRank : 0;
+        int best = choose_child(childDisproofs, numMoves, rank, &second);
+        int childProofLimit = PN_INFINITY;
+        int childDisproofLimit = PN_INFINITY;
+
+        if (best == ERROR) {
+            best = choose_child(childDisproofs, numMoves, 0, &second);
+            rank = 0;
+        }
+        if (rank == 0) {
+            childProofLimit = disproofLimit - *disproof + childProofs[best];
+            childDisproofLimit = (second + 1 < proofLimit) ? second + 1 :
+                    proofLimit;
+            if (childProofLimit > PN_INFINITY) {
+                childProofLimit = PN_INFINITY;
+            }
+        }
+        struct SolveBoard child = *board;
+        place_stone(solver, &child, moves[best]);
+        solve_node(thread, &child, depth + 1, childProofLimit,
+                childDisproofLimit, &childProofs[best], &childDisproofs[best]);
+    }
+    if (depth == 0 && *proof == 0) {
+        for (i = 0; i < numMoves && childDisproofs[i] != 0; i++) {
+        }
+        thread->winningMove = moves[i];
+    }
+    store_entry(solver, key, *proof, *disproof);
+}
+
+/* chooses the child to search next, by its disproof number (the child
+ * closest to being disproven is closest to proving its parent)
+ *
+ * childDisproofs: the disproof number of each child
+ * numMoves: the number of children
+ * rank: 0 for the child with the smallest disproof number, 1 for the next
+ *       smallest and so on (ties are ranked by index)
+ * second: stores the smallest disproof number of any other child
+ *
+ * returns: the index of the child, or ERROR if there are not enough
+ *          unsolved children for the rank
+ *
+ */
+int choose_child(int* childDisproofs, int numMoves, int rank, int* second) {
+
+    int chosen = ERROR;
+    int i;
+    int j;
+
+    for (i = 0; i <= rank; i++) {
+        int next = ERROR;
+        for (j = 0; j < numMoves; j++) {
+            // only children ranked after the one chosen so far are left
+            if (chosen != ERROR && (childDisproofs[j] <
+                    childDisproofs[chosen] || (childDisproofs[j] ==
+                    childDisproofs[chosen] && j <= chosen))) {
+                continue;
+            }
+            if (next == ERROR || childDisproofs[j] < childDisproofs[next]) {
+                next = j;
+            }
+        }
+        if (next == ERROR || childDisproofs[next] >= PN_INFINITY) {
+            return ERROR;
+        }
+        chosen = next;
+    }
+
+    *second = PN_INFINITY;
+    for (j = 0; j < numMoves; j++) {
+        if (j != chosen && childDisproofs[j] < *second) {
+            *second = childDisproofs[j];
+        }
+    }
+    return chosen;
+}
+
+/* gets the proof and disproof numbers of a position which is about to be
+ * searched, from the transposition table if it is there, or from whether
+ * the position is already decided otherwise
+ *
+ * solver: the solver for the position
+ * board: the position
+ * proof, disproof: store the proof and disproof numbers of the position
+ *
+ */
+void evaluate_board(struct Solver* solver, struct SolveBoard* board,
+        int* proof, int* disproof) {
+
+    int result;
+
+    if (lookup_entry(solver, board_key(solver, board), proof, disproof)) {
+        return;
+    }
+    candidate_moves(solver, board, &result);
+    *proof = (result == SOLVE_WON) ? 0 : (result == SOLVE_LOST) ?
+            PN_INFINITY : 1;
+    *disproof = (result == SOLVE_LOST) ? 0 : (result == SOLVE_WON) ?
+            PN_INFINITY : 1;
+}
+
+/* finds the moves which need to be searched from a position
+ *
+ * solver: the solver for the position
+ * board: the position
+ * result: stores SOLVE_WON if the player to move can make a virtual
+ *         connection at once, SOLVE_LOST if the opponent has one already
+ *         (or can make one wherever the player moves, or there are no
+ *         moves left), or SOLVE_UNKNOWN otherwise
+ *
+ * returns: the winning moves if the position is won, and the moves which
+ *          stop every threat of the opponent otherwise
+ *
+ */
+unsigned long long candidate_moves(struct Solver* solver,
+        struct SolveBoard* board, int* result) {
+
+    int player = board->toMove;
+    unsigned long long empty = solver->boardMask &
+            ~(board->stones[0] | board->stones[1]);
+    int connected;
+
+    // (a move which wins at once is found first, as it is the cheapest)
+    unsigned long long wins = winning_cells(solver, board->stones[player],
+            player) & empty;
+    if (wins == 0) {
+        unsigned long long cells = empty;
+        while (cells != 0) {
+            int cell = __builtin_ctzll(cells);
+            unsigned long long carrier;
+
+            cells &= cells - 1;
+            if (virtual_connection(solver, board->stones[player] |
+                    (1ULL << cell), empty & ~(1ULL << cell), player,
+                    &carrier)) {
+                wins |= 1ULL << cell;
+            }
+        }
+    }
+    if (wins != 0) {
+        *result = SOLVE_WON;
+        return wins;
+    }
+
+    unsigned long long moves = must_play(solver, board->stones[1 - player],
+            empty, 1 - player, &connected);
+    if (connected || moves == 0) {
+        *result = SOLVE_LOST;
+        return 0;
+    }
+    *result = SOLVE_UNKNOWN;
+    return moves;
+}
+
+/* finds the cells a player has to play in to stop every threat of the
+ * opponent to make a virtual connection (helper method to candidate_moves)
+ *
+ * solver: the solver for the position
+ * stones: the opponent's stones
+ * empty: the empty cells
+ * player: the opponent (0 for O, 1 for X)
+ * connected: stores 1 if the opponent already has a virtual connection,
+ *            0 otherwise
+ *
+ * returns: the empty cells in the carrier (or the cell) of every threat
+ *
+ */
+unsigned long long must_play(struct Solver* solver,
+        unsigned long long stones, unsigned long long empty, int player,
+        int* connected) {
+
+    unsigned long long moves = empty;
+    unsigned long long cells = empty;
+    unsigned long long carrier;
+
+    *connected = virtual_connection(solver, stones, empty, player, &carrier);
+    while (cells != 0 && moves != 0 && !*connected) {
+        int cell = __builtin_ctzll(cells);
+
+        cells &= cells - 1;
+        if (virtual_connection(solver, stones | (1ULL << cell),
+                empty & ~(1ULL << cell), player, &carrier)) {
+            moves &= carrier | (1ULL << cell);
+        }
+    }
+    return moves;
+}
+
+/* checks whether a player's stones are virtually connected between their
+ * edges, joining the groups of stones reached from the first edge to any
+ * others a bridge or an edge template away until the last edge is reached
+ *
+ * solver: the solver for the position
+ * stones: the player's stones
+ * empty: the empty cells
+ * player: 0 for O, 1 for X
+ * carrier: stores the empty cells the connection depends on
+ *
+ * returns: 1 if the stones are virtually connected, 0 otherwise
+ *
+ */
+int virtual_connection(struct Solver* solver, unsigned long long stones,
+        unsigned long long empty, int player, unsigned long long* carrier) {
+
+    unsigned long long first = (player == 0) ? solver->firstColumn :
+            solver->firstRow;
+    unsigned long long last = (player == 0) ? solver->lastColumn :
+            solver->lastRow;
+    unsigned long long reach = flood(solver, stones & first, stones);
+    int joined = 1;
+
+    *carrier = 0;
+    while (joined) {
+        unsigned long long others = stones & ~reach;
+        unsigned long long used;
+
+        if ((reach & last) != 0) {
+            return 1;
+        }
+        // the last edge is a template away from a stone which is reached
+        unsigned long long cells = reach;
+        while (cells != 0) {
+            int cell = __builtin_ctzll(cells);
+
+            cells &= cells - 1;
+            if (edge_template(solver, cell, last, empty & ~*carrier,
+                    &used)) {
+                *carrier |= used;
+                return 1;
+            }
+        }
+
+        // joins the first other group found to be a template or a bridge
+        // away from what has been reached
+        joined = 0;
+        while (others != 0 && !joined) {
+            int cell = __builtin_ctzll(others);
+
+            others &= others - 1;
+            if (edge_template(solver, cell, first, empty & ~*carrier,
+                    &used) || find_bridge(solver, cell, reach,
+                    empty & ~*carrier, &used)) {
+                *carrier |= used;
+                reach |= flood(solver, 1ULL << cell, stones);
+                joined = 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* checks whether a stone is joined to an edge by an edge template (helper
+ * method to virtual_connection)
+ *
+ * solver: the solver for the position
+ * cell: the stone's cell
+ * edge: the cells of the edge
+ * free: the empty cells which no other part of the connection uses
+ * carrier: stores the two cells of the edge the template uses
+ *
+ * returns: 1 if the stone is joined to the edge, 0 otherwise
+ *
+ */
+int edge_template(struct Solver* solver, int cell, unsigned long long edge,
+        unsigned long long free, unsigned long long* carrier) {
+
+    unsigned long long cells = solver->neighbours[cell] & edge;
+
+    if ((edge & (1ULL << cell)) != 0 || __builtin_popcountll(cells) != 2 ||
+            (cells & free) != cells) {
+        return 0;
+    }
+    *carrier = cells;
+    return 1;
+}
+
+/* checks whether a stone is a bridge away from a stone which has been
+ * reached (helper method to virtual_connection)
+ *
+ * solver: the solver for the position
+ * cell: the stone's cell
+ * reach: the stones which have been reached
+ * free: the empty cells which no other part of the connection uses
+ * carrier: stores the two cells the bridge uses
+ *
+ * returns: 1 if there is a bridge, 0 otherwise
+ *
+ */
+int find_bridge(struct Solver* solver, int cell, unsigned long long reach,
+        unsigned long long free, unsigned long long* carrier) {
+
+    unsigned long long ends = solver->bridges[cell] & reach;
+
+    while (ends != 0) {
+        int end = __builtin_ctzll(ends);
+        unsigned long long cells = solver->neighbours[cell] &
+                solver->neighbours[end];
+
+        ends &= ends - 1;
+        if ((cells & free) == cells) {
+            *carrier = cells;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* finds the cells where a stone would connect a player's two edges
+ *
+ * solver: the solver for the position
+ * stones: the player's stones
+ * player: 0 for O, 1 for X
+ *
+ * returns: the cells which join the stones reaching each edge (including
+ *          cells which are already taken)
+ *
+ */
+unsigned long long winning_cells(struct Solver* solver,
+        unsigned long long stones, int player) {
+
+    unsigned long long first = (player == 0) ? solver->firstColumn :
+            solver->firstRow;
+    unsigned long long last = (player == 0) ? solver->lastColumn :
+            solver->lastRow;
+
+    unsigned long long fromFirst = flood(solver, stones & first, stones);
+    unsigned long long fromLast = flood(solver, stones & last, stones);
+    return (spread(solver, fromFirst) | first) &
+            (spread(solver, fromLast) | last);
+}
+
+/* grows a set of stones to every stone connected to it
+ *
+ * solver: the solver for the position
+ * reach: the stones to start from
+ * stones: the stones which can be reached
+ *
+ * returns: the stones connected to reach
+ *
+ */
+unsigned long long flood(struct Solver* solver, unsigned long long reach,
+        unsigned long long stones) {
+
+    while (1) {
+        unsigned long long grown = (reach | spread(solver, reach)) & stones;
+        if (grown == reach) {
+            return reach;
+        }
+        reach = grown;
+    }
+}
+
+/* finds the neighbours of a set of cells
+ *
+ * solver: the solver for the position
+ * cells: the cells to find the neighbours of
+ *
+ * returns: every cell next to one of cells
+ *
+ */
+unsigned long long spread(struct Solver* solver, unsigned long long cells) {
+
+    int width = solver->width;
+    unsigned long long notLast = cells & ~solver->lastColumn;
+    unsigned long long notFirst = cells & ~solver->firstColumn;
+    unsigned long long neighbours = (notLast << 1) | (notFirst >> 1);
+
+    // (shifting by the whole width of the bitboard is undefined, and a
+    // board one row high has no rows to shift into anyway)
+    if (width < 64) {
+        neighbours |= (cells << width) | (cells >> width);
+    }
+    if (width + 1 < 64) {
+        neighbours |= (notLast << (width + 1)) | (notFirst >> (width + 1));
+    }
+    return neighbours & solver->boardMask;
+}
+
+/* checks whether a player's stones connect their two edges
+ *
+ * solver: the solver for the position
+ * stones: the player's stones
+ * player: 0 for O, 1 for X
+ *
+ * returns: 1 if the player has won, 0 otherwise
+ *
+ */
+int has_connected(struct Solver* solver, unsigned long long stones,
+        int player) {
+
+    unsigned long long first = (player == 0) ? solver->firstColumn :
+            solver->firstRow;
+    unsigned long long last = (player == 0) ? solver->lastColumn :
+            solver->lastRow;
+
+    return (flood(solver, stones & first, stones) & last) != 0;
+}
+
+/* places a stone for the player to move, then passes the turn
+ *
+ * solver: the solver for the position
+ * board: the position to play the move on
+ * cell: the cell to place the stone on
+ *
+ */
+void place_stone(struct Solver* solver, struct SolveBoard* board, int cell) {
+
+    int player = board->toMove;
+    int i;
+
+    board->stones[player] |= 1ULL << cell;
+    for (i = 0; i < solver->numTransforms; i++) {
+        board->hashes[i] ^= solver->keys[solver->cellMaps[i][cell]]
+                [solver->swapsPlayers[i] ? 1 - player : player];
+    }
+    board->toMove = 1 - player;
+}
+
+/* gets the key of a position in the transposition table, which is the same
+ * for every position symmetric to it
+ *
+ * solver: the solver for the position
+ * board: the position
+ *
+ * returns: the smallest hash of the position under the board's symmetries
+ *
+ */
+unsigned long long board_key(struct Solver* solver,
+        struct SolveBoard* board) {
+
+    unsigned long long key = ~0ULL;
+    int i;
+
+    for (i = 0; i < solver->numTransforms; i++) {
+        unsigned long long hash = board->hashes[i] ^ solver->sideKeys[
+                solver->swapsPlayers[i] ? 1 - board->toMove : board->toMove];
+        if (hash < key) {
+            key = hash;
+        }
+    }
+    return key;
+}
+
+/* reads a position's proof and disproof numbers from the transposition
+ * table
+ *
+ * solver: the solver for the position
+ * key: the position's key
+ * proof, disproof: store the proof and disproof numbers of the position
+ *
+ * returns: 1 if the position was in the table, 0 otherwise
+ *
+ */
+int lookup_entry(struct Solver* solver, unsigned long long key, int* proof,
+        int* disproof) {
+
+    int index = key & ((1 << SOLVE_TABLE_BITS) - 1);
+    struct SolveEntry* entry = &solver->table[index];
+    int found = 0;
+
+    pthread_mutex_lock(&solver->tableLocks[index % SOLVE_LOCKS]);
+    // (an empty entry has both numbers 0, which no position can have)
+    if (entry->key == key && (entry->proof != 0 || entry->disproof != 0)) {
+        *proof = entry->proof;
+        *disproof = entry->disproof;
+        found = 1;
+    }
+    pthread_mutex_unlock(&solver->tableLocks[index % SOLVE_LOCKS]);
+    return found;
+}
+
+/* writes a position's proof and disproof numbers to the transposition
+ * table, replacing whatever was there unless it was a different position
+ * which has been solved
+ *
+ * solver: the solver for the position
+ * key: the position's key
+ * proof, disproof: the proof and disproof numbers of the position
+ *
+ */
+void store_entry(struct Solver* solver, unsigned long long key, int proof,
+        int disproof) {
+
+    int index = key & ((1 << SOLVE_TABLE_BITS) - 1);
+    struct SolveEntry* entry = &solver->table[index];
+
+    pthread_mutex_lock(&solver->tableLocks[index % SOLVE_LOCKS]);
+    if (entry->key == key || (entry->proof < PN_INFINITY &&
+            entry->disproof < PN_INFINITY)) {
+        entry->key = key;
+        entry->proof = proof;
+        entry->disproof = disproof;
+    }
+    pthread_mutex_unlock(&solver->tableLocks[index % SOLVE_LOCKS]);
+}
@@ -0,0 +1,162 @@
+/*
+ * solve.h
+ *
+ * structs and function prototypes for solve.c
+ *
+ */
+
+#ifndef SOLVE_H_
+#define SOLVE_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+#include "symmetry.h"
+
+/* the most cells a board can have to be solved (one bit for each) */
+#define MAX_SOLVE_CELLS 64
+
+/* the number of entries in the transposition table, as a power of 2 */
+#define SOLVE_TABLE_BITS 21
+
+/* the number of locks the entries of the transposition table are shared
+ * between */
+#define SOLVE_LOCKS 1024
+
+/* the most threads solving a position at once */
+#define MAX_SOLVE_THREADS 64
+
+/* a proof or disproof number which can never be reached */
+#define PN_INFINITY 100000000
+
+/* the seed of the keys for hashing positions */
+#define SOLVE_SEED 0x5851F42D4C957F2DULL
+
+/* the results of checking a position before searching it */
+#define SOLVE_UNKNOWN 0
+#define SOLVE_WON 1
+#define SOLVE_LOST 2
+
+/* Represents a position in the transposition table, with its proof number
+ * (how many more positions must be proven won for the player to move before
+ * it is) and its disproof number (the same, for it being lost) */
+struct SolveEntry {
+    unsigned long long key;
+    int proof;
+    int disproof;
+};
+
+/* Represents a position being searched, as a bitboard of each player's
+ * stones (bit row * width + column), with its hash under every symmetry */
+struct SolveBoard {
+    unsigned long long stones[2];
+    int toMove;
+    unsigned long long hashes[MAX_TRANSFORMS];
+};
+
+/* Represents the search for the value of a position, shared between the
+ * threads searching it
+ *
+ * the neighbours of each cell, and the cells a bridge away from it (cells
+ * which share exactly two neighbours with it), are kept for finding virtual
+ * connections
+ *
+ * every thread searches from the root, sharing what it finds through the
+ * transposition table, but each thread after the first starts from a
+ * different move at the root so that they do not all repeat the same
+ * search; the search is over once any thread has solved the root */
+struct Solver {
+    int height;
+    int width;
+    int size;
+    int numTransforms;
+    unsigned long long boardMask;
+    unsigned long long firstColumn;
+    unsigned long long lastColumn;
+    unsigned long long firstRow;
+    unsigned long long lastRow;
+    unsigned long long neighbours[MAX_SOLVE_CELLS];
+    unsigned long long bridges[MAX_SOLVE_CELLS];
+    unsigned long long keys[MAX_SOLVE_CELLS][2];
+    unsigned long long sideKeys[2];
+    int cellMaps[MAX_TRANSFORMS][MAX_SOLVE_CELLS];
+    int swapsPlayers[MAX_TRANSFORMS];
+    int cellOrder[MAX_SOLVE_CELLS];
+    struct SolveEntry* table;
+    pthread_mutex_t tableLocks[SOLVE_LOCKS];
+    struct SolveBoard root;
+    int solved;
+    int winningMove;
+    long positions;
+    pthread_mutex_t lock;
+};
+
+/* Represents one thread of a search, with the rank (by disproof number) of
+ * the moves it searches at the root, and the winning move it found there */
+struct SolveThread {
+    struct Solver* solver;
+    int rootRank;
+    int winningMove;
+    long positions;
+};
+
+int solve_game(struct Game* game, int argc, char** argv);
+
+int init_solver(struct Solver* solver, struct Game* game);
+
+void sort_cells(struct Solver* solver);
+
+void free_solver(struct Solver* solver);
+
+void solve_root(struct Solver* solver);
+
+void* solve_worker(void* arg);
+
+void solve_node(struct SolveThread* thread, struct SolveBoard* board,
+        int depth, int proofLimit, int disproofLimit, int* proof,
+        int* disproof);
+
+int choose_child(int* childDisproofs, int numMoves, int rank, int* second);
+
+void evaluate_board(struct Solver* solver, struct SolveBoard* board,
+        int* proof, int* disproof);
+
+unsigned long long candidate_moves(struct Solver* solver,
+        struct SolveBoard* board, int* result);
+
+unsigned long long must_play(struct Solver* solver,
+        unsigned long long stones, unsigned long long empty, int player,
+        int* connected);
+
+int virtual_connection(struct Solver* solver, unsigned long long stones,
+        unsigned long long empty, int player, unsigned long long* carrier);
+
+int edge_template(struct Solver* solver, int cell, unsigned long long edge,
+        unsigned long long free, unsigned long long* carrier);
+
+int find_bridge(struct Solver* solver, int cell, unsigned long long reach,
+        unsigned long long free, unsigned long long* carrier);
+
+unsigned long long winning_cells(struct Solver* solver,
+        unsigned long long stones, int player);
+
+unsigned long long flood(struct Solver* solver, unsigned long long reach,
+        unsigned long long stones);
+
+unsigned long long spread(struct Solver* solver, unsigned long long cells);
+
+int has_connected(struct Solver* solver, unsigned long long stones,
+        int player);
+
+void place_stone(struct Solver* solver, struct SolveBoard* board, int cell);
+
+unsigned long long board_key(struct Solver* solver,
+        struct SolveBoard* board);
+
+int lookup_entry(struct Solver* solver, unsigned long long key, int* proof,
+        int* disproof);
+
+void store_entry(struct Solver* solver, unsigned long long key, int proof,
+        int disproof);
+
+#endif /* SOLVE_H_ */
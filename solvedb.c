@@ -0,0 +1,293 @@
+/*
+ * solvedb.c
+ *
+ * keeps a database of solved positions on disk (--db=file), so that the
+ * solver and engine players can use a position's value without searching
+ * for it again
+ *
+ * positions are stored under their canonical key (see symmetry.c), so a
+ * record also answers every position symmetric to it, and records are
+ * written in the machine's own byte order
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "solvedb.h"
+#include "solve.h"
+#include "symmetry.h"
+#include "gameIO.h"
+
+/* the database of solved positions, if one was given */
+struct SolvedDb solvedDb;
+
+/* opens a database of solved positions, creating it if it does not exist,
+ * and maps the records already in it
+ *
+ * fileName: the database file
+ *
+ * error conditions: unable to open the file, invalid file contents, or
+ *                   unable to allocate the index
+ *
+ */
+void init_solved_db(char* fileName) {
+
+    struct stat info;
+    long i;
+
+    memset(&solvedDb, 0, sizeof(struct SolvedDb));
+    solvedDb.fd = open(fileName, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (solvedDb.fd == -1 || fstat(solvedDb.fd, &info) == -1) {
+        exit_with_error("Could not open solved database", 4);
+    }
+
+    // a new database is just its magic number
+    if (info.st_size == 0) {
+        if (write(solvedDb.fd, DB_MAGIC, DB_MAGIC_LENGTH) !=
+                DB_MAGIC_LENGTH) {
+            exit_with_error("Could not open solved database", 4);
+        }
+        info.st_size = DB_MAGIC_LENGTH;
+    }
+    if (info.st_size < DB_MAGIC_LENGTH || (info.st_size - DB_MAGIC_LENGTH) %
+            sizeof(struct DbRecord) != 0) {
+        exit_with_error("Incorrect solved database contents", 5);
+    }
+    solvedDb.mappingSize = info.st_size;
+    solvedDb.mapping = mmap(NULL, solvedDb.mappingSize, PROT_READ,
+            MAP_SHARED, solvedDb.fd, 0);
+    if (solvedDb.mapping == MAP_FAILED ||
+            memcmp(solvedDb.mapping, DB_MAGIC, DB_MAGIC_LENGTH) != 0) {
+        exit_with_error("Incorrect solved database contents", 5);
+    }
+    solvedDb.records = (struct DbRecord*)((char*)solvedDb.mapping +
+            DB_MAGIC_LENGTH);
+    solvedDb.numRecords = (info.st_size - DB_MAGIC_LENGTH) /
+            sizeof(struct DbRecord);
+
+    // the index starts at least half empty
+    solvedDb.numSlots = MIN_DB_SLOTS;
+    while (solvedDb.numSlots < solvedDb.numRecords * 2) {
+        solvedDb.numSlots *= 2;
+    }
+    solvedDb.slots = malloc(sizeof(long) * solvedDb.numSlots);
+    solvedDb.added = malloc(sizeof(struct DbRecord) * INITIAL_DB_RECORDS);
+    if (solvedDb.slots == NULL || solvedDb.added == NULL) {
+        exit_with_error("Unable to load solved database", 7);
+    }
+    solvedDb.maxAdded = INITIAL_DB_RECORDS;
+    for (i = 0; i < solvedDb.numSlots; i++) {
+        solvedDb.slots[i] = ERROR;
+    }
+    for (i = 0; i < solvedDb.numRecords; i++) {
+        index_record(i);
+    }
+    pthread_mutex_init(&solvedDb.lock, NULL);
+    solvedDb.enabled = 1;
+
+    atexit(close_solved_db);
+}
+
+/* unmaps and closes the database of solved positions
+ * (called when the program exits)
+ *
+ */
+void close_solved_db(void) {
+
+    if (!solvedDb.enabled) {
+        return;
+    }
+    munmap(solvedDb.mapping, solvedDb.mappingSize);
+    close(solvedDb.fd);
+    free(solvedDb.added);
+    free(solvedDb.slots);
+    pthread_mutex_destroy(&solvedDb.lock);
+    solvedDb.enabled = 0;
+}
+
+/* looks up the position of a game in the database of solved positions
+ *
+ * game: stores information on the current game
+ * grid: the game grid
+ * move: stores the winning move, if the player to move wins
+ *
+ * returns: SOLVE_WON or SOLVE_LOST for the player to move if the position
+ *          has been solved, SOLVE_UNKNOWN otherwise (or if there is no
+ *          database)
+ *
+ */
+int db_lookup(struct Game* game, char** grid, int* move) {
+
+    int transform;
+    int cell[2];
+    int value = SOLVE_UNKNOWN;
+
+    if (!solvedDb.enabled) {
+        return SOLVE_UNKNOWN;
+    }
+    unsigned long long key = canonical_key(game, grid, &transform);
+
+    pthread_mutex_lock(&solvedDb.lock);
+    long number = find_record(key);
+    if (number != ERROR) {
+        struct DbRecord* record = get_record(number);
+        value = record->value;
+
+        // the move is mapped back out of the canonical frame
+        if (value == SOLVE_WON) {
+            cell[0] = record->move / game->width;
+            cell[1] = record->move % game->width;
+            transform_cell(game, transform, cell, move);
+        }
+    }
+    pthread_mutex_unlock(&solvedDb.lock);
+    return value;
+}
+
+/* adds a solved position to the database (unless it is already there)
+ *
+ * game: stores information on the current game
+ * grid: the game grid
+ * value: SOLVE_WON or SOLVE_LOST for the player to move
+ * move: the winning move, if the player to move wins
+ *
+ */
+void db_record(struct Game* game, char** grid, int value, int* move) {
+
+    struct DbRecord record;
+    int transform;
+    int cell[2];
+
+    if (!solvedDb.enabled) {
+        return;
+    }
+    record.key = canonical_key(game, grid, &transform);
+    record.value = value;
+    record.move = -1;
+    if (value == SOLVE_WON) {
+        transform_cell(game, transform, move, cell);
+        record.move = cell[0] * game->width + cell[1];
+    }
+
+    pthread_mutex_lock(&solvedDb.lock);
+    if (find_record(record.key) == ERROR) {
+        if (solvedDb.numAdded == solvedDb.maxAdded) {
+            struct DbRecord* larger = realloc(solvedDb.added,
+                    sizeof(struct DbRecord) * solvedDb.maxAdded * 2);
+            if (larger == NULL) {
+                pthread_mutex_unlock(&solvedDb.lock);
+                return;
+            }
+            solvedDb.added = larger;
+            solvedDb.maxAdded *= 2;
+        }
+        // the record is only kept if it reached the file
+        if (write(solvedDb.fd, &record, sizeof(struct DbRecord)) ==
+                sizeof(struct DbRecord)) {
+            solvedDb.added[solvedDb.numAdded] = record;
+            index_record(solvedDb.numRecords + solvedDb.numAdded);
+            solvedDb.numAdded++;
+        }
+    }
+    pthread_mutex_unlock(&solvedDb.lock);
+}
+
+/* gets a record by its number
+ *
+ * number: the number of the record (the mapped records come first)
+ *
+ * returns: the record
+ *
+ */
+struct DbRecord* get_record(long number) {
+
+    if (number < solvedDb.numRecords) {
+        return &solvedDb.records[number];
+    }
+    return &solvedDb.added[number - solvedDb.numRecords];
+}
+
+/* finds the record for a position in the index
+ *
+ * key: the canonical key of the position
+ *
+ * returns: the number of the record, or ERROR if there is none
+ *
+ */
+long find_record(unsigned long long key) {
+
+    long slot = key & (solvedDb.numSlots - 1);
+
+    while (solvedDb.slots[slot] != ERROR) {
+        if (get_record(solvedDb.slots[slot])->key == key) {
+            return solvedDb.slots[slot];
+        }
+        slot = (slot + 1) & (solvedDb.numSlots - 1);
+    }
+    return ERROR;
+}
+
+/* adds a record to the index, growing the index first if it would be more
+ * than half full
+ *
+ * number: the number of the record
+ *
+ * returns: SUCCESS if the record was indexed, ERROR if the index could not
+ *          be grown
+ *
+ */
+int index_record(long number) {
+
+    if ((solvedDb.numRecords + solvedDb.numAdded + 1) * 2 >
+            solvedDb.numSlots && grow_index() == ERROR) {
+        return ERROR;
+    }
+    long slot = get_record(number)->key & (solvedDb.numSlots - 1);
+
+    while (solvedDb.slots[slot] != ERROR) {
+        slot = (slot + 1) & (solvedDb.numSlots - 1);
+    }
+    solvedDb.slots[slot] = number;
+    return SUCCESS;
+}
+
+/* doubles the size of the index, putting every record back into it
+ * (helper method to index_record)
+ *
+ * returns: SUCCESS if the index was grown, ERROR otherwise
+ *
+ */
+int grow_index(void) {
+
+    long* oldSlots = solvedDb.slots;
+    long oldNumSlots = solvedDb.numSlots;
+    long i;
+
+    solvedDb.slots = malloc(sizeof(long) * oldNumSlots * 2);
+    if (solvedDb.slots == NULL) {
+        solvedDb.slots = oldSlots;
+        return ERROR;
+    }
+    solvedDb.numSlots = oldNumSlots * 2;
+    for (i = 0; i < solvedDb.numSlots; i++) {
+        solvedDb.slots[i] = ERROR;
+    }
+    for (i = 0; i < oldNumSlots; i++) {
+        if (oldSlots[i] != ERROR) {
+            long slot = get_record(oldSlots[i])->key &
+                    (solvedDb.numSlots - 1);
+            while (solvedDb.slots[slot] != ERROR) {
+                slot = (slot + 1) & (solvedDb.numSlots - 1);
+            }
+            solvedDb.slots[slot] = oldSlots[i];
+        }
+    }
+    free(oldSlots);
+    return SUCCESS;
+}
@@ -0,0 +1,70 @@
+/*
+ * solvedb.h
+ *
+ * structs and function prototypes for solvedb.c
+ *
+ */
+
+#ifndef SOLVEDB_H_
+#define SOLVEDB_H_
+
+#include <pthread.h>
+
+#include "structs.h"
+
+/* the first bytes of every database file */
+#define DB_MAGIC "BOBSOLV1"
+#define DB_MAGIC_LENGTH 8
+
+/* the number of records the records added while running start with room
+ * for, and the smallest index */
+#define INITIAL_DB_RECORDS 64
+#define MIN_DB_SLOTS 1024
+
+/* Represents one solved position, stored in its canonical frame: the cell
+ * (row * width + column) of a winning move, or -1 if the player to move
+ * loses, and SOLVE_WON or SOLVE_LOST */
+struct DbRecord {
+    unsigned long long key;
+    int move;
+    int value;
+};
+
+/* Represents the database of solved positions
+ *
+ * the records already in the file are mapped read-only, and new records
+ * are appended to the file and also kept in memory; every record is found
+ * through an index of record numbers (numbered after the mapped records
+ * for the added ones), which is built when the database is opened */
+struct SolvedDb {
+    int enabled;
+    int fd;
+    void* mapping;
+    size_t mappingSize;
+    struct DbRecord* records;
+    long numRecords;
+    struct DbRecord* added;
+    long numAdded;
+    long maxAdded;
+    long* slots;
+    long numSlots;
+    pthread_mutex_t lock;
+};
+
+void init_solved_db(char* fileName);
+
+void close_solved_db(void);
+
+int db_lookup(struct Game* game, char** grid, int* move);
+
+void db_record(struct Game* game, char** grid, int value, int* move);
+
+struct DbRecord* get_record(long number);
+
+long find_record(unsigned long long key);
+
+int index_record(long number);
+
+int grow_index(void);
+
+#endif /* SOLVEDB_H_ */
@@ -0,0 +1,241 @@
+/*
+ * stats.c
+ *
+ * records per-move statistics for a game of hex (--stats), and writes them
+ * out as a JSON summary when the program exits
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+#include "trace.h"
+
+/* the statistics for the game being played */
+struct Stats stats;
+
+/* allocations made through the wrapped malloc, calloc and realloc (the
+ * linker sends every call in bob's code through the __wrap_ versions) */
+unsigned long long allocations = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t number, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t number, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __real_calloc(number, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __real_realloc(pointer, size);
+}
+
+/* the names of the metrics in the JSON summary */
+char* statNames[NUM_STATS] = {
+    "input_read_ns",
+    "input_parse_ns",
+    "move_generation_ns",
+    "win_check_ns",
+    "render_ns",
+    "cells_visited",
+    "auto_probes",
+    "allocations"
+};
+
+/* starts recording statistics, which are written out when the program
+ * exits
+ *
+ * fileName: the file to write the summary to, or NULL to use stderr
+ *
+ */
+void init_stats(char* fileName) {
+
+    memset(&stats, 0, sizeof(struct Stats));
+    stats.enabled = 1;
+    stats.fileName = fileName;
+    stats.allocationsAtStart = allocation_count();
+
+    atexit(stats_report);
+}
+
+/* gets the start time of a timed section (shared with the spans in trace.c)
+ *
+ * returns: the current time (ns), or 0 if neither statistics nor a trace
+ *          are being recorded
+ *
+ */
+long long stats_start(void) {
+
+    if (!stats.enabled && !trace_enabled()) {
+        return 0;
+    }
+    return monotonic_ns();
+}
+
+/* adds the time since start to a timed metric for the current move
+ *
+ * metric: the metric being timed (one of the STAT_ constants)
+ * start: the start time given by stats_start
+ *
+ */
+void stats_stop(int metric, long long start) {
+
+    if (!stats.enabled) {
+        return;
+    }
+    stats.current[metric] += monotonic_ns() - start;
+}
+
+/* adds to a counted metric for the current move
+ *
+ * metric: the metric being counted (one of the STAT_ constants)
+ * amount: the amount to add
+ *
+ */
+void stats_count(int metric, unsigned long long amount) {
+
+    if (!stats.enabled) {
+        return;
+    }
+    stats.current[metric] += amount;
+}
+
+/* records the metrics for a move which has just been completed, and starts
+ * recording the next move
+ *
+ */
+void stats_end_move(void) {
+
+    int i;
+
+    if (!stats.enabled) {
+        return;
+    }
+    unsigned long long allocated = allocation_count();
+    stats.current[STAT_ALLOCATIONS] = allocated - stats.allocationsAtStart;
+    stats.allocationsAtStart = allocated;
+
+    for (i = 0; i < NUM_STATS; i++) {
+        record_value(&stats.metrics[i], stats.current[i]);
+        stats.current[i] = 0;
+    }
+    stats.moves++;
+}
+
+/* adds the value of a metric for one move to its total and histogram
+ *
+ * metric: the metric being recorded
+ * value: the value for the move
+ *
+ */
+void record_value(struct Metric* metric, unsigned long long value) {
+
+    int bucket = 0;
+
+    // bucket n holds the values from 2^(n-1) to 2^n - 1 (bucket 0 holds 0)
+    while (bucket < NUM_BUCKETS - 1 && (value >> bucket) != 0) {
+        bucket++;
+    }
+    metric->buckets[bucket]++;
+    metric->total += value;
+    if (value > metric->max) {
+        metric->max = value;
+    }
+}
+
+/* writes the JSON summary of every metric (called when the program exits)
+ *
+ */
+void stats_report(void) {
+
+    FILE* file = stderr;
+    int i;
+
+    if (stats.fileName != NULL) {
+        file = fopen(stats.fileName, "w");
+        if (file == NULL) {
+            fprintf(stderr, "%s\n", "Unable to write stats");
+            return;
+        }
+    }
+
+    fprintf(file, "{\n  \"moves\": %ld,\n  \"metrics\": {\n", stats.moves);
+    for (i = 0; i < NUM_STATS; i++) {
+        write_metric(file, statNames[i], &stats.metrics[i], stats.moves);
+        fprintf(file, "%s\n", i < NUM_STATS - 1 ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+
+    if (file != stderr) {
+        fclose(file);
+    }
+}
+
+/* writes the JSON summary of a single metric (helper method to
+ * stats_report)
+ *
+ * file: the file to write to
+ * name: the name of the metric
+ * metric: the metric to be written
+ * moves: the number of moves which have been recorded
+ *
+ */
+void write_metric(FILE* file, char* name, struct Metric* metric,
+        long moves) {
+
+    int i;
+    int first = 1;
+
+    fprintf(file, "    \"%s\": {\"total\": %llu, \"mean\": %.1f, "
+            "\"max\": %llu, \"histogram\": [", name, metric->total,
+            moves > 0 ? (double)metric->total / moves : 0.0, metric->max);
+
+    // only buckets with values in them are written, each labelled with the
+    // largest value it can hold
+    for (i = 0; i < NUM_BUCKETS; i++) {
+        if (metric->buckets[i] == 0) {
+            continue;
+        }
+        unsigned long long limit = (i == 0) ? 0 : (1ULL << i) - 1;
+        if (i == NUM_BUCKETS - 1) {
+            limit = ~0ULL;
+        }
+        fprintf(file, "%s{\"le\": %llu, \"count\": %llu}",
+                first ? "" : ", ", limit, metric->buckets[i]);
+        first = 0;
+    }
+    fprintf(file, "]}");
+}
+
+/* gets the number of allocations made so far
+ *
+ * returns: the number of calls to malloc, calloc and realloc
+ *
+ */
+unsigned long long allocation_count(void) {
+
+    return __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+}
+
+/* gets the time from a monotonic clock
+ *
+ * returns: the current time in ns
+ *
+ */
+long long monotonic_ns(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
@@ -0,0 +1,65 @@
+/*
+ * stats.h
+ *
+ * structs and function prototypes for stats.c
+ *
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdio.h>
+
+/* the per-move metrics which are recorded */
+#define STAT_INPUT_READ 0
+#define STAT_INPUT_PARSE 1
+#define STAT_MOVE_GENERATION 2
+#define STAT_WIN_CHECK 3
+#define STAT_RENDER 4
+#define STAT_CELLS_VISITED 5
+#define STAT_AUTO_PROBES 6
+#define STAT_ALLOCATIONS 7
+
+#define NUM_STATS 8
+
+/* values are sorted into buckets by their highest set bit */
+#define NUM_BUCKETS 64
+
+/* Represents the values of one metric over every move in the game */
+struct Metric {
+    unsigned long long total;
+    unsigned long long max;
+    unsigned long long buckets[NUM_BUCKETS];
+};
+
+/* Represents the statistics recorded while a game is played */
+struct Stats {
+    int enabled;
+    char* fileName;
+    long moves;
+    unsigned long long current[NUM_STATS];
+    unsigned long long allocationsAtStart;
+    struct Metric metrics[NUM_STATS];
+};
+
+void init_stats(char* fileName);
+
+long long stats_start(void);
+
+void stats_stop(int metric, long long start);
+
+void stats_count(int metric, unsigned long long amount);
+
+void stats_end_move(void);
+
+void record_value(struct Metric* metric, unsigned long long value);
+
+void stats_report(void);
+
+void write_metric(FILE* file, char* name, struct Metric* metric, long moves);
+
+unsigned long long allocation_count(void);
+
+long long monotonic_ns(void);
+
+#endif /* STATS_H_ */
@@ -20,12 +20,68 @@
 #define O_CONNECTER 1
 #define X_CONNECTER 2
 
+struct Engine;
+struct Position;
+
+/* Represents the time limits for an engine player (all times in ms) */
+struct TimeControl {
+    long moveTime;
+    long remaining;
+    long increment;
+};
+
+/* Represents the options given to the program before its arguments */
+struct Options {
+    struct TimeControl clock;
+    int maxPlayouts;
+    int patterns;
+    int noPonder;
+    int stats;
+    char* statsFile;
+    char* traceFile;
+    char* replayFile;
+    int prefixStats;
+    int htp;
+    long batchGames;
+    int solve;
+    char* dbFile;
+    long selfPlayGames;
+    char* dumpFile;
+    long matchGames;
+    double sprtElo0;
+    double sprtElo1;
+    int sprtGiven;
+    int ansiDisplay;
+    int layout;
+    int hideDisplay;
+    char* publishName;
+    char* watchName;
+    int check;
+    int fastForward;
+    char* memoFile;
+};
+
 /* Represents a player within the game */
 struct Player {
     int hasNextMove;
     int moveNumber;
     char type;
     char playerSymbol;
+    struct Engine* engine;
+};
+
+/* the size of the first block of input read from the user */
+#define INPUT_BUFFER_SIZE 65536
+
+/* Represents input which has been read from the user but not yet used, as
+ * the characters from start to end of data */
+struct InputBuffer {
+    char* data;
+    int capacity;
+    int start;
+    int end;
+    int scan;
+    int afterSeparator;
 };
 
 /* Represents a game of hex */
@@ -38,6 +94,9 @@ struct Game {
     int checkEOF;
     struct Player* player1;
     struct Player* player2;
+    struct Position* position;
+    int** gridRefs;
+    int** connectionRefs;
 };
 
 #endif /* STRUCTS_H_ */
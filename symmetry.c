@@ -0,0 +1,253 @@
+/*
+ * symmetry.c
+ *
+ * maps positions in a game of hex onto a single canonical representative,
+ * so that symmetric positions can share hash, book and database entries
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symmetry.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+/* gets the number of symmetries which apply to the board of a game
+ *
+ * game: stores information on the current game
+ *
+ * returns: 4 for square boards (both rotations and both transposes), and 2
+ *          for all other boards (the identity and the 180 degree rotation)
+ *
+ */
+int num_transforms(struct Game* game) {
+
+    if (game->height == game->width) {
+        return MAX_TRANSFORMS;
+    }
+    return 2;
+}
+
+/* maps a grid position through one of the board symmetries
+ * (every transform is its own inverse, so the same call also maps a
+ * transformed position back again)
+ *
+ * game: stores information on the current game
+ * transform: the symmetry to apply (one of the TRANSFORM_ constants)
+ * cell: the row column pair being transformed
+ * result: stores the transformed row column pair
+ *
+ */
+void transform_cell(struct Game* game, int transform, int* cell, int* result) {
+
+    int row = cell[0];
+    int column = cell[1];
+
+    if (transform == TRANSFORM_ROTATE) {
+        result[0] = game->height - 1 - row;
+        result[1] = game->width - 1 - column;
+
+    } else if (transform == TRANSFORM_TRANSPOSE) {
+        result[0] = column;
+        result[1] = row;
+
+    } else if (transform == TRANSFORM_ANTI_TRANSPOSE) {
+        result[0] = game->width - 1 - column;
+        result[1] = game->height - 1 - row;
+
+    } else {
+        result[0] = row;
+        result[1] = column;
+    }
+}
+
+/* maps a grid symbol through one of the board symmetries (the transposes
+ * swap which edges each player is connecting, so they also swap O and X)
+ *
+ * transform: the symmetry to apply (one of the TRANSFORM_ constants)
+ * symbol: the grid symbol being transformed ('O', 'X' or '.')
+ *
+ * returns: the symbol as it appears in the transformed position
+ *
+ */
+char transform_symbol(int transform, char symbol) {
+
+    if (transform != TRANSFORM_TRANSPOSE &&
+            transform != TRANSFORM_ANTI_TRANSPOSE) {
+        return symbol;
+    }
+    if (symbol == 'O') {
+        return 'X';
+    } else if (symbol == 'X') {
+        return 'O';
+    }
+    return symbol;
+}
+
+/* finds the symmetry which maps the given position onto its canonical
+ * representative (the transformed position with the smallest player to move
+ * and then the smallest grid, read row by row)
+ *
+ * game: stores information on the current game
+ * grid: the game grid to be canonicalised
+ *
+ * returns: the transform giving the canonical representative
+ *
+ */
+int canonical_transform(struct Game* game, char** grid) {
+
+    int candidates[MAX_TRANSFORMS];
+    char values[MAX_TRANSFORMS];
+    int numCandidates = num_transforms(game);
+    int cell[2];
+    int source[2];
+    int i;
+
+    // the player to move is compared first, since the transposes swap it
+    char toMove = side_to_move(game);
+    for (i = 0; i < numCandidates; i++) {
+        candidates[i] = i;
+        values[i] = transform_symbol(i, toMove);
+    }
+    numCandidates = keep_smallest(values, candidates, numCandidates);
+
+    // compares the transformed grids one cell at a time, dropping any
+    // transform which is larger, until only one is left
+    for (cell[0] = 0; cell[0] < game->height && numCandidates > 1;
+            cell[0]++) {
+
+        for (cell[1] = 0; cell[1] < game->width && numCandidates > 1;
+                cell[1]++) {
+
+            for (i = 0; i < numCandidates; i++) {
+                transform_cell(game, candidates[i], cell, source);
+                values[i] = transform_symbol(candidates[i],
+                        grid[source[0]][source[1]]);
+            }
+            numCandidates = keep_smallest(values, candidates,
+                    numCandidates);
+        }
+    }
+    // any candidates which are left give identical (symmetric) positions
+    return candidates[0];
+}
+
+/* hashes the given position after it has been mapped through a symmetry
+ *
+ * game: stores information on the current game
+ * grid: the game grid to be hashed
+ * transform: the symmetry to apply before hashing
+ *
+ * returns: a 64 bit key for the transformed position
+ *
+ */
+unsigned long long position_key(struct Game* game, char** grid,
+        int transform) {
+
+    int cell[2];
+    int source[2];
+
+    unsigned long long hash = FNV_OFFSET;
+    hash = hash_value(hash, game->height);
+    hash = hash_value(hash, game->width);
+    hash = hash_value(hash, transform_symbol(transform, side_to_move(game)));
+
+    for (cell[0] = 0; cell[0] < game->height; cell[0]++) {
+        for (cell[1] = 0; cell[1] < game->width; cell[1]++) {
+
+            transform_cell(game, transform, cell, source);
+            hash = hash_value(hash, transform_symbol(transform,
+                    grid[source[0]][source[1]]));
+        }
+    }
+    return hash;
+}
+
+/* hashes the canonical representative of the given position, so that every
+ * position which is symmetric to it shares the same key
+ *
+ * game: stores information on the current game
+ * grid: the game grid to be hashed
+ * transform: stores the transform which gave the canonical representative
+ *            (may be NULL), used to map moves into and out of its frame
+ *
+ * returns: a 64 bit key for the canonical representative
+ *
+ */
+unsigned long long canonical_key(struct Game* game, char** grid,
+        int* transform) {
+
+    int canonical = canonical_transform(game, grid);
+    if (transform != NULL) {
+        *transform = canonical;
+    }
+    return position_key(game, grid, canonical);
+}
+
+/* gets the symbol of the player who has the next move
+ *
+ * game: stores information on the current game
+ *
+ * returns: 'X' if player 2 has the next move, 'O' otherwise
+ *
+ */
+char side_to_move(struct Game* game) {
+
+    if (game->player2->hasNextMove == 1) {
+        return 'X';
+    }
+    return 'O';
+}
+
+/* filters candidates down to those with the smallest matching value
+ * (helper method to canonical_transform)
+ *
+ * values: the value of each candidate at the cell being compared
+ * candidates: the transforms which are still possible representatives
+ * numCandidates: the number of entries in values and candidates
+ *
+ * returns: the number of candidates which are left
+ *
+ */
+int keep_smallest(char* values, int* candidates, int numCandidates) {
+
+    char smallest = values[0];
+    int kept = 0;
+    int i;
+
+    for (i = 1; i < numCandidates; i++) {
+        if (values[i] < smallest) {
+            smallest = values[i];
+        }
+    }
+    for (i = 0; i < numCandidates; i++) {
+        if (values[i] == smallest) {
+            candidates[kept] = candidates[i];
+            values[kept] = values[i];
+            kept++;
+        }
+    }
+    return kept;
+}
+
+/* mixes a single value into an FNV-1a hash
+ *
+ * hash: the hash so far
+ * value: the value to add to the hash
+ *
+ * returns: the updated hash
+ *
+ */
+unsigned long long hash_value(unsigned long long hash, int value) {
+
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        hash ^= (unsigned long long)((value >> (8 * i)) & 0xff);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
@@ -0,0 +1,42 @@
+/*
+ * symmetry.h
+ *
+ * function prototypes for symmetry.c
+ *
+ */
+
+#ifndef SYMMETRY_H_
+#define SYMMETRY_H_
+
+#include "structs.h"
+
+/* the board symmetries of hex (the transpose symmetries only exist on square
+ * boards, and they also swap the colours of the stones) */
+#define TRANSFORM_IDENTITY 0
+#define TRANSFORM_ROTATE 1
+#define TRANSFORM_TRANSPOSE 2
+#define TRANSFORM_ANTI_TRANSPOSE 3
+
+#define MAX_TRANSFORMS 4
+
+int num_transforms(struct Game* game);
+
+void transform_cell(struct Game* game, int transform, int* cell, int* result);
+
+char transform_symbol(int transform, char symbol);
+
+int canonical_transform(struct Game* game, char** grid);
+
+unsigned long long position_key(struct Game* game, char** grid,
+        int transform);
+
+unsigned long long canonical_key(struct Game* game, char** grid,
+        int* transform);
+
+char side_to_move(struct Game* game);
+
+int keep_smallest(char* values, int* candidates, int numCandidates);
+
+unsigned long long hash_value(unsigned long long hash, int value);
+
+#endif /* SYMMETRY_H_ */
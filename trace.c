@@ -0,0 +1,235 @@
+/*
+ * trace.c
+ *
+ * records a timeline of the spans of time spent in each part of the
+ * program (--trace=FILE), and writes them out as Chrome trace events when
+ * the program exits (viewable in chrome://tracing or Perfetto)
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "trace.h"
+#include "stats.h"
+
+/* the trace for the whole program */
+struct Trace trace;
+
+/* the buffer of the calling thread, created on its first event */
+__thread struct TraceBuffer* threadBuffer = NULL;
+
+/* starts recording a trace, which is written out when the program exits
+ *
+ * fileName: the file to write the trace events to
+ *
+ */
+void init_trace(char* fileName) {
+
+    memset(&trace, 0, sizeof(struct Trace));
+    trace.fileName = fileName;
+    trace.startTime = monotonic_ns();
+    trace.mainThreadId = (int)syscall(SYS_gettid);
+    trace.enabled = 1;
+
+    trace_thread_name("main");
+    atexit(trace_flush);
+}
+
+/* checks if a trace is being recorded
+ *
+ * returns: 1 if a trace is being recorded, 0 otherwise
+ *
+ */
+int trace_enabled(void) {
+
+    return trace.enabled;
+}
+
+/* names the calling thread in the trace
+ *
+ * name: the name of the thread
+ *
+ */
+void trace_thread_name(const char* name) {
+
+    if (!trace.enabled) {
+        return;
+    }
+    thread_buffer()->threadName = name;
+}
+
+/* records a span from start until now in the calling thread's buffer
+ *
+ * name: the name of the span (must not be freed while the program runs)
+ * start: the start time of the span, given by stats_start
+ *
+ */
+void trace_end(const char* name, long long start) {
+
+    if (!trace.enabled) {
+        return;
+    }
+    struct TraceBuffer* buffer = thread_buffer();
+    struct TraceEvent* event =
+            &buffer->events[buffer->numEvents % TRACE_CAPACITY];
+
+    event->name = name;
+    event->threadId = buffer->threadId;
+    event->start = start;
+    event->duration = monotonic_ns() - start;
+
+    // the event must be complete before it is counted by trace_flush
+    __atomic_store_n(&buffer->numEvents, buffer->numEvents + 1,
+            __ATOMIC_RELEASE);
+}
+
+/* gives up the calling thread's buffer so that a later thread can reuse it
+ * (called by threads which are about to finish)
+ *
+ */
+void trace_thread_exit(void) {
+
+    if (threadBuffer == NULL) {
+        return;
+    }
+    __atomic_store_n(&threadBuffer->inUse, 0, __ATOMIC_RELEASE);
+    threadBuffer = NULL;
+}
+
+/* names the calling thread of a pool in the trace, unless it is the main
+ * thread (which works alongside most pools, and keeps its own name)
+ *
+ * name: the name of the thread
+ *
+ */
+void trace_worker_start(const char* name) {
+
+    if (trace.enabled && (int)syscall(SYS_gettid) != trace.mainThreadId) {
+        trace_thread_name(name);
+    }
+}
+
+/* gives up the buffer of a thread in a pool, unless it is the main thread
+ * (called by each thread as it leaves the pool)
+ *
+ */
+void trace_worker_exit(void) {
+
+    if (trace.enabled && (int)syscall(SYS_gettid) != trace.mainThreadId) {
+        trace_thread_exit();
+    }
+}
+
+/* gets the calling thread's buffer, reusing one given up by a finished
+ * thread or creating a new one if this is the thread's first event
+ *
+ * returns: the calling thread's buffer
+ *
+ */
+struct TraceBuffer* thread_buffer(void) {
+
+    if (threadBuffer != NULL) {
+        return threadBuffer;
+    }
+    struct TraceBuffer* buffer =
+            __atomic_load_n(&trace.buffers, __ATOMIC_ACQUIRE);
+    int threadId = (int)syscall(SYS_gettid);
+
+    while (buffer != NULL) {
+        int unused = 0;
+        if (__atomic_compare_exchange_n(&buffer->inUse, &unused, 1, 0,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            buffer->threadId = threadId;
+            threadBuffer = buffer;
+            return buffer;
+        }
+        buffer = buffer->next;
+    }
+
+    buffer = calloc(1, sizeof(struct TraceBuffer));
+    if (buffer == NULL) {
+        fprintf(stderr, "%s\n", "Unable to record trace");
+        exit(9);
+    }
+    buffer->inUse = 1;
+    buffer->threadId = threadId;
+    buffer->threadName = "worker";
+
+    // pushes the buffer onto the list without taking a lock
+    buffer->next = __atomic_load_n(&trace.buffers, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&trace.buffers, &buffer->next,
+            buffer, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+    threadBuffer = buffer;
+    return buffer;
+}
+
+/* writes every recorded event to the trace file (called when the program
+ * exits)
+ *
+ */
+void trace_flush(void) {
+
+    FILE* file = fopen(trace.fileName, "w");
+    if (file == NULL) {
+        fprintf(stderr, "%s\n", "Unable to write trace");
+        return;
+    }
+    int first = 1;
+    struct TraceBuffer* buffer =
+            __atomic_load_n(&trace.buffers, __ATOMIC_ACQUIRE);
+
+    fprintf(file, "{\"traceEvents\": [\n");
+    while (buffer != NULL) {
+        write_events(file, buffer, &first);
+        buffer = buffer->next;
+    }
+    fprintf(file, "\n], \"displayTimeUnit\": \"ns\"}\n");
+    fclose(file);
+}
+
+/* writes the events in one buffer, oldest first, along with the name of
+ * each thread which recorded them (helper method to trace_flush)
+ *
+ * file: the file to write to
+ * buffer: the buffer to be written
+ * first: 1 if no event has been written to file yet (updated)
+ *
+ */
+void write_events(FILE* file, struct TraceBuffer* buffer, int* first) {
+
+    int processId = (int)getpid();
+    unsigned long long numEvents =
+            __atomic_load_n(&buffer->numEvents, __ATOMIC_ACQUIRE);
+    unsigned long long i = 0;
+    int threadId = 0;
+
+    // only the newest TRACE_CAPACITY events are still in the buffer
+    if (numEvents > TRACE_CAPACITY) {
+        i = numEvents - TRACE_CAPACITY;
+    }
+    for (; i < numEvents; i++) {
+        struct TraceEvent* event = &buffer->events[i % TRACE_CAPACITY];
+
+        // threads sharing a buffer one after another are named separately
+        if (event->threadId != threadId) {
+            threadId = event->threadId;
+            fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", "
+                    "\"pid\": %d, \"tid\": %d, "
+                    "\"args\": {\"name\": \"%s\"}},\n",
+                    *first ? "" : ",\n", processId, threadId,
+                    buffer->threadName);
+            *first = 0;
+        } else {
+            fprintf(file, ",\n");
+        }
+        fprintf(file, "{\"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, "
+                "\"dur\": %.3f, \"pid\": %d, \"tid\": %d}", event->name,
+                (event->start - trace.startTime) / 1000.0,
+                event->duration / 1000.0, processId, event->threadId);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * trace.h
+ *
+ * structs and function prototypes for trace.c
+ *
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdio.h>
+
+/* the number of events each thread keeps (older events are overwritten) */
+#define TRACE_CAPACITY (1 << 16)
+
+/* Represents a single span of time spent in one part of the program */
+struct TraceEvent {
+    const char* name;
+    int threadId;
+    long long start;
+    long long duration;
+};
+
+/* Represents the events recorded by one thread, which only that thread
+ * writes to (once the thread finishes, the buffer is reused by the next
+ * new thread) */
+struct TraceBuffer {
+    int inUse;
+    int threadId;
+    const char* threadName;
+    unsigned long long numEvents;
+    struct TraceBuffer* next;
+    struct TraceEvent events[TRACE_CAPACITY];
+};
+
+/* Represents the trace being recorded for the whole program */
+struct Trace {
+    int enabled;
+    char* fileName;
+    long long startTime;
+    int mainThreadId;
+    struct TraceBuffer* buffers;
+};
+
+void init_trace(char* fileName);
+
+int trace_enabled(void);
+
+void trace_thread_name(const char* name);
+
+void trace_end(const char* name, long long start);
+
+void trace_thread_exit(void);
+
+void trace_worker_start(const char* name);
+
+void trace_worker_exit(void);
+
+struct TraceBuffer* thread_buffer(void);
+
+void trace_flush(void);
+
+void write_events(FILE* file, struct TraceBuffer* buffer, int* first);
+
+#endif /* TRACE_H_ */
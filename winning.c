@@ -3,6 +3,9 @@
  *
  * handles finding a winning path in a game of hex
  *
+ * the win check and the neighbour routines it uses have copies for the
+ * common square sizes, with the dimensions as constants (see kernels.h)
+ *
  */
 
 #include <stdio.h>
@@ -10,65 +13,97 @@
 #include <string.h>
 
 #include "winning.h"
+#include "stats.h"
+#include "snapshot.h"
+#include "gameIO.h"
+#include "kernels.h"
 
-/* checks the given move to see if its addition to the board results in a win
- * for the currentPlayer
+/* checks the given row column pair to see if it is a valid position on a
+ * grid (the body of check_neighbour, copied for each specialised size)
  *
- * game: stores information on the current game
- * grid: the current game grid
- * connectionGrid: a grid of all the existing connections to the start of the
- *                 board (left hand side for O, top for X)
- * move: the move to be checked
- * currentPlayer: the player who made the given move
+ * row: the x-coordinate of the position to be checked
+ * column: the y-coordinate of the position to be checked
+ * height, width: the dimensions of the grid (constants in the copies)
  *
- * returns: WIN if the move results in a win for currentPlayer, 0 otherwise
+ * returns: SUCCESS if the row column pair is a valid position, ERROR otherwise
  *
  */
-int check_win(struct Game* game, char** grid, int** connectionGrid, int* move, 
-        struct Player* currentPlayer) {
+KERNEL int check_neighbour_kernel(int row, int column, const int height,
+        const int width) {
 
-    int connecter;
-    char symbol = currentPlayer->playerSymbol;
+    if (row < 0 || row >= height) {
+        return ERROR;
+
+    } else if (column < 0 || column >= width) {
+        return ERROR;
 
-    // different symbols in the connectionGrid represent Os and Xs
-    if (symbol == 'O') {
-        connecter = O_CONNECTER;
-    } else {
-        connecter = X_CONNECTER;
     }
-    
-    // keeps track of positions that still need to be checked for connections
-    int toCheck[game->size][2];
-    int numElements = 0;
-    
-    // if move is at the start of a path, or if it has surrounding connecters,
-    // a connecter is added to the connectionGrid at move, and move is added
-    // to the toCheck list
-    int newConnections = connections(game, move, connectionGrid, connecter);
 
-    if ((move[1] == 0 && symbol == 'O') || (move[0] == 0 && symbol == 'X') || 
-            (newConnections == 1)) {
+    return SUCCESS;
+}
 
-        connectionGrid[move[0]][move[1]] = connecter;
-        toCheck[numElements][0] = move[0];
-        toCheck[numElements][1] = move[1];
-        numElements++;
+/* the body of get_neighbours, copied for each specialised size
+ *
+ * move: the position to get the neighbours of
+ * size: the number of neighbours the given move has
+ * height, width: the dimensions of the grid (constants in the copies)
+ *
+ * returns: the grid coordinates of the neighbours of the move
+ *
+ */
+KERNEL int** get_neighbours_kernel(int* move, int* size, const int height,
+        const int width) {
+    int maxNeighbours = 6;
+    int row = move[0], column = move[1];
+    int i, index = 0;
 
-    }
+    int** neighbours = malloc(sizeof(int*) * maxNeighbours);
 
-    // while there are still positions to be checked in toCheck, visit all the
-    // positions which could potentially result in new connections
-    while (numElements > 0) {
-        numElements = visit_position(game, currentPlayer, numElements, toCheck,
-                connecter);
+    for (i = 0; i < maxNeighbours; i++) {
+        neighbours[i] = malloc(sizeof(int) * 2);
     }
 
-    return is_winner(game, connectionGrid);
+    int check = check_neighbour_kernel(row - 1, column, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row - 1;
+        neighbours[index][1] = column;
+        index++;
+    }
+    check = check_neighbour_kernel(row, column + 1, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row;
+        neighbours[index][1] = column + 1;
+        index++;
+    }
+    check = check_neighbour_kernel(row + 1, column + 1, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row + 1;
+        neighbours[index][1] = column + 1;
+        index++;
+    }
+    check = check_neighbour_kernel(row + 1, column, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row + 1;
+        neighbours[index][1] = column;
+        index++;
+    }
+    check = check_neighbour_kernel(row, column - 1, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row;
+        neighbours[index][1] = column - 1;
+        index++;
+    }
+    check = check_neighbour_kernel(row - 1, column - 1, height, width);
+    if (check == SUCCESS) {
+        neighbours[index][0] = row - 1;
+        neighbours[index][1] = column - 1;
+        index++;
+    }
+    *size = index;
+    return neighbours;
 }
 
-/* checks the given move against the connectionGrid to determine if it is has
- * any connections to its neighbours (that is, if any of its neighbours are
- * part of an existing path
+/* the body of connections, copied for each specialised size
  *
  * game: stores information on the current game
  * move: the move to be checked for connections
@@ -76,12 +111,14 @@ int check_win(struct Game* game, char** grid, int** connectionGrid, int* move,
  *                 board (left hand side for O, top for X)
  * connecter: the symbol placed on the connectionGrid for the player who made
  *            the move (O_CONNECTER or X_CONNECTER)
- * 
+ * height, width: the dimensions of the grid (constants in the copies)
+ *
  * returns: SUCCESS if there are any connections between move and its
  *          neighbours, 0 otherwise
  */
-int connections(struct Game* game, int* move, int** connectionGrid, 
-        int connecter) {
+KERNEL int connections_kernel(struct Game* game, int* move,
+        int** connectionGrid, int connecter, const int height,
+        const int width) {
     int i;
     int row;
     int column;
@@ -89,7 +126,8 @@ int connections(struct Game* game, int* move, int** connectionGrid,
     int numberOfNeighbours;
 
     // gets the neighbours of the move to check for connections
-    int** neighbours = get_neighbours(game, move, &numberOfNeighbours);
+    int** neighbours = get_neighbours_kernel(move, &numberOfNeighbours,
+            height, width);
 
     // check each neighbour for a matching connecter in connectionGrid
     for (i = 0; i < numberOfNeighbours; i++) {
@@ -106,10 +144,7 @@ int connections(struct Game* game, int* move, int** connectionGrid,
     return connections;
 }
 
-/* for each position in toCheck, if its neighbours in the grid have the 
- * currentPlayer symbol, but the connectionGrid does not yet have a
- * connecter at that position, then a connecter is inserted and the position
- * is marked as visited
+/* the body of visit_position, copied for each specialised size
  *
  * game: stores information on the current game
  * currentPlayer: the player which has the symbol currently being checked
@@ -117,13 +152,15 @@ int connections(struct Game* game, int* move, int** connectionGrid,
  * toCheck: contains all the positions which need to be visited
  * connecter: the symbol placed on the connectionGrid for the player who made
  *            the move (O_CONNECTER or X_CONNECTER)
- * 
+ * height, width: the dimensions of the grid (constants in the copies)
+ *
  * returns: the updated number of elements in toCheck
  *
  */
-int visit_position(struct Game* game, struct Player* currentPlayer, 
-        int numElements, int toCheck[][2], int connecter) {
-    
+KERNEL int visit_position_kernel(struct Game* game,
+        struct Player* currentPlayer, int numElements, int toCheck[][2],
+        int connecter, const int height, const int width) {
+
     int** neighbours;
     int* currentMove;
     int numNeighbours;
@@ -131,7 +168,8 @@ int visit_position(struct Game* game, struct Player* currentPlayer,
 
     // compares the first element of toCheck to its neighbours
     currentMove = toCheck[0];
-    neighbours = get_neighbours(game, currentMove, &numNeighbours);
+    neighbours = get_neighbours_kernel(currentMove, &numNeighbours, height,
+            width);
 
     for (i = 0; i < numNeighbours; i++) {
 
@@ -144,6 +182,7 @@ int visit_position(struct Game* game, struct Player* currentPlayer,
         if (game->grid[row][column] == currentPlayer->playerSymbol && 
                 game->connectionGrid[row][column] != connecter) {
 
+            own_connection_row(game, row);
             game->connectionGrid[row][column] = connecter;
             toCheck[numElements][0] = neighbours[i][0];
             toCheck[numElements][1] = neighbours[i][1];
@@ -158,17 +197,17 @@ int visit_position(struct Game* game, struct Player* currentPlayer,
     return numElements;
 }
 
-/* performs the final check to determine if there is a winner in the game
- * (helper method to check_win)
+/* the body of is_winner, copied for each specialised size
  *
- * game: stores information on the current game
  * connectionGrid: a grid of all the existing connections to the start of the
  *                 board (left hand side for O, top for X)
+ * height, width: the dimensions of the grid (constants in the copies)
  *
  * returns: WIN if there is a winner, 0 otherwise
  *
  */
-int is_winner(struct Game* game, int** connectionGrid) {
+KERNEL int is_winner_kernel(int** connectionGrid, const int height,
+        const int width) {
 
     int i;
 
@@ -176,77 +215,196 @@ int is_winner(struct Game* game, int** connectionGrid) {
     // (a complete path is indicated by either an O_CONNECTER in the last
     // column, or an X_CONNECTER in the last row)
 
-    for (i = 0; i < game->height; i++) {
-        if (connectionGrid[i][game->width - 1] == O_CONNECTER) {
+    for (i = 0; i < height; i++) {
+        if (connectionGrid[i][width - 1] == O_CONNECTER) {
             return WIN;
         }
     }
-    for (i = 0; i < game->width; i++) {
-        if (connectionGrid[game->height - 1][i] == X_CONNECTER) {
+    for (i = 0; i < width; i++) {
+        if (connectionGrid[height - 1][i] == X_CONNECTER) {
             return WIN;
         }
     }
     return 0;
 }
 
-/* gets the positions immediately surrounding the given move (its neighbours)
+/* the body of check_win, copied for each specialised size
  *
  * game: stores information on the current game
- * move: the position to get the neighbours of
- * size: the number of neighbours the given move has
+ * grid: the current game grid
+ * connectionGrid: a grid of all the existing connections to the start of the
+ *                 board (left hand side for O, top for X)
+ * move: the move to be checked
+ * currentPlayer: the player who made the given move
+ * height, width: the dimensions of the grid (constants in the copies)
  *
- * returns: the grid coordinates of the neighbours of the move
+ * returns: WIN if the move results in a win for currentPlayer, 0 otherwise
  *
  */
-int** get_neighbours(struct Game* game, int* move, int* size) {
-    int maxNeighbours = 6;
-    int row = move[0], column = move[1];
-    int i, index = 0;
+KERNEL int check_win_kernel(struct Game* game, char** grid,
+        int** connectionGrid, int* move, struct Player* currentPlayer,
+        const int height, const int width) {
 
-    int** neighbours = malloc(sizeof(int*) * maxNeighbours);
-
-    for (i = 0; i < maxNeighbours; i++) {
-        neighbours[i] = malloc(sizeof(int) * 2);
-    }
+    int connecter;
+    char symbol = currentPlayer->playerSymbol;
 
-    int check = check_neighbour(row - 1, column, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row - 1;
-        neighbours[index][1] = column;
-        index++;
+    // different symbols in the connectionGrid represent Os and Xs
+    if (symbol == 'O') {
+        connecter = O_CONNECTER;
+    } else {
+        connecter = X_CONNECTER;
     }
-    check = check_neighbour(row, column + 1, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row;
-        neighbours[index][1] = column + 1;
-        index++;
+    
+    // keeps track of positions that still need to be checked for connections
+    // (allocated on the heap, since a large board would overflow the stack)
+    int (*toCheck)[2] = malloc(sizeof(int[2]) * height * width);
+    if (toCheck == NULL) {
+        exit_with_error("Unable to check for a win", 7);
     }
-    check = check_neighbour(row + 1, column + 1, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row + 1;
-        neighbours[index][1] = column + 1;
-        index++;
+    int numElements = 0;
+    
+    // if move is at the start of a path, or if it has surrounding connecters,
+    // a connecter is added to the connectionGrid at move, and move is added
+    // to the toCheck list
+    int newConnections = connections_kernel(game, move, connectionGrid,
+            connecter, height, width);
+
+    if ((move[1] == 0 && symbol == 'O') || (move[0] == 0 && symbol == 'X') || 
+            (newConnections == 1)) {
+
+        own_connection_row(game, move[0]);
+        connectionGrid[move[0]][move[1]] = connecter;
+        toCheck[numElements][0] = move[0];
+        toCheck[numElements][1] = move[1];
+        numElements++;
+
     }
-    check = check_neighbour(row + 1, column, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row + 1;
-        neighbours[index][1] = column;
-        index++;
+
+    // while there are still positions to be checked in toCheck, visit all the
+    // positions which could potentially result in new connections
+    int visited = 0;
+    while (numElements > 0) {
+        numElements = visit_position_kernel(game, currentPlayer, numElements,
+                toCheck, connecter, height, width);
+        visited++;
     }
-    check = check_neighbour(row, column - 1, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row;
-        neighbours[index][1] = column - 1;
-        index++;
+    stats_count(STAT_CELLS_VISITED, visited);
+    free(toCheck);
+
+    return is_winner_kernel(connectionGrid, height, width);
+}
+
+/* checks the given move to see if its addition to the board results in a win
+ * for the currentPlayer
+ *
+ * game: stores information on the current game
+ * grid: the current game grid
+ * connectionGrid: a grid of all the existing connections to the start of the
+ *                 board (left hand side for O, top for X)
+ * move: the move to be checked
+ * currentPlayer: the player who made the given move
+ *
+ * returns: WIN if the move results in a win for currentPlayer, 0 otherwise
+ *
+ */
+int check_win(struct Game* game, char** grid, int** connectionGrid, int* move, 
+        struct Player* currentPlayer) {
+
+#define CHECK_WIN_CASE(size) \
+    case size: \
+        return check_win_kernel(game, grid, connectionGrid, move, \
+                currentPlayer, size, size);
+
+    // the common square sizes use copies with constant dimensions
+    if (game->height == game->width) {
+        switch (game->height) {
+            SPECIALISED_SIZES(CHECK_WIN_CASE)
+        }
     }
-    check = check_neighbour(row - 1, column - 1, game);
-    if (check == SUCCESS) {
-        neighbours[index][0] = row - 1;
-        neighbours[index][1] = column - 1;
-        index++;
+    return check_win_kernel(game, grid, connectionGrid, move, currentPlayer,
+            game->height, game->width);
+}
+
+/* checks the given move against the connectionGrid to determine if it is has
+ * any connections to its neighbours (that is, if any of its neighbours are
+ * part of an existing path
+ *
+ * game: stores information on the current game
+ * move: the move to be checked for connections
+ * connectionGrid: a grid of all the existing connections to the start of the
+ *                 board (left hand side for O, top for X)
+ * connecter: the symbol placed on the connectionGrid for the player who made
+ *            the move (O_CONNECTER or X_CONNECTER)
+ * 
+ * returns: SUCCESS if there are any connections between move and its
+ *          neighbours, 0 otherwise
+ */
+int connections(struct Game* game, int* move, int** connectionGrid, 
+        int connecter) {
+
+    return connections_kernel(game, move, connectionGrid, connecter,
+            game->height, game->width);
+}
+
+/* for each position in toCheck, if its neighbours in the grid have the 
+ * currentPlayer symbol, but the connectionGrid does not yet have a
+ * connecter at that position, then a connecter is inserted and the position
+ * is marked as visited
+ *
+ * game: stores information on the current game
+ * currentPlayer: the player which has the symbol currently being checked
+ * numElements: the current number of elements in toCheck
+ * toCheck: contains all the positions which need to be visited
+ * connecter: the symbol placed on the connectionGrid for the player who made
+ *            the move (O_CONNECTER or X_CONNECTER)
+ * 
+ * returns: the updated number of elements in toCheck
+ *
+ */
+int visit_position(struct Game* game, struct Player* currentPlayer, 
+        int numElements, int toCheck[][2], int connecter) {
+
+    return visit_position_kernel(game, currentPlayer, numElements, toCheck,
+            connecter, game->height, game->width);
+}
+
+/* performs the final check to determine if there is a winner in the game
+ * (helper method to check_win)
+ *
+ * game: stores information on the current game
+ * connectionGrid: a grid of all the existing connections to the start of the
+ *                 board (left hand side for O, top for X)
+ *
+ * returns: WIN if there is a winner, 0 otherwise
+ *
+ */
+int is_winner(struct Game* game, int** connectionGrid) {
+
+    return is_winner_kernel(connectionGrid, game->height, game->width);
+}
+
+/* gets the positions immediately surrounding the given move (its neighbours)
+ *
+ * game: stores information on the current game
+ * move: the position to get the neighbours of
+ * size: the number of neighbours the given move has
+ *
+ * returns: the grid coordinates of the neighbours of the move
+ *
+ */
+int** get_neighbours(struct Game* game, int* move, int* size) {
+
+#define GET_NEIGHBOURS_CASE(boardSize) \
+    case boardSize: \
+        return get_neighbours_kernel(move, size, boardSize, boardSize);
+
+    // the common square sizes use copies with constant dimensions
+    if (game->height == game->width) {
+        switch (game->height) {
+            SPECIALISED_SIZES(GET_NEIGHBOURS_CASE)
+        }
     }
-    *size = index;
-    return neighbours;
+    return get_neighbours_kernel(move, size, game->height, game->width);
 }
 
 /* checks the given row column pair to see if it is a valid position on the
@@ -261,15 +419,17 @@ int** get_neighbours(struct Game* game, int* move, int* size) {
  */
 int check_neighbour(int row, int column, struct Game* game) {
 
-    if (row < 0 || row >= game->height) {
-        return ERROR;
-
-    } else if (column < 0 || column >= game->width) {
-        return ERROR;
+#define CHECK_NEIGHBOUR_CASE(size) \
+    case size: \
+        return check_neighbour_kernel(row, column, size, size);
 
+    // the common square sizes use copies with constant dimensions
+    if (game->height == game->width) {
+        switch (game->height) {
+            SPECIALISED_SIZES(CHECK_NEIGHBOUR_CASE)
+        }
     }
-
-    return SUCCESS;
+    return check_neighbour_kernel(row, column, game->height, game->width);
 }
 
 /* frees the memory allocated to a given multidimensional array